@@ -0,0 +1,277 @@
+// joson_bench.cpp
+//
+// Benchmark harness for the JoSon library.
+//
+// Usage: joson_bench [--min-time=<seconds>] [file.json ...]
+//
+// Every document given on the command line (for instance twitter.json,
+// canada.json and citm_catalog.json) is measured along with synthetic deep,
+// wide, numeric and record documents. For each document and operation the
+// harness prints the median time of an iteration, the throughput over the
+// size of the JSON text, and the number of allocations per iteration. The
+// peak resident set size of the process is printed at the end.
+
+#include "Joson.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <new>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#if defined(_WIN32)
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+namespace {
+    std::atomic<size_t> allocations{0}; ///< Calls to operator new since the start.
+} // namespace
+
+// Replaced allocation functions, counting the allocations of the process.
+void* operator new(std::size_t size) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* block = std::malloc(size > 0 ? size : 1)) {
+        return block;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size) { return ::operator new(size); }
+
+void operator delete(void* block) noexcept { std::free(block); }
+
+void operator delete[](void* block) noexcept { std::free(block); }
+
+void operator delete(void* block, std::size_t) noexcept { std::free(block); }
+
+void operator delete[](void* block, std::size_t) noexcept { std::free(block); }
+
+namespace {
+    /**
+     * @brief One measured operation on one document.
+     */
+    struct Case {
+        std::string name;            ///< Operation and document.
+        size_t bytes;                ///< Size of the JSON text, for the throughput.
+        std::function<void()> setup; ///< Untimed preparation of each iteration.
+        std::function<void()> run;   ///< The timed operation.
+    };
+
+    /**
+     * @brief Get the peak resident set size of the process.
+     *
+     * @return The size in bytes, 0 if unknown.
+     */
+    size_t peak_rss() {
+#if defined(_WIN32)
+        PROCESS_MEMORY_COUNTERS counters;
+        return GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))
+               ? counters.PeakWorkingSetSize : 0;
+#else
+        rusage usage{};
+        getrusage(RUSAGE_SELF, &usage);
+#if defined(__APPLE__)
+        return static_cast<size_t>(usage.ru_maxrss); // Bytes on macOS
+#else
+        return static_cast<size_t>(usage.ru_maxrss) * 1024; // Kilobytes elsewhere
+#endif
+#endif
+    }
+
+    /**
+     * @brief Runs a case until the minimum time is spent, at least 3 times.
+     *
+     * @param c The case.
+     * @param min_time Minimum total time of the timed operations, in seconds.
+     */
+    void measure(const Case& c, double min_time) {
+        using Clock = std::chrono::steady_clock;
+        std::vector<double> times;
+        size_t allocated = 0;
+        double total = 0;
+        while (times.size() < 3 || total < min_time) {
+            if (c.setup) {
+                c.setup();
+            }
+            const size_t before = allocations.load(std::memory_order_relaxed);
+            auto start = Clock::now();
+            c.run();
+            double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+            allocated += allocations.load(std::memory_order_relaxed) - before;
+            times.push_back(seconds);
+            total += seconds;
+        }
+        std::sort(times.begin(), times.end());
+        const double median = times[times.size() / 2];
+        std::printf("%-36s %12.3f ms %10.1f MB/s %14.1f allocs\n", c.name.c_str(),
+                    median * 1e3, static_cast<double>(c.bytes) / median / 1e6,
+                    static_cast<double>(allocated) / static_cast<double>(times.size()));
+    }
+
+    /**
+     * @brief Builds arrays and objects nested to a depth.
+     */
+    std::string deep_document(size_t depth) {
+        std::string text;
+        for (size_t i = 0; i < depth; ++i) {
+            text += i % 2 == 0 ? "[" : "{\"k\":";
+        }
+        text += "0";
+        for (size_t i = depth; i-- > 0;) {
+            text += i % 2 == 0 ? "]" : "}";
+        }
+        return text;
+    }
+
+    /**
+     * @brief Builds an object with many members.
+     */
+    std::string wide_document(size_t members) {
+        std::string text = "{";
+        for (size_t i = 0; i < members; ++i) {
+            text += (i > 0 ? ",\"member" : "\"member") + std::to_string(i) + "\":" + std::to_string(i);
+        }
+        return text + "}";
+    }
+
+    /**
+     * @brief Builds nested arrays of coordinates, shaped as canada.json.
+     */
+    std::string numeric_document(size_t points) {
+        std::string text = "{\"type\":\"Polygon\",\"coordinates\":[[";
+        char buffer[64];
+        for (size_t i = 0; i < points; ++i) {
+            std::snprintf(buffer, sizeof(buffer), "%s[%.15f,%.15f]", i > 0 ? "," : "",
+                          -65.6 + static_cast<double>(i) * 1e-5, 43.2 + static_cast<double>(i % 977) * 1e-4);
+            text += buffer;
+        }
+        return text + "]]}";
+    }
+
+    /**
+     * @brief Builds an array of records with strings, shaped as twitter.json.
+     */
+    std::string record_document(size_t records) {
+        std::string text = "{\"statuses\":[";
+        for (size_t i = 0; i < records; ++i) {
+            std::string id = std::to_string(1000000 + i);
+            text += (i > 0 ? "," : "");
+            text += "{\"id\":" + id + ",\"text\":\"Status number " + id +
+                    " with an escaped \\\"quote\\\" and a \\u00e9\",\"user\":{\"name\":\"user" +
+                    std::to_string(i % 100) + "\",\"followers\":" + std::to_string(i * 7) +
+                    ",\"verified\":" + (i % 3 == 0 ? "true" : "false") +
+                    "},\"tags\":[\"a\",\"b\"],\"reply\":null,\"score\":" +
+                    std::to_string(static_cast<double>(i) / 3) + "}";
+        }
+        return text + "]}";
+    }
+
+    /**
+     * @brief Reads a whole file.
+     */
+    bool read_text(const std::string& path, std::string& text) {
+        std::ifstream file(path, std::ios::binary);
+        if (!file.is_open()) {
+            return false;
+        }
+        std::ostringstream buffer;
+        buffer << file.rdbuf();
+        text = buffer.str();
+        return true;
+    }
+
+    /**
+     * @brief Accesses every value of a document through operator[] and
+     * operator(), with an explicit stack.
+     *
+     * @return The number of values reached.
+     */
+    size_t lookup_all(JoSon::Doc& doc) {
+        size_t found = 0;
+        std::vector<JoSon::Doc*> pending{&doc};
+        while (!pending.empty()) {
+            JoSon::Doc& value = *pending.back();
+            pending.pop_back();
+            ++found;
+            if (value.get_type() == JoSon::Type::Dict) {
+                for (const auto& member : value.get_dict_obj()) {
+                    pending.push_back(&value[member.first]);
+                }
+            } else if (value.get_type() == JoSon::Type::Array || value.get_type() == JoSon::Type::Tuple) {
+                for (size_t i = 0; i < value.size(); ++i) {
+                    pending.push_back(const_cast<JoSon::Doc*>(&value(i)));
+                }
+            }
+        }
+        return found;
+    }
+} // namespace
+
+int main(int argc, char* argv[]) {
+    double min_time = 0.5;
+    std::vector<std::pair<std::string, std::string>> corpus; // Name and JSON text
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg.rfind("--min-time=", 0) == 0) {
+            min_time = std::atof(arg.c_str() + 11);
+            continue;
+        }
+        std::string text;
+        if (!read_text(arg, text)) {
+            std::cerr << "Error: Unable to open file '" << arg << "'." << std::endl;
+            return 1;
+        }
+        corpus.emplace_back(std::filesystem::path(arg).filename().string(), std::move(text));
+    }
+    corpus.emplace_back("deep", deep_document(10000));
+    corpus.emplace_back("wide", wide_document(200000));
+    corpus.emplace_back("numeric", numeric_document(100000));
+    corpus.emplace_back("records", record_document(20000));
+
+    const std::filesystem::path dir = std::filesystem::temp_directory_path();
+    std::printf("%-36s %15s %15s %21s\n", "benchmark", "median", "throughput", "allocations");
+    for (auto& [name, text] : corpus) {
+        const std::string input_path = (dir / ("joson_bench_" + name)).string();
+        const std::string output_path = input_path + ".out";
+        {
+            std::ofstream file(input_path, std::ios::binary);
+            file.write(text.data(), static_cast<std::streamsize>(text.size()));
+        }
+        JoSon::Doc doc = JoSon::Utils::string_to_doc(text);
+        JoSon::Doc target;
+        volatile size_t sink = 0; // Keeps the results of str() and the lookups observable
+
+        std::vector<Case> cases;
+        cases.push_back({"string_to_doc/" + name, text.size(), nullptr,
+                         [&] { target = JoSon::Utils::string_to_doc(text); }});
+        cases.push_back({"read_json_file/" + name, text.size(), nullptr,
+                         [&] { target = JoSon::Utils::read_json_file(input_path); }});
+        cases.push_back({"store_doc_to_json/" + name, text.size(), nullptr,
+                         [&] { JoSon::Utils::store_doc_to_json(output_path, doc, 0); }});
+        cases.push_back({"Doc::str/" + name, text.size(), nullptr,
+                         [&] { sink += doc.str().size(); }});
+        cases.push_back({"Doc::operator[]/" + name, text.size(), nullptr,
+                         [&] { sink += lookup_all(doc); }});
+        cases.push_back({"destruction/" + name, text.size(),
+                         [&] { target = doc.clone(); },
+                         [&] { target = JoSon::Doc(); }});
+        for (const Case& c : cases) {
+            measure(c, min_time);
+        }
+        target = JoSon::Doc();
+        std::filesystem::remove(input_path);
+        std::filesystem::remove(output_path);
+    }
+    std::printf("peak RSS: %.1f MB\n", static_cast<double>(peak_rss()) / 1e6);
+    return 0;
+}
@@ -0,0 +1,133 @@
+// Arena.h
+#pragma once
+
+#include <cstddef>
+#include <memory_resource>
+#include <new>
+#include <string_view>
+#include <utility>
+
+namespace JoSon {
+    /**
+     * @brief A monotonic memory resource for building documents in bulk.
+     *
+     * The arena hands out memory by bumping a pointer through large blocks
+     * obtained from the heap. Individual deallocations are ignored: everything
+     * allocated from the arena is returned at once by release() or when the
+     * arena is destroyed. This makes both building and tearing down large
+     * parsed documents a handful of heap operations instead of one per node.
+     *
+     * Containers and C-strings of a Doc built with an Arena (see
+     * Doc(Type, Arena&) and JoSon::Utils::string_to_doc(const std::string&,
+     * Arena&, bool)) live in the arena. Destroying such a Doc does nothing;
+     * the memory is reclaimed by the arena. Only the arena's own memory is:
+     * a heap-owned value inserted into an arena container later (a long
+     * string, a long double, a container not built from the arena) is never
+     * destroyed, and leaks.
+     *
+     * @warning Documents built from an arena must not be used after the arena
+     * is released or destroyed.
+     */
+    struct Arena : public std::pmr::memory_resource {
+    private:
+        /**
+         * @brief Header placed at the start of every block obtained from the heap.
+         */
+        struct Block {
+            Block* next; ///< Previously allocated block.
+            size_t size; ///< Size of the block in bytes, header included.
+        };
+
+        Block* head;      ///< Most recently allocated block.
+        char* cur;        ///< Next free byte in the current block.
+        char* end;        ///< End of the current block.
+        size_t next_size; ///< Size of the next block to request from the heap.
+        size_t used;      ///< Bytes handed out since the last release.
+        size_t reserved;  ///< Bytes obtained from the heap since the last release.
+        const size_t initial_size; ///< Block size to restart from after release().
+
+        /**
+         * @brief Allocates a new block big enough for bytes with the given alignment.
+         *
+         * Block sizes grow geometrically so that large documents need few blocks.
+         *
+         * @param bytes Size of the pending allocation.
+         * @param alignment Alignment of the pending allocation.
+         */
+        void grow(size_t bytes, size_t alignment);
+
+        void* do_allocate(size_t bytes, size_t alignment) override;
+
+        void do_deallocate(void*, size_t, size_t) override {}
+
+        [[nodiscard]] bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+            return this == &other;
+        }
+
+    public:
+        /**
+         * @brief Constructor with the size of the first block.
+         *
+         * No memory is requested until the first allocation.
+         *
+         * @param block_size Size in bytes of the first block. Later blocks grow
+         * geometrically.
+         */
+        explicit Arena(size_t block_size = 64 * 1024);
+
+        Arena(const Arena&) = delete;
+
+        Arena& operator=(const Arena&) = delete;
+
+        /**
+         * @brief Destructor. Releases every block.
+         */
+        ~Arena() override;
+
+        /**
+         * @brief Copies a string into the arena.
+         *
+         * The copy is followed by a null terminator, so its data() can also be
+         * used as a C-string.
+         *
+         * @param str The characters to copy.
+         * @return A view of the copy held by the arena.
+         */
+        [[nodiscard]] std::string_view copy_str(std::string_view str);
+
+        /**
+         * @brief Constructs an object in the arena.
+         *
+         * The destructor of the object is never called; only use it for objects
+         * whose memory is entirely owned by this arena.
+         *
+         * @tparam T Type of the object to construct.
+         * @param args Arguments forwarded to the constructor of T.
+         * @return Pointer to the constructed object.
+         */
+        template <typename T, typename... Args> T* create(Args&&... args) {
+            return ::new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+        }
+
+        /**
+         * @brief Returns every block to the heap at once.
+         *
+         * All memory handed out by the arena becomes invalid.
+         */
+        void release();
+
+        /**
+         * @brief Get the number of bytes handed out since the last release.
+         *
+         * @return Bytes in use.
+         */
+        [[nodiscard]] [[maybe_unused]] size_t bytes_used() const;
+
+        /**
+         * @brief Get the number of bytes currently obtained from the heap.
+         *
+         * @return Bytes reserved by the arena.
+         */
+        [[nodiscard]] [[maybe_unused]] size_t bytes_reserved() const;
+    }; // struct Arena
+} // namespace JoSon
@@ -0,0 +1,493 @@
+// Bind.h
+#pragma once
+
+#include "Doc.h"
+#include <cstddef>
+#include <limits>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+/**
+ * @brief Compile-time bindings between JSON and C++ structs.
+ *
+ * A struct is bound by listing its members once, with JOSON_BIND at global
+ * scope or by specializing Binding by hand. From that list, from_json() reads
+ * JSON text straight into the members, and to_json() writes them back,
+ * without building a Doc: each key is matched against the names of the
+ * fields, and each value is parsed into the type of its member.
+ *
+ * Members may be bool, integers, floating-point numbers, std::string,
+ * std::vector and std::optional of supported types, other bound structs,
+ * and Doc, which takes any value as a parsed document. Members of the text
+ * that the struct does not bind are skipped, or kept as a dictionary Doc in
+ * the member named by the binding's rest pointer if it has one.
+ *
+ * Example:
+ * @code
+ * struct User {
+ *     long long id;
+ *     std::string name;
+ *     std::vector<std::string> tags;
+ *     std::optional<double> score;
+ * };
+ * JOSON_BIND(User, id, name, tags, score)
+ *
+ * User user = JoSon::Bind::from_json<User>(R"({"id": 7, "name": "Ann", "tags": []})");
+ * std::string text = JoSon::Bind::to_json(user); // {"id":7,"name":"Ann","tags":[],"score":null}
+ * @endcode
+ */
+namespace JoSon::Bind {
+
+    /**
+     * @brief Descriptor of a bound member: its key and its pointer.
+     */
+    template <typename T, typename M> struct Field {
+        std::string_view name; ///< Key of the member in JSON.
+        M T::*member;          ///< The member.
+    };
+
+    /**
+     * @brief Makes a field descriptor.
+     *
+     * @param name Key of the member in JSON.
+     * @param member Pointer to the member.
+     */
+    template <typename T, typename M>
+    constexpr Field<T, M> field(std::string_view name, M T::*member) {
+        return {name, member};
+    }
+
+    /**
+     * @brief Binding of a struct, specialized for every bound struct.
+     *
+     * A specialization declares `static constexpr auto fields`, a tuple of
+     * field(), and optionally `static constexpr Doc T::*rest`, the member
+     * receiving the unbound members of the text.
+     */
+    template <typename T> struct Binding;
+
+    /** @brief Whether a type has a Binding. */
+    template <typename T, typename = void> struct is_bound : std::false_type {};
+
+    template <typename T>
+    struct is_bound<T, std::void_t<decltype(Binding<T>::fields)>> : std::true_type {};
+
+    /** @brief Whether the Binding of a type keeps the unbound members. */
+    template <typename T, typename = void> struct has_rest : std::false_type {};
+
+    template <typename T>
+    struct has_rest<T, std::void_t<decltype(Binding<T>::rest)>> : std::true_type {};
+
+    /** @brief Whether a type is a std::vector. */
+    template <typename T> struct is_vector : std::false_type {};
+
+    template <typename T, typename A> struct is_vector<std::vector<T, A>> : std::true_type {};
+
+    /** @brief Whether a type is a std::optional. */
+    template <typename T> struct is_optional : std::false_type {};
+
+    template <typename T> struct is_optional<std::optional<T>> : std::true_type {};
+
+    /**
+     * @brief Reading position in a JSON text, with the primitives the bound
+     * readers are made of.
+     *
+     * Every read skips the whitespace before the value. A text that does not
+     * match the bound types throws std::runtime_error with the offset of the
+     * mismatch.
+     */
+    struct Cursor {
+        std::string_view text; ///< The JSON text.
+        size_t pos = 0;        ///< Offset of the next byte to read.
+
+        /**
+         * @brief Constructor.
+         *
+         * @param text The JSON text. It must outlive the cursor.
+         */
+        explicit Cursor(std::string_view text) : text(text) {}
+
+        /**
+         * @brief Get the next byte that is not whitespace, without consuming it.
+         *
+         * @return The byte, or '\0' at the end of the text.
+         */
+        char peek();
+
+        /**
+         * @brief Consumes a byte if it is the next one.
+         *
+         * @return Whether it was consumed.
+         */
+        bool consume(char c);
+
+        /**
+         * @brief Consumes a byte that must be the next one.
+         *
+         * @throw std::runtime_error if it is not.
+         */
+        void expect(char c);
+
+        /**
+         * @brief Consumes a null if it is the next value.
+         *
+         * @return Whether it was consumed.
+         */
+        bool read_null();
+
+        /** @brief Reads true or false. */
+        bool read_bool();
+
+        /** @brief Reads an integer. */
+        long long read_integer();
+
+        /** @brief Reads a non-negative integer. */
+        unsigned long long read_unsigned();
+
+        /** @brief Reads a number as a double. */
+        double read_double();
+
+        /** @brief Reads a number as a long double. */
+        long double read_long_double();
+
+        /**
+         * @brief Reads a string, decoding its escapes.
+         *
+         * @param out Receives the string.
+         */
+        void read_string(std::string& out);
+
+        /**
+         * @brief Reads the key of a member, without copying it if it has no
+         * escapes.
+         *
+         * @param scratch Buffer for a key with escapes.
+         * @return The key, valid until the next read into scratch.
+         */
+        std::string_view read_key(std::string& scratch);
+
+        /**
+         * @brief Skips a value of any type.
+         */
+        void skip_value();
+
+        /**
+         * @brief Reads a value of any type into a Doc, with its keys and
+         * strings copied.
+         */
+        Doc read_doc();
+
+        /**
+         * @brief Throws the error of a mismatch at the current offset.
+         *
+         * @param expected What was expected, for the message.
+         */
+        [[noreturn]] void fail(const char* expected) const;
+    }; // struct Cursor
+
+    /** @brief Appends a string, quoted and escaped. */
+    void write_string(std::string& out, std::string_view text);
+
+    /** @brief Appends an integer. */
+    void write_integer(std::string& out, long long value);
+
+    /** @brief Appends a non-negative integer. */
+    void write_unsigned(std::string& out, unsigned long long value);
+
+    /** @brief Appends a float, in the shortest form that reads back as the same float. */
+    void write_float(std::string& out, float value);
+
+    /** @brief Appends a floating-point number, in its shortest exact form. */
+    void write_float(std::string& out, double value);
+
+    /** @brief Appends a long double, in its shortest exact form. */
+    void write_float(std::string& out, long double value);
+
+    /** @brief Appends a document as compact JSON. */
+    void write_doc(std::string& out, const Doc& doc);
+
+    template <typename V> void read_value(Cursor& in, V& value);
+
+    template <typename V> void write_value(std::string& out, const V& value);
+
+    /**
+     * @brief Reads an object into a bound struct.
+     *
+     * Members missing from the text keep their value.
+     */
+    template <typename T> void read_object(Cursor& in, T& object) {
+        in.expect('{');
+        if (in.consume('}')) {
+            return;
+        }
+        std::string scratch;
+        do {
+            const std::string_view key = in.read_key(scratch);
+            in.expect(':');
+            const bool bound = std::apply(
+                    [&](const auto&... fields) {
+                        return ((fields.name == key && (read_value(in, object.*(fields.member)), true)) || ...);
+                    },
+                    Binding<T>::fields);
+            if (bound) {
+                continue;
+            }
+            if constexpr (has_rest<T>::value) {
+                Doc& rest = object.*(Binding<T>::rest);
+                if (rest.get_type() != Type::Dict) {
+                    rest = Doc(Type::Dict);
+                }
+                rest.upsert(key, in.read_doc()); // Copies the key out of scratch
+            } else {
+                in.skip_value();
+            }
+        } while (in.consume(','));
+        in.expect('}');
+    }
+
+    /**
+     * @brief Reads a value into a variable of a supported type.
+     *
+     * A null leaves the variable as it is, but resets an optional.
+     */
+    template <typename V> void read_value(Cursor& in, V& value) {
+        if constexpr (is_optional<V>::value) {
+            if (in.read_null()) {
+                value.reset();
+            } else {
+                read_value(in, value.emplace());
+            }
+        } else if constexpr (std::is_same_v<V, Doc>) {
+            value = in.read_doc();
+        } else if (in.read_null()) {
+            return;
+        } else if constexpr (std::is_same_v<V, bool>) {
+            value = in.read_bool();
+        } else if constexpr (std::is_integral_v<V> && std::is_signed_v<V>) {
+            const long long number = in.read_integer();
+            if (number < static_cast<long long>(std::numeric_limits<V>::min()) ||
+                number > static_cast<long long>(std::numeric_limits<V>::max())) {
+                in.fail("an integer in the range of the member");
+            }
+            value = static_cast<V>(number);
+        } else if constexpr (std::is_integral_v<V>) {
+            const unsigned long long number = in.read_unsigned();
+            if (number > static_cast<unsigned long long>(std::numeric_limits<V>::max())) {
+                in.fail("an integer in the range of the member");
+            }
+            value = static_cast<V>(number);
+        } else if constexpr (std::is_same_v<V, long double>) {
+            value = in.read_long_double();
+        } else if constexpr (std::is_floating_point_v<V>) {
+            value = static_cast<V>(in.read_double());
+        } else if constexpr (std::is_same_v<V, std::string>) {
+            in.read_string(value);
+        } else if constexpr (is_vector<V>::value) {
+            value.clear();
+            in.expect('[');
+            if (in.consume(']')) {
+                return;
+            }
+            do {
+                if constexpr (std::is_same_v<typename V::value_type, bool>) {
+                    bool item = false; // No reference to the elements of std::vector<bool>
+                    read_value(in, item);
+                    value.push_back(item);
+                } else {
+                    read_value(in, value.emplace_back());
+                }
+            } while (in.consume(','));
+            in.expect(']');
+        } else if constexpr (is_bound<V>::value) {
+            read_object(in, value);
+        } else {
+            static_assert(is_bound<V>::value, "JoSon::Bind: unsupported member type, bind it with JOSON_BIND");
+        }
+    }
+
+    /**
+     * @brief Writes a bound struct as an object, its unbound members last.
+     */
+    template <typename T> void write_object(std::string& out, const T& object) {
+        out.push_back('{');
+        bool first = true;
+        auto key = [&out, &first](std::string_view name) {
+            if (!first) {
+                out.push_back(',');
+            }
+            first = false;
+            write_string(out, name);
+            out.push_back(':');
+        };
+        std::apply([&](const auto&... fields) { ((key(fields.name), write_value(out, object.*(fields.member))), ...); },
+                   Binding<T>::fields);
+        if constexpr (has_rest<T>::value) {
+            const Doc& rest = object.*(Binding<T>::rest);
+            if (rest.get_type() == Type::Dict) {
+                for (const auto& member : rest.get_dict_obj()) {
+                    key(member.first);
+                    write_doc(out, member.second);
+                }
+            }
+        }
+        out.push_back('}');
+    }
+
+    /**
+     * @brief Writes a variable of a supported type as JSON.
+     */
+    template <typename V> void write_value(std::string& out, const V& value) {
+        if constexpr (is_optional<V>::value) {
+            if (value) {
+                write_value(out, *value);
+            } else {
+                out.append("null");
+            }
+        } else if constexpr (std::is_same_v<V, Doc>) {
+            write_doc(out, value);
+        } else if constexpr (std::is_same_v<V, bool>) {
+            out.append(value ? "true" : "false");
+        } else if constexpr (std::is_integral_v<V> && std::is_signed_v<V>) {
+            write_integer(out, value);
+        } else if constexpr (std::is_integral_v<V>) {
+            write_unsigned(out, value);
+        } else if constexpr (std::is_floating_point_v<V>) {
+            write_float(out, value);
+        } else if constexpr (std::is_same_v<V, std::string>) {
+            write_string(out, value);
+        } else if constexpr (is_vector<V>::value) {
+            out.push_back('[');
+            for (const auto& item : value) {
+                if (out.back() != '[') {
+                    out.push_back(',');
+                }
+                write_value(out, item);
+            }
+            out.push_back(']');
+        } else if constexpr (is_bound<V>::value) {
+            write_object(out, value);
+        } else {
+            static_assert(is_bound<V>::value, "JoSon::Bind: unsupported member type, bind it with JOSON_BIND");
+        }
+    }
+
+    /**
+     * @brief Reads JSON text into a variable of a bound or supported type.
+     *
+     * Text after the value is ignored.
+     *
+     * @param text The JSON text.
+     * @param value Receives the value; members missing from the text keep
+     * their value.
+     * @throw std::runtime_error if the text does not match the type.
+     */
+    template <typename V> void from_json(std::string_view text, V& value) {
+        Cursor in(text);
+        read_value(in, value);
+    }
+
+    /**
+     * @brief Reads JSON text into a new value of a bound or supported type.
+     *
+     * @param text The JSON text.
+     * @return The value, value-initialized before reading.
+     * @throw std::runtime_error if the text does not match the type.
+     */
+    template <typename V> [[nodiscard]] V from_json(std::string_view text) {
+        V value{};
+        from_json(text, value);
+        return value;
+    }
+
+    /**
+     * @brief Writes a value of a bound or supported type as compact JSON.
+     *
+     * @param value The value.
+     * @return The JSON text.
+     */
+    template <typename V> [[nodiscard]] std::string to_json(const V& value) {
+        std::string out;
+        write_value(out, value);
+        return out;
+    }
+} // namespace JoSon::Bind
+
+// Expands F(T, x) for every x, up to 32 of them (the MSVC preprocessor needs
+// the extra expansions).
+#define JOSON_BIND_EXPAND(x) x
+#define JOSON_BIND_EACH_1(F, T, x) F(T, x)
+#define JOSON_BIND_EACH_2(F, T, x, ...) F(T, x), JOSON_BIND_EXPAND(JOSON_BIND_EACH_1(F, T, __VA_ARGS__))
+#define JOSON_BIND_EACH_3(F, T, x, ...) F(T, x), JOSON_BIND_EXPAND(JOSON_BIND_EACH_2(F, T, __VA_ARGS__))
+#define JOSON_BIND_EACH_4(F, T, x, ...) F(T, x), JOSON_BIND_EXPAND(JOSON_BIND_EACH_3(F, T, __VA_ARGS__))
+#define JOSON_BIND_EACH_5(F, T, x, ...) F(T, x), JOSON_BIND_EXPAND(JOSON_BIND_EACH_4(F, T, __VA_ARGS__))
+#define JOSON_BIND_EACH_6(F, T, x, ...) F(T, x), JOSON_BIND_EXPAND(JOSON_BIND_EACH_5(F, T, __VA_ARGS__))
+#define JOSON_BIND_EACH_7(F, T, x, ...) F(T, x), JOSON_BIND_EXPAND(JOSON_BIND_EACH_6(F, T, __VA_ARGS__))
+#define JOSON_BIND_EACH_8(F, T, x, ...) F(T, x), JOSON_BIND_EXPAND(JOSON_BIND_EACH_7(F, T, __VA_ARGS__))
+#define JOSON_BIND_EACH_9(F, T, x, ...) F(T, x), JOSON_BIND_EXPAND(JOSON_BIND_EACH_8(F, T, __VA_ARGS__))
+#define JOSON_BIND_EACH_10(F, T, x, ...) F(T, x), JOSON_BIND_EXPAND(JOSON_BIND_EACH_9(F, T, __VA_ARGS__))
+#define JOSON_BIND_EACH_11(F, T, x, ...) F(T, x), JOSON_BIND_EXPAND(JOSON_BIND_EACH_10(F, T, __VA_ARGS__))
+#define JOSON_BIND_EACH_12(F, T, x, ...) F(T, x), JOSON_BIND_EXPAND(JOSON_BIND_EACH_11(F, T, __VA_ARGS__))
+#define JOSON_BIND_EACH_13(F, T, x, ...) F(T, x), JOSON_BIND_EXPAND(JOSON_BIND_EACH_12(F, T, __VA_ARGS__))
+#define JOSON_BIND_EACH_14(F, T, x, ...) F(T, x), JOSON_BIND_EXPAND(JOSON_BIND_EACH_13(F, T, __VA_ARGS__))
+#define JOSON_BIND_EACH_15(F, T, x, ...) F(T, x), JOSON_BIND_EXPAND(JOSON_BIND_EACH_14(F, T, __VA_ARGS__))
+#define JOSON_BIND_EACH_16(F, T, x, ...) F(T, x), JOSON_BIND_EXPAND(JOSON_BIND_EACH_15(F, T, __VA_ARGS__))
+#define JOSON_BIND_EACH_17(F, T, x, ...) F(T, x), JOSON_BIND_EXPAND(JOSON_BIND_EACH_16(F, T, __VA_ARGS__))
+#define JOSON_BIND_EACH_18(F, T, x, ...) F(T, x), JOSON_BIND_EXPAND(JOSON_BIND_EACH_17(F, T, __VA_ARGS__))
+#define JOSON_BIND_EACH_19(F, T, x, ...) F(T, x), JOSON_BIND_EXPAND(JOSON_BIND_EACH_18(F, T, __VA_ARGS__))
+#define JOSON_BIND_EACH_20(F, T, x, ...) F(T, x), JOSON_BIND_EXPAND(JOSON_BIND_EACH_19(F, T, __VA_ARGS__))
+#define JOSON_BIND_EACH_21(F, T, x, ...) F(T, x), JOSON_BIND_EXPAND(JOSON_BIND_EACH_20(F, T, __VA_ARGS__))
+#define JOSON_BIND_EACH_22(F, T, x, ...) F(T, x), JOSON_BIND_EXPAND(JOSON_BIND_EACH_21(F, T, __VA_ARGS__))
+#define JOSON_BIND_EACH_23(F, T, x, ...) F(T, x), JOSON_BIND_EXPAND(JOSON_BIND_EACH_22(F, T, __VA_ARGS__))
+#define JOSON_BIND_EACH_24(F, T, x, ...) F(T, x), JOSON_BIND_EXPAND(JOSON_BIND_EACH_23(F, T, __VA_ARGS__))
+#define JOSON_BIND_EACH_25(F, T, x, ...) F(T, x), JOSON_BIND_EXPAND(JOSON_BIND_EACH_24(F, T, __VA_ARGS__))
+#define JOSON_BIND_EACH_26(F, T, x, ...) F(T, x), JOSON_BIND_EXPAND(JOSON_BIND_EACH_25(F, T, __VA_ARGS__))
+#define JOSON_BIND_EACH_27(F, T, x, ...) F(T, x), JOSON_BIND_EXPAND(JOSON_BIND_EACH_26(F, T, __VA_ARGS__))
+#define JOSON_BIND_EACH_28(F, T, x, ...) F(T, x), JOSON_BIND_EXPAND(JOSON_BIND_EACH_27(F, T, __VA_ARGS__))
+#define JOSON_BIND_EACH_29(F, T, x, ...) F(T, x), JOSON_BIND_EXPAND(JOSON_BIND_EACH_28(F, T, __VA_ARGS__))
+#define JOSON_BIND_EACH_30(F, T, x, ...) F(T, x), JOSON_BIND_EXPAND(JOSON_BIND_EACH_29(F, T, __VA_ARGS__))
+#define JOSON_BIND_EACH_31(F, T, x, ...) F(T, x), JOSON_BIND_EXPAND(JOSON_BIND_EACH_30(F, T, __VA_ARGS__))
+#define JOSON_BIND_EACH_32(F, T, x, ...) F(T, x), JOSON_BIND_EXPAND(JOSON_BIND_EACH_31(F, T, __VA_ARGS__))
+#define JOSON_BIND_PICK(_1, _2, _3, _4, _5, _6, _7, _8, _9, _10, _11, _12, _13, _14, _15, _16, \
+                        _17, _18, _19, _20, _21, _22, _23, _24, _25, _26, _27, _28, _29, _30, _31, _32, NAME, ...) NAME
+#define JOSON_BIND_EACH(F, T, ...)                                                 \
+    JOSON_BIND_EXPAND(JOSON_BIND_PICK(__VA_ARGS__, \
+                                      JOSON_BIND_EACH_32, JOSON_BIND_EACH_31, JOSON_BIND_EACH_30, JOSON_BIND_EACH_29, \
+                                      JOSON_BIND_EACH_28, JOSON_BIND_EACH_27, JOSON_BIND_EACH_26, JOSON_BIND_EACH_25, \
+                                      JOSON_BIND_EACH_24, JOSON_BIND_EACH_23, JOSON_BIND_EACH_22, JOSON_BIND_EACH_21, \
+                                      JOSON_BIND_EACH_20, JOSON_BIND_EACH_19, JOSON_BIND_EACH_18, JOSON_BIND_EACH_17, \
+                                      JOSON_BIND_EACH_16, JOSON_BIND_EACH_15, JOSON_BIND_EACH_14, JOSON_BIND_EACH_13, \
+                                      JOSON_BIND_EACH_12, JOSON_BIND_EACH_11, JOSON_BIND_EACH_10, JOSON_BIND_EACH_9, \
+                                      JOSON_BIND_EACH_8, JOSON_BIND_EACH_7, JOSON_BIND_EACH_6, JOSON_BIND_EACH_5, \
+                                      JOSON_BIND_EACH_4, JOSON_BIND_EACH_3, JOSON_BIND_EACH_2, JOSON_BIND_EACH_1)(F, T, __VA_ARGS__))
+
+/** @brief Descriptor of a member named as in C++. */
+#define JOSON_BIND_FIELD(Type, member) ::JoSon::Bind::field(#member, &Type::member)
+
+/**
+ * @brief Binds a struct to JSON, by the names of its members (at most 32).
+ *
+ * Use it at global scope, after the struct.
+ */
+#define JOSON_BIND(Type, ...)                                                        \
+    template <> struct JoSon::Bind::Binding<Type> {                                  \
+        static constexpr auto fields =                                               \
+                std::make_tuple(JOSON_BIND_EACH(JOSON_BIND_FIELD, Type, __VA_ARGS__)); \
+    };
+
+/**
+ * @brief Binds a struct to JSON and keeps the unbound members of the text in
+ * a Doc member.
+ *
+ * Use it at global scope, after the struct.
+ */
+#define JOSON_BIND_WITH_REST(Type, rest_member, ...)                                 \
+    template <> struct JoSon::Bind::Binding<Type> {                                  \
+        static constexpr auto fields =                                               \
+                std::make_tuple(JOSON_BIND_EACH(JOSON_BIND_FIELD, Type, __VA_ARGS__)); \
+        static constexpr ::JoSon::Doc Type::*rest = &Type::rest_member;               \
+    };
@@ -1,14 +1,19 @@
 // Doc.h
 #pragma once
 
+#include "Arena.h"
+#include <atomic>
 #include <cstring>
 #include <initializer_list>
 #include <iomanip>
+#include <memory_resource>
 #include <sstream>
 #include <stdexcept>
 #include <string>
-#include <unordered_map>
-#include <variant>
+#include <string_view>
+#include <cstdint>
+#include <utility>
+#include <vector>
 
 namespace JoSon {
     /**
@@ -17,7 +22,7 @@ namespace JoSon {
      * This enumeration represents different types that can be used in a program.
      * Each type corresponds to a specific data type in C++.
      */
-    enum class Type {
+    enum class Type : uint8_t {
         Char, ///< Character type. All possible integer types (Char, Int, LLong) are
         ///< implicitly convertible to integers.
         Int, ///< Integer type. Default type for JSON file input or projects working
@@ -31,17 +36,38 @@ namespace JoSon {
         LDouble, ///< Extended precision floating point type.
         Bool,    ///< Boolean type.
         Str,     ///< String type. Represents a constant character pointer (const
-        ///< char*), a C primitive type.
+        ///< char*), a C primitive type, stored with its length.
         Nullptr, ///< Null pointer type. Represents the JSON null type.
         Tuple,   ///< Tuple type. Represents a self-defined DocTuple type.
         Array,   ///< Array type. Represents a self-defined DocArr type.
-        Dict   ///< Dict type. Represents a DictObj type, which is actually
-        ///< std::unordered_map<const char*, Doc>.
+        Dict   ///< Dict type. Represents a DictObj type, a map of
+        ///< std::string_view keys to Doc kept in insertion order.
     };
 
     struct Doc;
     struct DocTuple;
     struct DocArr;
+    struct DictObj;
+    struct KeyPool;
+
+    /**
+     * @brief Reference count of a container held by Doc instances.
+     *
+     * Every Doc holding a container created with new counts as one reference;
+     * the container is deleted when the last of them lets go, so copying a Doc
+     * shares its container in O(1). The count is atomic: Doc instances sharing
+     * a container may live in different threads. Copying a container does not
+     * copy its count.
+     */
+    struct Shared {
+        mutable std::atomic<size_t> refs{0}; ///< Number of Doc instances holding the container.
+
+        Shared() = default;
+
+        Shared(const Shared&) noexcept {}
+
+        Shared& operator=(const Shared&) noexcept { return *this; }
+    }; // struct Shared
 
     /**
      * @brief Represents a tuple of documents.
@@ -51,7 +77,7 @@ namespace JoSon {
      * processing. Users can obtain the to_tuple of a DocArr to change the read-in
      * DocArr to a DocTuple.
      */
-    struct DocTuple {
+    struct DocTuple : Shared {
 
     private:
         const Doc* tpl; ///< Pointer to the array of documents.
@@ -156,6 +182,26 @@ namespace JoSon {
          */
         DocTuple& operator=(const DocTuple& other) noexcept;
 
+        /**
+         * @brief Move constructor.
+         *
+         * Takes over the documents of another tuple, which is left empty.
+         *
+         * @param other Another tuple to move from.
+         */
+        DocTuple(DocTuple&& other) noexcept;
+
+        /**
+         * @brief Move assignment operator.
+         *
+         * Releases the documents of this tuple and takes over those of another
+         * tuple, which is left empty.
+         *
+         * @param other Another tuple to move from.
+         * @return Reference to this tuple after assignment.
+         */
+        DocTuple& operator=(DocTuple&& other) noexcept;
+
         /**
          * @brief Access operator.
          *
@@ -186,11 +232,29 @@ namespace JoSon {
      * It is constructed as an ArrayList structure and serves as the default read-in
      * type for JSON [] format.
      */
-    struct DocArr {
+    struct DocArr : Shared {
     private:
         Doc* arr;    ///< Pointer to the array of documents.
         size_t s; ///< Current s of the array.
         size_t cap;  ///< Capacity of the array.
+        Arena* arena; ///< Arena holding arr, or nullptr if arr was created with new.
+
+        /**
+         * @brief Allocate storage for n documents.
+         *
+         * The storage comes from the arena if there is one, otherwise from new[].
+         *
+         * @param n Number of documents.
+         * @return Pointer to n default-constructed documents.
+         */
+        [[nodiscard]] Doc* allocate(size_t n) const;
+
+        /**
+         * @brief Release the storage held by arr.
+         *
+         * Arena storage is left to Arena::release().
+         */
+        void deallocate();
 
     public:
         /**
@@ -228,6 +292,17 @@ namespace JoSon {
          */
         explicit DocArr(size_t capacity);
 
+        /**
+         * @brief Constructor with a specified capacity, allocating from an arena.
+         *
+         * The element storage, including the storage obtained when the arraylist
+         * grows, is allocated from the arena and reclaimed by Arena::release().
+         *
+         * @param capacity Desired capacity of the default array.
+         * @param arena Arena to allocate the element storage from.
+         */
+        DocArr(size_t capacity, Arena& arena);
+
         /**
          * @brief Check if the array is full.
          *
@@ -268,6 +343,21 @@ namespace JoSon {
          */
         void emplace_back(const Doc& doc);
 
+        /**
+         * @brief Emplace a document at the end of the arraylist.
+         *
+         * @param doc The document to be moved in; it is left as a null document.
+         */
+        void emplace_back(Doc&& doc);
+
+        /**
+         * @brief Move the documents of another arraylist to the end of this one.
+         *
+         * @param other The arraylist to take the documents from; it is left
+         * empty.
+         */
+        [[maybe_unused]] void append(DocArr&& other);
+
         /**
          * @brief Emplace a document at the end of the arraylist.
          *
@@ -297,6 +387,27 @@ namespace JoSon {
          */
         [[maybe_unused]] bool set_value(size_t pos, const Doc& doc);
 
+        /**
+         * @brief Insert a document at a specified position, shifting the
+         * following documents up.
+         *
+         * @param pos Position of the new document, at most size().
+         * @param doc The document to be moved in; it is left as a null document.
+         * @return True if the operation was successful, false if pos is beyond
+         * the end.
+         */
+        [[maybe_unused]] bool insert(size_t pos, Doc&& doc);
+
+        /**
+         * @brief Remove the document at a specified position, shifting the
+         * following documents down.
+         *
+         * @param pos Position of the document to remove.
+         * @return True if the operation was successful, false if pos is out of
+         * range.
+         */
+        [[maybe_unused]] bool erase(size_t pos);
+
         /**
          * @brief Set the values of the arraylist with an initializer list of documents.
          *
@@ -336,7 +447,8 @@ namespace JoSon {
          * @brief Copy constructor.
          *
          * Constructs a new arraylist by copying the contents of another arraylist.
-         * Note: Uses new pointers for value copying, ensuring safety.
+         * Note: Uses new pointers for value copying, ensuring safety. The copy is
+         * always allocated with new, even if other lives in an arena.
          *
          * @param other Another arraylist to copy from.
          */
@@ -353,6 +465,27 @@ namespace JoSon {
          */
         DocArr& operator=(const DocArr& other) noexcept;
 
+        /**
+         * @brief Move constructor.
+         *
+         * Takes over the storage of another arraylist, which is left empty.
+         * The storage stays in the arena of other, if any.
+         *
+         * @param other Another arraylist to move from.
+         */
+        DocArr(DocArr&& other) noexcept;
+
+        /**
+         * @brief Move assignment operator.
+         *
+         * Releases the storage of this arraylist and takes over that of another
+         * arraylist, which is left empty.
+         *
+         * @param other Another arraylist to move from.
+         * @return Reference to this arraylist after assignment.
+         */
+        DocArr& operator=(DocArr&& other) noexcept;
+
         /**
          * @brief Access operator.
          *
@@ -365,6 +498,15 @@ namespace JoSon {
          */
         [[nodiscard]] const Doc& operator[](size_t index) const;
 
+        /**
+         * @brief Access a document to modify it in place.
+         *
+         * @param index Index of the document to access.
+         * @throw std::out_of_range if the index is out of range.
+         * @return Reference to the document at the specified index.
+         */
+        [[nodiscard]] [[maybe_unused]] Doc& at(size_t index);
+
         /**
          * @brief Destructor.
          *
@@ -377,49 +519,93 @@ namespace JoSon {
     }; // struct DocArr
 
     /**
-     * @brief Alias for an unordered map of constant C-strings to Doc objects.
+     * @brief Payload of a Doc, read according to its Type.
      *
-     * This alias represents a type named DictObj, which is an
-     * std::unordered_map<const char*, Doc>. It maps constant C-style strings
-     * (constant char pointers) to dictionary objects.
+     * Eight bytes hold every primitive type but long double, which is boxed on
+     * the heap, and a pointer to out-of-line strings and containers. Strings of
+     * up to 7 characters are stored in place, with their null terminator.
      */
-    using DictObj = std::unordered_map<const char*, Doc>;
-
-    /**
-     * @brief Alias for a variant type.
-     *
-     * This alias represents a type named Variant, which is an std::variant capable
-     * of holding various types, including primitive types like char, int, long,
-     * float, double, long double, bool, const char* (C-string), nullptr, as well as pointers
-     * to DocTuple, DocArr, and DictObj.
-     */
-    using Variant =
-            std::variant<char, int, long long, float, double, long double, bool,
-                    const char*, std::nullptr_t, DocTuple*, DocArr*, DictObj*>;
+    union Value {
+        char c;          ///< Type::Char.
+        int i;           ///< Type::Int.
+        long long ll;    ///< Type::LLong.
+        float f;         ///< Type::Float.
+        double d;        ///< Type::Double.
+        bool b;          ///< Type::Bool.
+        long double* ld; ///< Type::LDouble, boxed.
+        const char* str; ///< Type::Str held out of line.
+        char small[8];   ///< Type::Str held in place, null-terminated.
+        DocTuple* tuple; ///< Type::Tuple.
+        DocArr* arr;     ///< Type::Array.
+        DictObj* dict;   ///< Type::Dict.
+    };
 
     /**
      * @brief Represents a dynamic type capable of holding various values.
      *
      * This struct represents a dynamic type, named Doc, capable of holding various
      * values, including primitive types, DocTuple instances, DocArr instances, and
-     * DictObj instances. The actual value is stored as a Variant, and the type is
-     * stored as a Type enum.
+     * DictObj instances. The value is stored as a Value, read according to the
+     * Type, so a Doc takes 16 bytes.
      */
     struct Doc {
     private:
-        Variant var{}; ///< Variant holding the value of the Doc instance.
-        Type t;        ///< Type of the Doc instance.
+        /** @brief Where the value of a Doc is stored. */
+        enum Flag : uint8_t {
+            Owned = 1,    ///< On the heap, released by this instance (see Shared).
+            Borrowed = 2, ///< Held by the caller; a string Doc is then a view without null terminator.
+            Inline = 4    ///< A string stored in Value::small.
+        };
+
+        Value val{};        ///< Value of the Doc instance.
+        uint32_t len = 0;   ///< Length of the string, for Type::Str.
+        Type t;             ///< Type of the Doc instance.
+        uint8_t flags = 0;  ///< Combination of Flag values.
 
         /**
          * @brief Deletes the held value and sets it to nullptr.
          *
          * This function is called when setting a new value to the Doc instance or
-         * deleting the instance. If the type is DocTuple, DocArr, the held variable
-         * as a DocTuple instance or DocArr instance will be deleted and set to
-         * nullptr.
+         * deleting the instance. If the type is DocTuple, DocArr, DictObj or a
+         * string copied to the heap, this instance stops holding the value, which
+         * is deleted if it was the last holder (see Shared). Values held in an
+         * Arena are left to Arena::release(), and borrowed values to their owner.
          */
         void delete_var();
 
+        /**
+         * @brief Counts this instance as one more holder of its value.
+         *
+         * Does nothing for values that are not Owned. A boxed long double is
+         * not shared: it is copied.
+         */
+        void retain();
+
+        /**
+         * @brief Stores a copy of a string in place or on the heap.
+         *
+         * @param str The characters of the string.
+         * @throw std::length_error if the string is 4 GiB or longer.
+         */
+        void copy_str(std::string_view str);
+
+        /**
+         * @brief Stores a string held elsewhere.
+         *
+         * @param str The characters of the string.
+         * @param borrowed Whether the characters have no null terminator.
+         * @throw std::length_error if the string is 4 GiB or longer.
+         */
+        void refer_str(std::string_view str, bool borrowed);
+
+        /**
+         * @brief Checks the type of the document before reading its value.
+         *
+         * @param type The expected type.
+         * @throw std::runtime_error if the document is of another type.
+         */
+        void expect(Type type) const;
+
         /**
          * @brief Convert the primitive Doc to a string representation.
          *
@@ -438,7 +624,8 @@ namespace JoSon {
          *
          * This constructor allows instantiation of the Doc with a value of any
          * type. For types like DocTuple, DocArr, and DictObj, the pointer should be
-         * passed and will be held by the Doc instance.
+         * created with new and will be held by the Doc instance, which deletes it
+         * once no Doc holds it any more.
          *
          * @tparam T Type of the value to be assigned to the Doc.
          * @param value Value to assign to the Doc.
@@ -455,6 +642,65 @@ namespace JoSon {
          */
         explicit Doc(Type type);
 
+        /**
+         * @brief Constructor with a specified type, allocating from an arena.
+         *
+         * Arraylists and dictionary objects are created in the arena, and so is
+         * the storage they obtain later. Destroying the Doc does not free them;
+         * Arena::release() does. Tuples and primitive types are created as by
+         * Doc(Type).
+         *
+         * The members of such a container are never destroyed, so whatever
+         * they own on the heap is never freed, not even by Arena::release():
+         * strings of 8 or more characters made by Doc(std::string), long
+         * doubles, and containers not made from the arena. Insert members
+         * made with the same arena (Doc(std::string_view, Arena&), this
+         * constructor) or Doc(std::string_view) views instead.
+         *
+         * @param type Type to assign to the Doc.
+         * @param arena Arena to allocate the container from.
+         */
+        Doc(Type type, Arena& arena);
+
+        /**
+         * @brief Constructor for a C-string copied into an arena.
+         *
+         * @param str The characters of the string.
+         * @param arena Arena to hold the null-terminated copy.
+         */
+        Doc(std::string_view str, Arena& arena);
+
+        /**
+         * @brief Constructor for a string viewing characters held elsewhere.
+         *
+         * Nothing is copied: the Doc refers to the characters, which must
+         * outlive it. The view needs no null terminator, so get_str() is not
+         * available on it; use get_str_view().
+         *
+         * @param str The characters of the string.
+         */
+        explicit Doc(std::string_view str);
+
+        /**
+         * @brief Constructor for a string copied from the given characters.
+         *
+         * Strings of up to 7 characters are stored in the Doc itself; longer
+         * ones in a heap block shared by the copies of the Doc and deleted with
+         * the last of them.
+         *
+         * @param str The characters of the string.
+         * @param length The number of characters.
+         * @throw std::length_error if the string is 4 GiB or longer.
+         */
+        Doc(const char* str, size_t length);
+
+        /**
+         * @brief Constructor for a string copied from a std::string.
+         *
+         * @param str The string to copy, see Doc(const char*, size_t).
+         */
+        explicit Doc(const std::string& str);
+
         /**
          * @brief Default constructor.
          *
@@ -462,20 +708,57 @@ namespace JoSon {
          */
         Doc();
 
+        /**
+         * @brief Copy constructor.
+         *
+         * The copy shares the container of other, if any: changes made through
+         * one are seen through the other. This takes O(1) whatever the size of
+         * the container.
+         *
+         * @param other Another Doc to copy from.
+         */
+        Doc(const Doc& other);
+
+        /**
+         * @brief Move constructor.
+         *
+         * Takes over the value of other, which is left as a null document.
+         *
+         * @param other Another Doc to move from.
+         */
+        Doc(Doc&& other) noexcept;
+
         /**
          * @brief Destructor.
          *
-         * Calls delete_var(); the held tuple, arraylist or C-string instance will also be
-         * deleted.
+         * Calls delete_var(); the held tuple, arraylist or dictionary object is
+         * deleted if no other Doc holds it. Nested containers are deleted one
+         * after the other, so that any depth of nesting can be destroyed.
          */
         ~Doc();
 
+        /**
+         * @brief Deep copy.
+         *
+         * Unlike the copy constructor, the copy holds containers of its own at
+         * every level, allocated on the heap: changes made through it are not
+         * seen through this Doc. Strings held in an arena or borrowed are
+         * copied, and keys as by DictObj::clone_keys(): the copy shares the
+         * heap-held keys and copies the others, or interns them in the KeyPool
+         * of their dictionary object.
+         * The tree is copied with an explicit stack, whatever its depth.
+         *
+         * @return The copy.
+         */
+        [[nodiscard]] [[maybe_unused]] Doc clone() const;
+
         friend std::ostream& operator<<(std::ostream& stream, const Doc& doc);
 
 
         /**
          * @brief Retrieve the stored single ASCII character value of the document.
          *
+         * @throw std::runtime_error if the document is not of Type::Char.
          * @return The single ASCII character value.
          */
         [[nodiscard]] [[maybe_unused]] char get_char() const;
@@ -483,6 +766,7 @@ namespace JoSon {
         /**
          * @brief Retrieve the stored integer value of the document.
          *
+         * @throw std::runtime_error if the document is not of Type::Int.
          * @return The integer value.
          */
         [[nodiscard]] [[maybe_unused]] int get_int() const;
@@ -490,6 +774,7 @@ namespace JoSon {
         /**
          * @brief Retrieve the stored long-long-integer value of the document.
          *
+         * @throw std::runtime_error if the document is not of Type::LLong.
          * @return The long-long-integer value.
          */
         [[nodiscard]] [[maybe_unused]] long long get_l_long() const;
@@ -497,6 +782,7 @@ namespace JoSon {
         /**
          * @brief Retrieve the stored single-precision floating-point value of the document.
          *
+         * @throw std::runtime_error if the document is not of Type::Float.
          * @return The single-precision floating-point value.
          */
         [[nodiscard]] [[maybe_unused]] float get_float() const;
@@ -504,6 +790,7 @@ namespace JoSon {
         /**
          * @brief Retrieve the stored double-precision floating-point value of the document.
          *
+         * @throw std::runtime_error if the document is not of Type::Double.
          * @return The double-precision floating-point value.
          */
         [[nodiscard]] [[maybe_unused]] double get_double() const;
@@ -511,6 +798,7 @@ namespace JoSon {
         /**
          * @brief Retrieve the stored long-double-precision floating-point value of the document.
          *
+         * @throw std::runtime_error if the document is not of Type::LDouble.
          * @return The long-double-precision floating-point value.
          */
         [[nodiscard]] [[maybe_unused]] long double get_long_double() const;
@@ -518,6 +806,7 @@ namespace JoSon {
         /**
          * @brief Retrieve the stored boolean value of the document.
          *
+         * @throw std::runtime_error if the document is not of Type::Bool.
          * @return The boolean value.
          */
         [[nodiscard]] [[maybe_unused]] bool get_bool() const;
@@ -525,14 +814,29 @@ namespace JoSon {
         /**
          * @brief Retrieve the stored const char* (C-string) value of the document.
          *
+         * @throw std::runtime_error if the document is not of Type::Str.
+         * @throw std::runtime_error if the string is a view without null
+         * terminator (see Doc(std::string_view)).
          * @return The C-string value.
          */
         [[nodiscard]] [[maybe_unused]] const char* get_str() const;
 
+        /**
+         * @brief Retrieve the stored string value of the document as a view.
+         *
+         * Available for every string, including views into a retained buffer,
+         * and avoids measuring the length again.
+         *
+         * @throw std::runtime_error if the document is not of Type::Str.
+         * @return The characters of the string.
+         */
+        [[nodiscard]] [[maybe_unused]] std::string_view get_str_view() const;
+
         /**
          * @brief Retrieve a reference to the stored tuple value of the document.
          * Note: This function returns a reference, allowing modification of the tuple.
          *
+         * @throw std::runtime_error if the document is not of Type::Tuple.
          * @return Reference to the tuple.
          */
         [[nodiscard]] [[maybe_unused]] DocTuple& get_tuple() const;
@@ -541,6 +845,7 @@ namespace JoSon {
          * @brief Retrieve a reference to the stored arraylist value of the document.
          * Note: This function returns a reference, allowing modification of the arraylist.
          *
+         * @throw std::runtime_error if the document is not of Type::Array.
          * @return Reference to the arraylist.
          */
         [[nodiscard]] [[maybe_unused]] DocArr& get_arr() const;
@@ -549,6 +854,7 @@ namespace JoSon {
          * @brief Retrieve a reference to the stored dictionary object value of the document.
          * Note: This function returns a reference, allowing modification of the dictionary object.
          *
+         * @throw std::runtime_error if the document is not of Type::Dict.
          * @return Reference to the dictionary object.
          */
         [[nodiscard]] [[maybe_unused]] DictObj& get_dict_obj() const;
@@ -612,6 +918,10 @@ namespace JoSon {
         /**
          * @brief Set a tuple value in the document.
          *
+         * If value is held by another Doc, the two Doc instances share it.
+         * Otherwise it is borrowed: it must outlive the document, and is not
+         * deleted by it.
+         *
          * @param value The tuple value to be set.
          */
         [[maybe_unused]] void set_tuple(DocTuple& value);
@@ -619,6 +929,10 @@ namespace JoSon {
         /**
          * @brief Set an arraylist value in the document.
          *
+         * If value is held by another Doc, the two Doc instances share it.
+         * Otherwise it is borrowed: it must outlive the document, and is not
+         * deleted by it.
+         *
          * @param value The array value to be set.
          */
         [[maybe_unused]] void set_arr(DocArr& value);
@@ -626,6 +940,10 @@ namespace JoSon {
         /**
          * @brief Set a dictionary object value in the document.
          *
+         * If value is held by another Doc, the two Doc instances share it.
+         * Otherwise it is borrowed: it must outlive the document, and is not
+         * deleted by it.
+         *
          * @param value The dictionary value to be set.
          */
         [[maybe_unused]] void set_dict(DictObj& value);
@@ -668,14 +986,28 @@ namespace JoSon {
          * @brief Inserts or updates a key-document pair in this document.
          *
          * If the key already exists, the corresponding value will be updated;
-         * otherwise, a new key-value pair will be inserted.
+         * otherwise, a new key-value pair will be inserted. The document may be
+         * a member of this dictionary object, as in d.upsert("b", d["a"]).
          *
          * @param key The key for the key-document pair.
          * @param doc The document to be inserted or updated.
          *
          * @throw std::runtime_error if this document is not a dictionary object.
          */
-        void upsert(const char* key, const Doc& doc);
+        void upsert(std::string_view key, const Doc& doc);
+
+        /**
+         * @brief Inserts or updates a key-document pair in this document.
+         *
+         * The document is moved into the dictionary object without touching
+         * the reference count of its container.
+         *
+         * @param key The key for the key-document pair.
+         * @param doc The document to be moved in; it is left as a null document.
+         *
+         * @throw std::runtime_error if this document is not a dictionary object.
+         */
+        void upsert(std::string_view key, Doc&& doc);
 
         /**
          * @brief Inserts or updates a key-document pair in this document.
@@ -687,7 +1019,7 @@ namespace JoSon {
          * @param key The key for the key-document pair.
          * @param value Value to create the document instance.
          */
-        template <typename T> void upsert(const char* key, T value) {
+        template <typename T> void upsert(std::string_view key, T value) {
             this->upsert(key, Doc(value));
         }
 
@@ -700,7 +1032,7 @@ namespace JoSon {
          * @param key The key for the key-document pair.
          * @param type Type to create the document instance.
          */
-        [[maybe_unused]] void upsert(const char* key, Type type) { this->upsert(key, Doc(type)); }
+        [[maybe_unused]] void upsert(std::string_view key, Type type) { this->upsert(key, Doc(type)); }
 
         /**
          * @brief Remove a key-value pair from this document if it's a dictionary object.
@@ -711,7 +1043,7 @@ namespace JoSon {
          *
          * @throw std::runtime_error if this document is not a dictionary object.
          */
-        [[maybe_unused]] bool erase(const char* key);
+        [[maybe_unused]] bool erase(std::string_view key);
 
         /**
          * @brief Emplace a document at the end of the array in this document if it is an arraylist.
@@ -722,6 +1054,15 @@ namespace JoSon {
          */
         void emplace_back(const Doc& doc);
 
+        /**
+         * @brief Emplace a document at the end of the array in this document if it is an arraylist.
+         *
+         * @param doc The document to be moved in; it is left as a null document.
+         *
+         * @throw std::runtime_error if this document is not an arraylist.
+         */
+        void emplace_back(Doc&& doc);
+
         /**
          * @brief Emplace a document at the end of the array in this document if it is an arraylist.
          *
@@ -755,16 +1096,62 @@ namespace JoSon {
 
         /**
          * @brief Implement operator[] for accessing elements in the dictionary object
-         * (std::unordered_map<const char*, Doc>) by key.
+         * (DictObj) by key.
          *
          * If the key is found in the dictionary, returns a reference to the corresponding document.
          * If the key is not found, inserts a default-constructed document with the given key and returns a reference to it.
+         * Inserting a key may move the other members, so a reference obtained before it is invalidated:
+         * write d.upsert("c", d["a"]) rather than d["c"] = d["a"].
          *
          * @param key The key of the element to access.
          * @return Reference to the document corresponding to the key.
          * @throw std::runtime_error if the document is not a dictionary object.
          */
-        [[nodiscard]] [[maybe_unused]] Doc& operator[](const char* key);
+        [[nodiscard]] [[maybe_unused]] Doc& operator[](std::string_view key);
+
+        /**
+         * @brief Find a member of the dictionary object (DictObj) without
+         * modifying the document.
+         *
+         * Lookups never insert nor rebuild anything, so threads may share a
+         * document for reading as long as none of them modifies it.
+         *
+         * @param key The key of the member.
+         * @return Pointer to the document of the member, or nullptr if there is
+         * no such member or this document is not a dictionary object.
+         */
+        [[nodiscard]] [[maybe_unused]] const Doc* find(std::string_view key) const;
+
+        /**
+         * @brief Access an existing member of the dictionary object (DictObj)
+         * without modifying the document.
+         *
+         * @param key The key of the member.
+         * @return Const reference to the document of the member.
+         * @throw std::out_of_range if there is no such member.
+         * @throw std::runtime_error if the document is not a dictionary object.
+         */
+        [[nodiscard]] [[maybe_unused]] const Doc& at(std::string_view key) const;
+
+        /**
+         * @brief Access an element of an arraylist (DocArr) or a tuple (DocTuple),
+         * as operator() does.
+         *
+         * @param index The index of the element.
+         * @return Const reference to the document at the index.
+         * @throw std::out_of_range if the index is out of range.
+         * @throw std::runtime_error if the document is not a tuple or an arraylist.
+         */
+        [[nodiscard]] [[maybe_unused]] const Doc& at(size_t index) const { return (*this)(index); }
+
+        /**
+         * @brief Check whether the dictionary object (DictObj) has a member.
+         *
+         * @param key The key of the member.
+         * @return false if there is no such member or this document is not a
+         * dictionary object.
+         */
+        [[nodiscard]] [[maybe_unused]] bool contains(std::string_view key) const { return find(key) != nullptr; }
 
         /**
          * @brief Implement operator() for accessing elements in arraylist (DocArr) and tuple (DocTuple) by index.
@@ -798,14 +1185,326 @@ namespace JoSon {
         /**
          * @brief Copy assignment operator.
          *
-         * Assigns the contents of another Doc to this Doc.
+         * Assigns the contents of another Doc to this Doc, sharing its
+         * container as the copy constructor does.
          *
          * @param other Another Doc to assign from.
          * @return Reference to this Doc after assignment.
          */
         Doc& operator=(const Doc& other);
+
+        /**
+         * @brief Move assignment operator.
+         *
+         * Releases the value of this Doc and takes over that of other, which is
+         * left as a null document. other may be held inside this Doc.
+         *
+         * @param other Another Doc to move from.
+         * @return Reference to this Doc after assignment.
+         */
+        Doc& operator=(Doc&& other) noexcept;
     }; // struct Doc
 
+    /**
+     * @brief Dictionary object mapping string keys to Doc objects.
+     *
+     * The members are stored contiguously in insertion order, so iterating
+     * visits them in the order they were inserted and stays within a few cache
+     * lines. Dictionaries of up to flat_limit members are searched by a linear
+     * scan; larger ones also keep an open-addressing hash index of the members.
+     * Keys are compared by their contents, so a lookup succeeds with any
+     * pointer to the same characters (a literal, a std::string, or a key read
+     * from JSON), and lookups never allocate.
+     *
+     * By default the storage is allocated with new and delete; a DictObj
+     * created by Doc(Type, Arena&) allocates it from the arena instead. A
+     * DictObj can be shared by Doc instances (see Shared).
+     *
+     * A key inserted by operator[] (and so by Doc::upsert) is copied, and its
+     * characters are held by the dictionary object until the member is erased:
+     * in a reference-counted heap block, shared by copies of the dictionary
+     * object, or in its memory resource if it has one. emplace_view() inserts
+     * a view instead, for keys that outlive the dictionary object, such as the
+     * keys the parser reads from a kept input buffer. A dictionary object
+     * given a KeyPool with set_key_pool() interns the keys operator[] inserts
+     * in the pool instead of copying them.
+     *
+     * @warning Do not modify the key of a member through an iterator, nor
+     * reorder the members.
+     * @warning As with std::vector, inserting or erasing a member may move the
+     * others: references and iterators to members are then invalidated.
+     */
+    struct DictObj : Shared {
+        using key_type = std::string_view;
+        using mapped_type = Doc;
+        using value_type = std::pair<std::string_view, Doc>;
+        using allocator_type = std::pmr::polymorphic_allocator<value_type>;
+        using iterator = std::pmr::vector<value_type>::iterator;
+        using const_iterator = std::pmr::vector<value_type>::const_iterator;
+        using const_reverse_iterator = std::pmr::vector<value_type>::const_reverse_iterator;
+
+        static constexpr size_t flat_limit = 16; ///< Largest size searched without the index.
+
+    private:
+        std::pmr::vector<value_type> entries; ///< Members in insertion order.
+        std::pmr::vector<uint32_t> index;     ///< Positions of the members plus one, by hash; empty up to flat_limit members.
+        std::pmr::vector<bool> held;          ///< Whether the characters of each key are held by this dictionary object.
+        std::pmr::memory_resource* chars = nullptr; ///< Resource the held keys are copied into, or nullptr for heap blocks.
+        KeyPool* pool = nullptr;              ///< Pool the inserted keys are interned in, or nullptr to hold them.
+
+        /**
+         * @brief Copy the characters of a key into storage held by this
+         * dictionary object.
+         *
+         * @param key The characters of the key.
+         * @return A null-terminated view of the copy.
+         */
+        [[nodiscard]] std::string_view hold_key(std::string_view key) const;
+
+        /**
+         * @brief Release the storage of a held key.
+         *
+         * @param key A view returned by hold_key().
+         */
+        void release_key(std::string_view key) const;
+
+        /**
+         * @brief Append a null member, and index it.
+         *
+         * @param key The key of the member.
+         * @param holds Whether the characters of key are held by this object.
+         * @return Reference to the document of the member.
+         */
+        Doc& append(std::string_view key, bool holds);
+
+        /**
+         * @brief Copy a key of another dictionary object for this one,
+         * sharing its heap block if it has one.
+         *
+         * @param other The dictionary object holding the key.
+         * @param i The position of the member in other.
+         * @return Whether the characters of the key are held by this object.
+         */
+        bool own_key(const DictObj& other, size_t i);
+
+        /**
+         * @brief Find the slot of the index holding a key, or the free slot
+         * where it would go.
+         *
+         * @param key The key to look for.
+         * @return The position of the slot in index.
+         */
+        [[nodiscard]] size_t slot_of(std::string_view key) const;
+
+        /**
+         * @brief Rebuild the index with a number of slots.
+         *
+         * @param slots Number of slots, a power of two larger than size().
+         */
+        void rehash(size_t slots);
+
+        /**
+         * @brief Find the position of a member in entries.
+         *
+         * @param key The key to look for.
+         * @return The position, or size() if there is no such member.
+         */
+        [[nodiscard]] size_t position(std::string_view key) const;
+
+    public:
+        /**
+         * @brief Default constructor, allocating with new and delete.
+         */
+        DictObj() = default;
+
+        /**
+         * @brief Constructor allocating from a memory resource.
+         *
+         * @param resource The resource, for instance an Arena.
+         */
+        explicit DictObj(std::pmr::memory_resource* resource);
+
+        /**
+         * @brief Copy constructor, allocating with new and delete.
+         *
+         * The copy shares the heap blocks of the held keys, copies the keys
+         * held in a memory resource, and views the other keys as other does.
+         * It interns its new keys in the same KeyPool as other.
+         *
+         * @param other Another dictionary object to copy from.
+         */
+        DictObj(const DictObj& other);
+
+        /**
+         * @brief Move constructor, taking over the members and keys of
+         * another dictionary object, which is left empty.
+         *
+         * @param other Another dictionary object to move from.
+         */
+        DictObj(DictObj&& other) noexcept;
+
+        /**
+         * @brief Assignment operator.
+         *
+         * @param other Another dictionary object to copy from.
+         * @return Reference to this dictionary object after assignment.
+         */
+        DictObj& operator=(const DictObj& other);
+
+        /**
+         * @brief Move assignment operator.
+         *
+         * The members and keys of other are taken over if both allocate from
+         * the same resource, and copied otherwise; other is left empty.
+         *
+         * @param other Another dictionary object to move from.
+         * @return Reference to this dictionary object after assignment.
+         */
+        DictObj& operator=(DictObj&& other);
+
+        /**
+         * @brief Destructor, releasing the held keys.
+         */
+        ~DictObj();
+
+        /**
+         * @brief Set the pool the keys inserted by operator[] are interned in.
+         *
+         * The members already inserted keep their keys.
+         *
+         * @param keys The pool, which must outlive the dictionary object, or
+         * nullptr to copy the keys into the dictionary object.
+         */
+        [[maybe_unused]] void set_key_pool(KeyPool* keys) { pool = keys; }
+
+        /**
+         * @brief Get the pool the keys inserted by operator[] are interned in.
+         *
+         * @return The pool, or nullptr if the keys are copied.
+         */
+        [[nodiscard]] [[maybe_unused]] KeyPool* get_key_pool() const { return pool; }
+
+        /**
+         * @brief Create a dictionary object on the heap with the keys of this
+         * one, each mapped to a null document.
+         *
+         * Heap blocks of keys are shared, keys held in a memory resource or
+         * viewed are copied, or interned if there is a KeyPool, so the copy
+         * outlives the resource and the input of this dictionary object.
+         *
+         * @return The new dictionary object, to be held by a Doc.
+         */
+        [[nodiscard]] DictObj* clone_keys() const;
+
+        /**
+         * @brief Get the number of members.
+         *
+         * @return The number of members.
+         */
+        [[nodiscard]] size_t size() const { return entries.size(); }
+
+        /**
+         * @brief Check whether there is no member.
+         *
+         * @return True if the dictionary object is empty.
+         */
+        [[nodiscard]] bool empty() const { return entries.empty(); }
+
+        [[nodiscard]] iterator begin() { return entries.begin(); }
+        [[nodiscard]] iterator end() { return entries.end(); }
+        [[nodiscard]] const_iterator begin() const { return entries.begin(); }
+        [[nodiscard]] const_iterator end() const { return entries.end(); }
+        [[nodiscard]] const_iterator cbegin() const { return entries.cbegin(); }
+        [[nodiscard]] const_iterator cend() const { return entries.cend(); }
+        [[nodiscard]] const_reverse_iterator rbegin() const { return entries.crbegin(); }
+        [[nodiscard]] const_reverse_iterator rend() const { return entries.crend(); }
+
+        /**
+         * @brief Find a member.
+         *
+         * @param key The key of the member.
+         * @return An iterator to the member, or end().
+         */
+        [[nodiscard]] iterator find(std::string_view key);
+
+        /**
+         * @brief Find a member without modifying the dictionary object.
+         *
+         * @param key The key of the member.
+         * @return An iterator to the member, or end().
+         */
+        [[nodiscard]] const_iterator find(std::string_view key) const;
+
+        /**
+         * @brief Count the members with a key.
+         *
+         * @param key The key of the member.
+         * @return 1 if there is such a member, 0 otherwise.
+         */
+        [[nodiscard]] size_t count(std::string_view key) const;
+
+        /**
+         * @brief Access a member, inserting a null document if there is none.
+         *
+         * New members are appended after the existing ones, with a copy of
+         * the key (or the key interned in the pool of set_key_pool()), so key
+         * may be a temporary. Finding an existing member copies nothing.
+         * Appending may reallocate the members, invalidating references to
+         * them, as with std::vector::push_back.
+         *
+         * @param key The key of the member.
+         * @return Reference to the document of the member.
+         */
+        Doc& operator[](std::string_view key);
+
+        /**
+         * @brief Access a member, inserting a null document whose key views
+         * the given characters if there is none.
+         *
+         * @param key The key of the member, whose characters must outlive
+         * the dictionary object.
+         * @return Reference to the document of the member.
+         */
+        Doc& emplace_view(std::string_view key);
+
+        /**
+         * @brief Access an existing member.
+         *
+         * @param key The key of the member.
+         * @throw std::out_of_range if there is no such member.
+         * @return Reference to the document of the member.
+         */
+        [[nodiscard]] const Doc& at(std::string_view key) const;
+
+        /**
+         * @brief Remove a member, keeping the order of the others.
+         *
+         * @param pos Iterator to the member.
+         * @return Iterator to the member that followed it.
+         */
+        iterator erase(const_iterator pos);
+
+        /**
+         * @brief Remove a member, keeping the order of the others.
+         *
+         * @param key The key of the member.
+         * @return The number of members removed, 0 or 1.
+         */
+        size_t erase(std::string_view key);
+
+        /**
+         * @brief Remove every member.
+         */
+        void clear();
+
+        /**
+         * @brief Reserve storage for a number of members.
+         *
+         * @param n The number of members.
+         */
+        void reserve(size_t n);
+    }; // struct DictObj
+
     /**
      * @brief Overload the stream insertion operator to output the string representation of a document to a stream.
      * The document is formatted as a JSON-like structure with 2 spaces as indentation for each level,
@@ -0,0 +1,300 @@
+// Image.h
+#pragma once
+
+#include "Doc.h"
+#include "MappedFile.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace JoSon {
+    /**
+     * @brief Read-only view of a value in a document image.
+     *
+     * An image is a pointer-free encoding of a Doc made to be queried in
+     * place: every value is a 16-byte slot, arrays and tuples are contiguous
+     * slots, and the members of a dictionary object are sorted by key for a
+     * binary search. Links are offsets from the start of the image, so an
+     * image can be mapped at any address, and several processes mapping the
+     * same file share one copy of it in the page cache.
+     *
+     * An ImageDoc is a base pointer and an offset: copying one is free, and
+     * nothing is allocated or decoded until to_doc() is called.
+     *
+     * @warning The view is valid as long as the Image it comes from.
+     */
+    struct ImageDoc {
+    private:
+        const char* base; ///< Start of the image.
+        size_t length;    ///< Size of the image in bytes.
+        size_t slot;      ///< Offset of the slot of the value.
+
+        friend struct Image;
+
+        /**
+         * @brief Constructor of a view of a slot.
+         *
+         * @param base Start of the image.
+         * @param length Size of the image in bytes.
+         * @param slot Offset of the slot.
+         */
+        ImageDoc(const char* base, size_t length, size_t slot);
+
+        /**
+         * @brief Reads a trivially copyable value of the image.
+         *
+         * @param offset Offset of the value.
+         * @throw std::runtime_error if the value lies outside the image.
+         */
+        template <typename T> [[nodiscard]] T load(size_t offset) const;
+
+        /**
+         * @brief Get the count or length stored in the slot.
+         */
+        [[nodiscard]] uint32_t slot_size() const;
+
+        /**
+         * @brief Get the payload stored in the slot.
+         */
+        [[nodiscard]] uint64_t payload() const;
+
+        /**
+         * @brief Get the offset of the body of a string, a long double or a
+         * container.
+         *
+         * @throw std::runtime_error if the body is not after the slot in the
+         * image.
+         */
+        [[nodiscard]] uint64_t body() const;
+
+        /**
+         * @brief Checks the type of the value before reading it.
+         *
+         * @param type The expected type.
+         * @throw std::runtime_error if the value has another type.
+         */
+        void expect(Type type) const;
+
+        /**
+         * @brief Get the key of the member of a dictionary object at a
+         * position of the sorted entries.
+         *
+         * @param body Offset of the entries.
+         * @param i Position in the sorted entries.
+         */
+        [[nodiscard]] std::string_view entry_key(size_t body, size_t i) const;
+
+    public:
+        /**
+         * @brief Get the type of the value.
+         */
+        [[nodiscard]] Type get_type() const;
+
+        /**
+         * @brief Get the number of members or elements of a container.
+         *
+         * @return The size of a container, the length of a string, 1 for
+         * other values.
+         */
+        [[nodiscard]] size_t size() const;
+
+        /**
+         * @brief Look up a member of a dictionary object, by binary search.
+         *
+         * @param key The key of the member.
+         * @param value Receives the value of the member, if found.
+         * @return True if the value is a dictionary object with this member.
+         */
+        [[nodiscard]] bool find(std::string_view key, ImageDoc& value) const;
+
+        /**
+         * @brief Look up an element of an arraylist or a tuple, in constant time.
+         *
+         * @param index The index of the element.
+         * @param value Receives the element, if found.
+         * @return True if the value is an arraylist or a tuple with this element.
+         */
+        [[nodiscard]] bool find(size_t index, ImageDoc& value) const;
+
+        /**
+         * @brief Check whether a dictionary object has a member.
+         *
+         * @param key The key of the member.
+         * @return 1 if the member exists, 0 otherwise.
+         */
+        [[nodiscard]] [[maybe_unused]] size_t count(std::string_view key) const;
+
+        /**
+         * @brief Get a member of a dictionary object.
+         *
+         * @param key The key of the member.
+         * @return The value of the member.
+         * @throw std::out_of_range if there is no such member.
+         * @throw std::runtime_error if the value is not a dictionary object.
+         */
+        [[nodiscard]] ImageDoc operator[](std::string_view key) const;
+
+        /**
+         * @brief Get an element of an arraylist or a tuple.
+         *
+         * @param index The index of the element.
+         * @return The element.
+         * @throw std::out_of_range if the index is out of range.
+         * @throw std::runtime_error if the value is not an arraylist or a tuple.
+         */
+        [[nodiscard]] ImageDoc operator()(size_t index) const;
+
+        /**
+         * @brief Get the members of a dictionary object in insertion order.
+         *
+         * @return The keys, viewing the image, with their values.
+         */
+        [[nodiscard]] std::vector<std::pair<std::string_view, ImageDoc>> members() const;
+
+        /**
+         * @brief Get the values of all the members or elements.
+         *
+         * @return The values in insertion order, empty if the value is not a
+         * container.
+         */
+        [[nodiscard]] std::vector<ImageDoc> children() const;
+
+        /**
+         * @brief Get the char value.
+         *
+         * @throw std::runtime_error if the value is not a Type::Char.
+         */
+        [[nodiscard]] [[maybe_unused]] char get_char() const;
+
+        /**
+         * @brief Get the int value.
+         *
+         * @throw std::runtime_error if the value is not a Type::Int.
+         */
+        [[nodiscard]] [[maybe_unused]] int get_int() const;
+
+        /**
+         * @brief Get the long long value.
+         *
+         * @throw std::runtime_error if the value is not a Type::LLong.
+         */
+        [[nodiscard]] [[maybe_unused]] long long get_l_long() const;
+
+        /**
+         * @brief Get the float value.
+         *
+         * @throw std::runtime_error if the value is not a Type::Float.
+         */
+        [[nodiscard]] [[maybe_unused]] float get_float() const;
+
+        /**
+         * @brief Get the double value.
+         *
+         * @throw std::runtime_error if the value is not a Type::Double.
+         */
+        [[nodiscard]] [[maybe_unused]] double get_double() const;
+
+        /**
+         * @brief Get the long double value.
+         *
+         * @throw std::runtime_error if the value is not a Type::LDouble.
+         */
+        [[nodiscard]] [[maybe_unused]] long double get_long_double() const;
+
+        /**
+         * @brief Get the bool value.
+         *
+         * @throw std::runtime_error if the value is not a Type::Bool.
+         */
+        [[nodiscard]] [[maybe_unused]] bool get_bool() const;
+
+        /**
+         * @brief Get the string value, viewing the image.
+         *
+         * @throw std::runtime_error if the value is not a Type::Str.
+         */
+        [[nodiscard]] [[maybe_unused]] std::string_view get_str_view() const;
+
+        /**
+         * @brief Get the string value as a null-terminated string in the image.
+         *
+         * @throw std::runtime_error if the value is not a Type::Str.
+         */
+        [[nodiscard]] [[maybe_unused]] const char* get_str() const;
+
+        /**
+         * @brief Check if the value is null.
+         */
+        [[nodiscard]] [[maybe_unused]] bool null_check() const { return get_type() == Type::Nullptr; }
+
+        /**
+         * @brief Copy the value into a document.
+         *
+         * Keys and strings are copied, so the document does not depend on the
+         * image.
+         *
+         * @return The value as a Doc.
+         */
+        [[nodiscard]] Doc to_doc() const;
+    }; // struct ImageDoc
+
+    /**
+     * @brief A document image, mapped from a file or viewing a buffer.
+     *
+     * Images are written by JoSon::Utils::doc_to_image() or
+     * JoSon::Utils::store_doc_to_image(). Opening one maps the file and checks
+     * its header; nothing is decoded.
+     *
+     * Example:
+     * @code
+     * JoSon::Image image("reference.jsi");
+     * JoSon::ImageDoc country = image.root()["countries"]["FR"];
+     * std::cout << country["name"].get_str_view() << '\n';
+     * @endcode
+     */
+    struct Image {
+    private:
+        MappedFile file;       ///< The mapping, if opened from a file.
+        std::string_view data; ///< The bytes of the image.
+
+        /**
+         * @brief Checks the header of the image.
+         *
+         * @throw std::runtime_error if data is not an image of this version, or
+         * was written on a platform of another byte order or long double size.
+         */
+        void check() const;
+
+    public:
+        /**
+         * @brief Constructor mapping an image file.
+         *
+         * @param path Path of the file.
+         * @throw std::runtime_error if the file cannot be opened or is not a
+         * valid image.
+         */
+        explicit Image(const std::string& path);
+
+        /**
+         * @brief Constructor viewing an image in memory.
+         *
+         * @param bytes The image; it must outlive the Image and its views.
+         * @param size Size of the image in bytes.
+         * @throw std::runtime_error if bytes is not a valid image.
+         */
+        Image(const char* bytes, size_t size);
+
+        /**
+         * @brief Get the root value.
+         */
+        [[nodiscard]] ImageDoc root() const;
+
+        /**
+         * @brief Get the bytes of the image.
+         */
+        [[nodiscard]] [[maybe_unused]] std::string_view view() const { return data; }
+    }; // struct Image
+} // namespace JoSon
@@ -1,21 +1,59 @@
 // JoSon.h
 #pragma once
 
+#include "Arena.h"
+#include "Bind.h"
 #include "Doc.h"
+#include "Image.h"
+#include "KeyPool.h"
+#include "LazyDoc.h"
+#include "MappedFile.h"
+#include "Observer.h"
+#include "Parser.h"
+#include "Path.h"
+#include "Sax.h"
+#include "Snapshot.h"
 #include "Viso.h"
+#include "Writer.h"
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <future>
 #include <string>
+#include <string_view>
+#include <vector>
 
 namespace JoSon::Utils {
 
     /**
      * @brief Stores a document as JSON in a file.
      *
+     * The document is serialized with JoSon::Writer and streamed to the file
+     * in chunks. A document that is not a dictionary object is stored under the
+     * key "Welcome to JoSon".
+     *
      * @param path The file path to store the JSON.
      * @param json_doc The document to be stored as JSON.
      * @param space_counts The number of spaces for indentation in the stored JSON
-     * file.
+     * file; 0 stores compact JSON.
      */
-    [[maybe_unused]] void store_doc_to_json(const std::string& path, const Doc& json_doc);
+    [[maybe_unused]] void store_doc_to_json(const std::string& path, const Doc& json_doc,
+                                            int space_counts = 2);
+
+    /**
+     * @brief Stores a document as JSON in a file, reporting to an observer.
+     *
+     * The observer receives Phase::Serialize: the bytes written are reported
+     * as each chunk is handed to the file, every Observer::interval bytes.
+     *
+     * @param path The file path to store the JSON.
+     * @param json_doc The document to be stored as JSON.
+     * @param observer The observer.
+     * @param space_counts The number of spaces for indentation, 0 for compact
+     * JSON.
+     */
+    [[maybe_unused]] void store_doc_to_json(const std::string& path, const Doc& json_doc,
+                                            Observer& observer, int space_counts = 2);
 
     /**
      * @brief Converts a JSON-formatted string into a hierarchical document
@@ -32,14 +70,95 @@ namespace JoSon::Utils {
      */
     [[nodiscard]] Doc string_to_doc(const std::string& input_str, bool show_bar = false);
 
+    /**
+     * @brief Converts a JSON-formatted string into a hierarchical document
+     * structure allocated from an arena.
+     *
+     * Every arraylist, dictionary object, key and string of the result is
+     * allocated from the arena, so that the whole document is freed in one
+     * Arena::release() instead of node by node.
+     *
+     * @param input_str The JSON-formatted string to be parsed.
+     * @param arena The arena to build the document in. It must outlive the
+     * returned document.
+     * @param show_bar Flag indicating whether to display a progress bar while
+     * parsing the string.
+     * @return A hierarchical document structure representing the parsed JSON data.
+     */
+    [[nodiscard]] Doc string_to_doc(const std::string& input_str, Arena& arena, bool show_bar = false);
+
+    /**
+     * @brief Converts a JSON-formatted string into a hierarchical document
+     * structure whose keys are interned in a pool.
+     *
+     * Every key is stored once in the pool, whatever the number of dictionary
+     * objects using it, and the dictionary objects of the document intern the
+     * keys later inserted into them in the pool too. Without a pool,
+     * string_to_doc() copies the keys into the dictionary objects.
+     *
+     * @param input_str The JSON-formatted string to be parsed.
+     * @param keys The pool to intern the keys in. It must outlive the returned
+     * document.
+     * @param show_bar Flag indicating whether to display a progress bar while
+     * parsing the string.
+     * @return A hierarchical document structure representing the parsed JSON data.
+     */
+    [[nodiscard]] Doc string_to_doc(const std::string& input_str, KeyPool& keys, bool show_bar = false);
+
+    /**
+     * @brief Converts a JSON-formatted string into a hierarchical document
+     * structure, reporting to an observer.
+     *
+     * @param input_str The JSON-formatted string to be parsed.
+     * @param observer Receives Phase::Parse, see Observer.
+     * @return A hierarchical document structure representing the parsed JSON data.
+     */
+    [[nodiscard]] [[maybe_unused]] Doc string_to_doc(const std::string& input_str, Observer& observer);
+
+    /**
+     * @brief Converts a JSON-formatted buffer into a hierarchical document
+     * structure without copying its keys and strings.
+     *
+     * Dictionary keys and Type::Str values of the result are (pointer, length)
+     * views into input_str, so no character is copied and no null terminator
+     * is written. Read such strings with Doc::get_str_view(). The buffer
+     * does not need a null terminator either.
+     *
+     * @warning The characters viewed by input_str must stay alive and unchanged
+     * for as long as the returned document is used.
+     *
+     * @param input_str The JSON-formatted buffer to be parsed.
+     * @param show_bar Flag indicating whether to display a progress bar while
+     * parsing the string.
+     * @return A hierarchical document structure viewing the parsed JSON data.
+     */
+    [[nodiscard]] Doc string_view_to_doc(std::string_view input_str, bool show_bar = false);
+
+    /**
+     * @brief Converts a JSON-formatted buffer into a hierarchical document
+     * structure without copying its keys and strings, with the containers
+     * allocated from an arena.
+     *
+     * @warning Both the characters viewed by input_str and the arena must
+     * outlive the returned document.
+     *
+     * @param input_str The JSON-formatted buffer to be parsed.
+     * @param arena The arena to allocate arraylists and dictionary objects from.
+     * @param show_bar Flag indicating whether to display a progress bar while
+     * parsing the string.
+     * @return A hierarchical document structure viewing the parsed JSON data.
+     */
+    [[nodiscard]] Doc string_view_to_doc(std::string_view input_str, Arena& arena,
+                                         bool show_bar = false);
+
     /**
      * @brief Reads a JSON file and converts its contents into a hierarchical
      * document structure.
      *
-     * This function opens the specified JSON file, reads its contents, and converts
-     * them into a hierarchical document structure representing the JSON data. It
-     * optionally displays a progress bar during the file reading process if the
-     * `show_bar` parameter is set to true.
+     * This function memory-maps the specified JSON file (see MappedFile) and
+     * parses the mapping directly, without copying it into a string. It
+     * optionally displays a progress bar, driven by the byte offset reached in
+     * the file, if the `show_bar` parameter is set to true.
      *
      * @param file_path The path to the JSON file to be read.
      * @param show_bar Flag indicating whether to display a progress bar during file
@@ -48,4 +167,386 @@ namespace JoSon::Utils {
      * from the file.
      */
     [[nodiscard]] [[maybe_unused]] Doc read_json_file(const std::string& file_path, bool show_bar = false);
+
+    /**
+     * @brief Reads a JSON file and converts its contents into a hierarchical
+     * document structure allocated from an arena.
+     *
+     * @param file_path The path to the JSON file to be read.
+     * @param arena The arena to build the document in. It must outlive the
+     * returned document.
+     * @param show_bar Flag indicating whether to display a progress bar during file
+     * reading.
+     * @return A hierarchical document structure representing the JSON data read
+     * from the file.
+     */
+    [[nodiscard]] [[maybe_unused]] Doc read_json_file(const std::string& file_path, Arena& arena,
+                                                      bool show_bar = false);
+
+    /**
+     * @brief Reads a JSON file and converts its contents into a hierarchical
+     * document structure whose keys are interned in a pool.
+     *
+     * @param file_path The path to the JSON file to be read.
+     * @param keys The pool to intern the keys in. It must outlive the returned
+     * document.
+     * @param show_bar Flag indicating whether to display a progress bar during file
+     * reading.
+     * @return A hierarchical document structure representing the JSON data read
+     * from the file.
+     */
+    [[nodiscard]] [[maybe_unused]] Doc read_json_file(const std::string& file_path, KeyPool& keys,
+                                                      bool show_bar = false);
+
+    /**
+     * @brief Reads a JSON file and converts its contents into a hierarchical
+     * document structure, reporting to an observer.
+     *
+     * @param file_path The path to the JSON file to be read.
+     * @param observer Receives Phase::Parse, see Observer.
+     * @return A hierarchical document structure representing the JSON data read
+     * from the file.
+     */
+    [[nodiscard]] [[maybe_unused]] Doc read_json_file(const std::string& file_path, Observer& observer);
+
+    /**
+     * @brief Parses one large JSON document on several threads.
+     *
+     * A root array or object is cut into slices at commas between its members:
+     * a parallel scan of quotes and brackets finds where each thread can start,
+     * every slice is parsed on its own thread, and the pieces are joined in
+     * order. The result is the document string_to_doc() would return. Inputs
+     * under 1 MiB per thread, other root values, and inputs whose slices do
+     * not parse on their own (for instance unbalanced quotes) are parsed
+     * serially.
+     *
+     * @param input The JSON-formatted string to be parsed.
+     * @param threads Number of parsing threads; 0 uses one per hardware thread.
+     * @return A hierarchical document structure representing the parsed JSON data.
+     */
+    [[nodiscard]] [[maybe_unused]] Doc parse_json_parallel(std::string_view input,
+                                                           size_t threads = 0);
+
+    /**
+     * @brief Reads a large JSON file and parses it on several threads.
+     *
+     * The file is memory-mapped and parsed in place; see parse_json_parallel().
+     *
+     * @param file_path The path to the JSON file to be read.
+     * @param threads Number of parsing threads; 0 uses one per hardware thread.
+     * @return A hierarchical document structure representing the JSON data read
+     * from the file.
+     */
+    [[nodiscard]] [[maybe_unused]] Doc read_json_file_parallel(const std::string& file_path,
+                                                               size_t threads = 0);
+
+    /**
+     * @brief Encodes a document in the JoSon binary format.
+     *
+     * Unlike JSON, the binary format keeps every Type, including Char, Float,
+     * LDouble and Tuple, and loading it involves no text parsing. Each
+     * container is prefixed with its byte size, so readers such as
+     * binary_select() jump over the sub-trees they do not need.
+     *
+     * @param doc The document to encode.
+     * @return The encoded bytes.
+     */
+    [[nodiscard]] std::string doc_to_binary(const Doc& doc);
+
+    /**
+     * @brief Decodes a document encoded by doc_to_binary().
+     *
+     * Keys and strings are copied, so the document does not depend on data.
+     *
+     * @param data The encoded bytes.
+     * @return The decoded document.
+     * @throw std::runtime_error if data is not a binary document of this
+     * version, was written on a platform of another byte order or long double
+     * size, or is truncated.
+     */
+    [[nodiscard]] Doc binary_to_doc(std::string_view data);
+
+    /**
+     * @brief Decodes only the values of a binary document matching a path.
+     *
+     * The sub-trees off the path are skipped through their byte sizes
+     * without being read.
+     *
+     * @param data The encoded bytes.
+     * @param path The path of the values to decode.
+     * @return The matching values, in document order.
+     * @throw std::runtime_error as binary_to_doc().
+     */
+    [[nodiscard]] [[maybe_unused]] std::vector<Doc> binary_select(std::string_view data,
+                                                                  const Path& path);
+
+    /**
+     * @brief Stores a document in a file in the JoSon binary format.
+     *
+     * @param path The path of the file to write.
+     * @param doc The document to store.
+     */
+    [[maybe_unused]] void store_doc_to_binary(const std::string& path, const Doc& doc);
+
+    /**
+     * @brief Reads a file written by store_doc_to_binary().
+     *
+     * The file is memory-mapped and decoded in place.
+     *
+     * @param file_path The path of the file.
+     * @return The decoded document, or a null document if the file cannot be
+     * opened.
+     * @throw std::runtime_error as binary_to_doc().
+     */
+    [[nodiscard]] [[maybe_unused]] Doc read_binary_file(const std::string& file_path);
+
+    /**
+     * @brief Encodes a document as an image, to be queried in place.
+     *
+     * An image is larger than the binary format but needs no decoding: it is
+     * opened with JoSon::Image, which maps it and reads values where they lie.
+     *
+     * @param doc The document to encode.
+     * @return The image bytes.
+     */
+    [[nodiscard]] std::string doc_to_image(const Doc& doc);
+
+    /**
+     * @brief Stores a document in a file as an image.
+     *
+     * @param path The path of the file to write.
+     * @param doc The document to store.
+     */
+    [[maybe_unused]] void store_doc_to_image(const std::string& path, const Doc& doc);
+
+    /**
+     * @brief Parses a JSON-formatted string into events, without building a
+     * document.
+     *
+     * The string is indexed with the same SIMD scanner as string_to_doc(), and
+     * the handler receives each key, value and container boundary in order.
+     * The views passed to the handler point into input and stay valid as long
+     * as input does.
+     *
+     * @param input The JSON-formatted string to be parsed.
+     * @param handler The receiver of the events.
+     * @param show_bar Flag indicating whether to display a progress bar.
+     * @return False if the content is empty or malformed at the top level, or
+     * if the handler asked to stop.
+     */
+    [[maybe_unused]] bool parse_sax(std::string_view input, Handler& handler,
+                                    bool show_bar = false);
+
+    /**
+     * @brief Parses a JSON-formatted string into events, reporting to an
+     * observer.
+     *
+     * @param input The JSON-formatted string to be parsed.
+     * @param handler The receiver of the events.
+     * @param observer Receives Phase::Parse, see Observer.
+     * @return As parse_sax(std::string_view, Handler&, bool).
+     */
+    [[maybe_unused]] bool parse_sax(std::string_view input, Handler& handler, Observer& observer);
+
+    /**
+     * @brief Parses a JSON file into events, reading it in chunks.
+     *
+     * The file is read chunk_size bytes at a time and fed to a StreamParser,
+     * so memory use does not depend on the size of the file. The views passed
+     * to the handler are only valid during each call.
+     *
+     * @param file_path The path to the JSON file.
+     * @param handler The receiver of the events.
+     * @param chunk_size Bytes read at a time.
+     * @return True if a complete document has been parsed and the handler did
+     * not stop.
+     */
+    [[maybe_unused]] bool stream_json_file(const std::string& file_path, Handler& handler,
+                                           size_t chunk_size = 1 << 20);
+
+    /**
+     * @brief Reads and parses a JSON file on a background thread.
+     *
+     * The file is read chunk_size bytes at a time by one thread and fed to a
+     * StreamParser by another, so that reading a chunk overlaps parsing the
+     * previous one and the load takes about as long as the slower of the two.
+     *
+     * @param file_path The path to the JSON file.
+     * @param chunk_size Bytes read at a time; two chunks are buffered.
+     * @return A future of the document. It throws std::runtime_error if the
+     * file cannot be opened or read, or does not hold a complete JSON
+     * document.
+     */
+    [[nodiscard]] [[maybe_unused]] std::future<Doc> read_json_file_async(const std::string& file_path,
+                                                                         size_t chunk_size = 1 << 20);
+
+    /**
+     * @brief Reads and parses a JSON file on a background thread, calling
+     * back on completion.
+     *
+     * @param file_path The path to the JSON file.
+     * @param callback Called on the background thread with the document, and
+     * with the exception of a failed load (then the document is null).
+     * @param chunk_size Bytes read at a time; two chunks are buffered.
+     */
+    [[maybe_unused]] void read_json_file_async(const std::string& file_path,
+                                               std::function<void(Doc&, std::exception_ptr)> callback,
+                                               size_t chunk_size = 1 << 20);
+
+    /**
+     * @brief Stores a document as JSON in a file on a background thread.
+     *
+     * The file is written as by store_doc_to_json(). The document shares its
+     * containers with json_doc, which must not be modified before the
+     * future is ready.
+     *
+     * @param path The path of the file.
+     * @param json_doc The document to store.
+     * @param space_counts Spaces per nesting level.
+     * @return A future of the completion. It throws std::runtime_error if the
+     * file cannot be opened or written.
+     */
+    [[nodiscard]] [[maybe_unused]] std::future<void> store_doc_to_json_async(const std::string& path,
+                                                                             const Doc& json_doc,
+                                                                             int space_counts = 2);
+
+    /**
+     * @brief Stores a document as JSON in a file on a background thread,
+     * calling back on completion.
+     *
+     * @param path The path of the file.
+     * @param json_doc The document to store; it must not be modified before
+     * the callback.
+     * @param callback Called on the background thread, with the exception of
+     * a failed store or nullptr.
+     * @param space_counts Spaces per nesting level.
+     */
+    [[maybe_unused]] void store_doc_to_json_async(const std::string& path, const Doc& json_doc,
+                                                  std::function<void(std::exception_ptr)> callback,
+                                                  int space_counts = 2);
+
+    /**
+     * @brief Parses newline-delimited JSON (JSON Lines), one document per line.
+     *
+     * Blank lines are skipped. The lines are parsed in parallel and the
+     * documents are returned in input order.
+     *
+     * @param input The JSON Lines text.
+     * @param threads Number of parsing threads; 0 uses one per hardware thread.
+     * @return One document per non-blank line.
+     */
+    [[nodiscard]] [[maybe_unused]] std::vector<Doc> parse_json_lines(std::string_view input,
+                                                                     size_t threads = 0);
+
+    /**
+     * @brief Parses newline-delimited JSON (JSON Lines), handing each record to
+     * a callback.
+     *
+     * Lines are parsed in parallel batches and the callback is called on the
+     * calling thread, in input order, so only one batch is held in memory.
+     *
+     * @param input The JSON Lines text.
+     * @param callback Receives the index of each record and the record, which
+     * it may move from.
+     * @param threads Number of parsing threads; 0 uses one per hardware thread.
+     * @return The number of records.
+     */
+    [[maybe_unused]] size_t parse_json_lines(std::string_view input,
+                                             const std::function<void(size_t, Doc&)>& callback,
+                                             size_t threads = 0);
+
+    /**
+     * @brief Reads a newline-delimited JSON (JSON Lines) file, one document per
+     * line.
+     *
+     * The file is memory-mapped and split in place; see parse_json_lines().
+     *
+     * @param file_path The path to the file.
+     * @param threads Number of parsing threads; 0 uses one per hardware thread.
+     * @return One document per non-blank line.
+     */
+    [[nodiscard]] [[maybe_unused]] std::vector<Doc> read_json_lines(const std::string& file_path,
+                                                                    size_t threads = 0);
+
+    /**
+     * @brief Reads a newline-delimited JSON (JSON Lines) file, handing each
+     * record to a callback.
+     *
+     * @param file_path The path to the file.
+     * @param callback Receives the index of each record and the record, which
+     * it may move from.
+     * @param threads Number of parsing threads; 0 uses one per hardware thread.
+     * @return The number of records.
+     */
+    [[maybe_unused]] size_t read_json_lines(const std::string& file_path,
+                                            const std::function<void(size_t, Doc&)>& callback,
+                                            size_t threads = 0);
+
+    /**
+     * @brief Decodes the escape sequences of a JSON string and validates its
+     * UTF-8, as the parser does for the strings and keys of a Doc.
+     *
+     * Meant for the raw strings a Handler receives. The decoding is lenient:
+     * unknown escapes are kept as written, and lone surrogates and invalid
+     * UTF-8 become U+FFFD.
+     *
+     * @param raw The characters between the quotes.
+     * @return The decoded string.
+     */
+    [[nodiscard]] [[maybe_unused]] std::string unescape_json_string(std::string_view raw);
+
+    /**
+     * @brief Escapes a string for a JSON text, as the writers do.
+     *
+     * @param text The string.
+     * @return The escaped string, without the enclosing quotes.
+     */
+    [[nodiscard]] [[maybe_unused]] std::string escape_json_string(std::string_view text);
+
+    /**
+     * @brief Compares two documents by value.
+     *
+     * Dictionary objects are equal when they have the same members, whatever
+     * their order, and containers shared by both documents are not read.
+     * Numbers are compared by value whatever their Type, so Doc(1) equals
+     * Doc(1.0), as RFC 6902 requires of "test".
+     *
+     * @param a A document.
+     * @param b Another document.
+     * @return True if the documents hold the same value.
+     */
+    [[nodiscard]] [[maybe_unused]] bool docs_equal(const Doc& a, const Doc& b);
+
+    /**
+     * @brief Computes the JSON Patch (RFC 6902) turning one document into
+     * another.
+     *
+     * Both trees are walked once, side by side, and containers they share
+     * (copies of the same Doc) are skipped without being read. Members are
+     * matched by key; elements of arraylists by position, except that when
+     * the lengths differ the common tail is matched first, so that an element
+     * inserted or removed in the middle yields a single "add" or "remove".
+     * Other changes are "replace" operations.
+     *
+     * @param from The old document.
+     * @param to The new document.
+     * @return The patch, an arraylist of operations whose values share their
+     * containers with to.
+     */
+    [[nodiscard]] [[maybe_unused]] Doc diff(const Doc& from, const Doc& to);
+
+    /**
+     * @brief Applies a JSON Patch (RFC 6902) to a document in place.
+     *
+     * The "add", "remove", "replace", "move", "copy" and "test" operations
+     * modify the existing arraylists and dictionary objects of doc, so the
+     * containers of doc are changed for every Doc sharing them. Values are
+     * cloned from the patch, and new keys copied as by DictObj::operator[].
+     *
+     * @param doc The document to modify.
+     * @param patch The patch, an arraylist of operations.
+     * @throw std::runtime_error if an operation is malformed, its path does
+     * not resolve, or a "test" fails; the operations before it stay applied.
+     */
+    [[maybe_unused]] void apply_patch(Doc& doc, const Doc& patch);
 } // namespace JoSon::Utils
@@ -0,0 +1,81 @@
+// KeyPool.h
+#pragma once
+
+#include "Arena.h"
+#include <cstddef>
+#include <mutex>
+#include <string_view>
+#include <unordered_set>
+
+namespace JoSon {
+    /**
+     * @brief Interning pool storing each distinct dictionary key once.
+     *
+     * intern() returns the same view, pointer included, for every key with
+     * the same characters, so documents parsed from records with the same
+     * schema share their key characters instead of copying them into every
+     * dictionary object, and DictObj compares such keys by pointer before
+     * comparing characters.
+     *
+     * The characters are kept until the pool is destroyed. Interning is opt-in:
+     * the parser interns its keys only in a pool it is given (see
+     * JoSon::Utils::string_to_doc(const std::string&, KeyPool&, bool)), and
+     * otherwise lets each dictionary object hold copies of its keys, freed
+     * with the document.
+     *
+     * The pool is safe to use from several threads: it is split into shards
+     * by hash, each with its own lock.
+     *
+     * @warning Documents whose keys come from a pool must not be used after
+     * the pool is destroyed.
+     */
+    struct KeyPool {
+    private:
+        /**
+         * @brief Part of the pool holding the keys of one range of hashes.
+         */
+        struct Shard {
+            std::mutex mutex;                      ///< Protects the fields below.
+            Arena chars{16 * 1024};                ///< Characters of the keys, null-terminated.
+            std::unordered_set<std::string_view> keys; ///< Views of the interned keys.
+        };
+
+        static constexpr size_t shard_count = 16; ///< Number of shards, a power of two.
+
+        Shard shards[shard_count]; ///< The shards.
+
+    public:
+        KeyPool() = default;
+
+        KeyPool(const KeyPool&) = delete;
+
+        KeyPool& operator=(const KeyPool&) = delete;
+
+        /**
+         * @brief Get the stored copy of a key, storing it on first use.
+         *
+         * @param key The characters of the key.
+         * @return A null-terminated view held by the pool, the same for every
+         * key with these characters.
+         */
+        [[nodiscard]] std::string_view intern(std::string_view key);
+
+        /**
+         * @brief Get the number of distinct keys stored.
+         *
+         * @return The number of keys.
+         */
+        [[nodiscard]] [[maybe_unused]] size_t size();
+
+        /**
+         * @brief Get the pool shared by the whole process.
+         *
+         * It is never destroyed, so its keys stay valid until the process exits.
+         * The library never interns in it by itself: pass it where a pool is
+         * taken, for keys from a small fixed set.
+         *
+         * @return The process-wide pool.
+         */
+        [[nodiscard]] static KeyPool& global();
+    }; // struct KeyPool
+} // namespace JoSon
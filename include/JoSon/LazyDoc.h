@@ -0,0 +1,240 @@
+// LazyDoc.h
+#pragma once
+
+#include "Doc.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+namespace JoSon {
+    /**
+     * @brief Read-only view of a JSON text, parsed on demand.
+     *
+     * The constructor only indexes the structural positions of the text with
+     * the SIMD scanner of the parser, and pairs every bracket with its
+     * matching one. Nothing is allocated per value: operator[] and operator()
+     * walk the members of a container and jump over the sub-trees they do
+     * not touch, and a value is turned into a Doc only when to_doc() or a
+     * getter reads it. Reading a few fields out of a large payload then costs
+     * the scan and the values read, not the whole tree.
+     *
+     * The values returned by operator[] and operator() are views sharing the
+     * index, so they are cheap to copy.
+     *
+     * Example:
+     * @code
+     * JoSon::LazyDoc payload(body); // body must outlive payload
+     * long long id = payload["user"]["id"].get_l_long();
+     * JoSon::Doc tags = payload["tags"].to_doc();
+     * @endcode
+     *
+     * @warning The text is not copied: it must outlive the LazyDoc and every
+     * view obtained from it. Documents returned by to_doc() do not depend on
+     * it.
+     */
+    struct LazyDoc {
+    private:
+        /**
+         * @brief Structural index of a text, shared by all the views of it.
+         */
+        struct Index {
+            std::string_view text;         ///< The JSON text.
+            std::vector<uint32_t> pos;     ///< Offsets of the structural characters.
+            std::vector<uint32_t> closing; ///< For each '{' or '[', the entry of its match.
+        };
+
+        std::shared_ptr<const Index> index; ///< The shared index.
+        size_t at;                          ///< Entry of pos where the value starts.
+
+        /**
+         * @brief Constructor of a view of a value.
+         *
+         * @param index The shared index.
+         * @param at Entry of pos where the value starts.
+         */
+        LazyDoc(std::shared_ptr<const Index> index, size_t at);
+
+        /**
+         * @brief Get the character starting an entry of the index.
+         *
+         * @param entry The entry, pos.size() for the end of the text.
+         * @return The character, or ']' past the end.
+         */
+        [[nodiscard]] char char_at(size_t entry) const;
+
+        /**
+         * @brief Get the entry following a value.
+         *
+         * @param entry Entry where the value starts.
+         * @return The first entry after the value.
+         */
+        [[nodiscard]] size_t skip(size_t entry) const;
+
+        /**
+         * @brief Get the entry of a member of the dictionary object.
+         *
+         * @param key The key of the member.
+         * @return The entry of its value, or pos.size() if there is none.
+         * @throw std::runtime_error if the value is not a dictionary object.
+         */
+        [[nodiscard]] size_t member(std::string_view key) const;
+
+        /**
+         * @brief Get the entry of an element of the arraylist.
+         *
+         * @param index The index of the element.
+         * @return The entry of the element, or pos.size() if there is none.
+         */
+        [[nodiscard]] size_t element(size_t index) const;
+
+    public:
+        /**
+         * @brief Constructor indexing a JSON text.
+         *
+         * @param text The JSON text, smaller than 4 GiB. It must outlive the
+         * LazyDoc and its views.
+         */
+        explicit LazyDoc(std::string_view text);
+
+        /**
+         * @brief Get the type of the value.
+         *
+         * Numbers are read to tell Type::Int, Type::LLong and Type::Double
+         * apart; containers are not.
+         *
+         * @return Type::Dict, Type::Array, Type::Str, Type::Bool, a number
+         * type, or Type::Nullptr for null and missing values.
+         */
+        [[nodiscard]] Type get_type() const;
+
+        /**
+         * @brief Get the number of members or elements of a container.
+         *
+         * The members are walked without being parsed.
+         *
+         * @return The size of a dictionary object or an arraylist, 1 for
+         * other values.
+         */
+        [[nodiscard]] size_t size() const;
+
+        /**
+         * @brief Check whether a dictionary object has a member.
+         *
+         * @param key The key of the member.
+         * @return 1 if the member exists, 0 otherwise.
+         * @throw std::runtime_error if the value is not a dictionary object.
+         */
+        [[nodiscard]] size_t count(std::string_view key) const;
+
+        /**
+         * @brief Get a member of a dictionary object.
+         *
+         * Keys are compared as they appear in the text, between the quotes.
+         *
+         * @param key The key of the member.
+         * @return A view of the value of the member.
+         * @throw std::out_of_range if there is no such member.
+         * @throw std::runtime_error if the value is not a dictionary object.
+         */
+        [[nodiscard]] LazyDoc operator[](std::string_view key) const;
+
+        /**
+         * @brief Get an element of an arraylist.
+         *
+         * @param index The index of the element.
+         * @return A view of the element.
+         * @throw std::out_of_range if the index is out of range.
+         * @throw std::runtime_error if the value is not an arraylist.
+         */
+        [[nodiscard]] LazyDoc operator()(size_t index) const;
+
+        /**
+         * @brief Look up a member of a dictionary object without throwing.
+         *
+         * @param key The key of the member.
+         * @param value Receives a view of the value of the member, if found.
+         * @return True if the value is a dictionary object with this member.
+         */
+        [[nodiscard]] bool find(std::string_view key, LazyDoc& value) const;
+
+        /**
+         * @brief Look up an element of an arraylist without throwing.
+         *
+         * @param index The index of the element.
+         * @param value Receives a view of the element, if found.
+         * @return True if the value is an arraylist with this element.
+         */
+        [[nodiscard]] bool find(size_t index, LazyDoc& value) const;
+
+        /**
+         * @brief Get views of the values of all the members or elements.
+         *
+         * @return The values in text order, empty if the value is not a
+         * container.
+         */
+        [[nodiscard]] std::vector<LazyDoc> children() const;
+
+        /**
+         * @brief Parse the value into a document.
+         *
+         * Only the characters of this value are parsed. Keys and strings are
+         * copied, so the document does not depend on the text.
+         *
+         * @return The value as string_to_doc() would parse it.
+         */
+        [[nodiscard]] Doc to_doc() const;
+
+        /**
+         * @brief Get the integer value.
+         *
+         * @throw std::runtime_error if the value is not a Type::Int.
+         */
+        [[nodiscard]] [[maybe_unused]] int get_int() const { return to_doc().get_int(); }
+
+        /**
+         * @brief Get the long long integer value.
+         *
+         * @throw std::runtime_error if the value is not a Type::LLong.
+         */
+        [[nodiscard]] [[maybe_unused]] long long get_l_long() const { return to_doc().get_l_long(); }
+
+        /**
+         * @brief Get the double value.
+         *
+         * @throw std::runtime_error if the value is not a Type::Double.
+         */
+        [[nodiscard]] [[maybe_unused]] double get_double() const { return to_doc().get_double(); }
+
+        /**
+         * @brief Get the boolean value.
+         *
+         * @throw std::runtime_error if the value is not a Type::Bool.
+         */
+        [[nodiscard]] [[maybe_unused]] bool get_bool() const { return to_doc().get_bool(); }
+
+        /**
+         * @brief Get the string value as a view of the text.
+         *
+         * Nothing is copied: the view points between the quotes in the text,
+         * escapes included as written.
+         *
+         * @throw std::runtime_error if the value is not a string.
+         */
+        [[nodiscard]] [[maybe_unused]] std::string_view get_str_view() const;
+
+        /**
+         * @brief Check if the value is null, or missing in the text.
+         */
+        [[nodiscard]] [[maybe_unused]] bool null_check() const { return get_type() == Type::Nullptr; }
+
+        /**
+         * @brief Get the text of the value.
+         *
+         * @return A view of the characters of the value, brackets or quotes
+         * included.
+         */
+        [[nodiscard]] [[maybe_unused]] std::string_view raw() const;
+    }; // struct LazyDoc
+} // namespace JoSon
@@ -0,0 +1,128 @@
+// MappedFile.h
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <string_view>
+
+namespace JoSon {
+    /**
+     * @brief Read-only view of a whole file, memory-mapped when possible.
+     *
+     * The file is mapped into memory (mmap on POSIX systems, a file mapping on
+     * Windows), so no copy of its content is made and the pages are read on
+     * demand. If the file cannot be mapped (for instance a pipe or a special
+     * file), it falls back to a single read into a buffer of the right size.
+     *
+     * The content is not null-terminated. It can be passed directly to
+     * JoSon::Utils::string_view_to_doc(), in which case the MappedFile must
+     * outlive the document.
+     */
+    struct MappedFile {
+    private:
+        const char* ptr;               ///< Start of the content.
+        size_t len;                    ///< Size of the content in bytes.
+        bool mapped;                   ///< Whether ptr is a memory mapping.
+        bool opened;                   ///< Whether a file is currently open.
+        std::unique_ptr<char[]> buffer; ///< Fallback storage if mapping failed.
+#ifdef _WIN32
+        void* map_handle; ///< Handle of the Windows file mapping object.
+#endif
+
+        /**
+         * @brief Reads the whole file into buffer.
+         *
+         * @param path Path of the file to read.
+         * @return True on success, false otherwise.
+         */
+        bool read_fallback(const std::string& path);
+
+    public:
+        /**
+         * @brief Default constructor.
+         *
+         * Constructs an instance with no file open.
+         */
+        MappedFile();
+
+        /**
+         * @brief Constructor opening a file.
+         *
+         * @param path Path of the file to open. Check is_open() for success.
+         */
+        explicit MappedFile(const std::string& path);
+
+        MappedFile(const MappedFile&) = delete;
+
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        /**
+         * @brief Move constructor. other is left with no file open.
+         *
+         * @param other Another instance to take the file from.
+         */
+        MappedFile(MappedFile&& other) noexcept;
+
+        /**
+         * @brief Move assignment. other is left with no file open.
+         *
+         * @param other Another instance to take the file from.
+         * @return Reference to this instance.
+         */
+        MappedFile& operator=(MappedFile&& other) noexcept;
+
+        /**
+         * @brief Destructor. Unmaps or frees the content.
+         */
+        ~MappedFile();
+
+        /**
+         * @brief Opens a file, closing the previous one if any.
+         *
+         * @param path Path of the file to open.
+         * @return True if the file could be mapped or read, false otherwise.
+         */
+        bool open(const std::string& path);
+
+        /**
+         * @brief Unmaps or frees the content. The views become invalid.
+         */
+        void close();
+
+        /**
+         * @brief Check if a file is open.
+         *
+         * @return True if a file is open, even if empty.
+         */
+        [[nodiscard]] bool is_open() const;
+
+        /**
+         * @brief Check if the content is memory-mapped rather than read into a buffer.
+         *
+         * @return True if the content is a memory mapping.
+         */
+        [[nodiscard]] [[maybe_unused]] bool is_mapped() const;
+
+        /**
+         * @brief Get the start of the content.
+         *
+         * @return Pointer to the first byte, which is not null-terminated.
+         */
+        [[nodiscard]] const char* data() const;
+
+        /**
+         * @brief Get the size of the content.
+         *
+         * @return Size of the file in bytes.
+         */
+        [[nodiscard]] size_t size() const;
+
+        /**
+         * @brief Get the content as a view.
+         *
+         * @return View of the whole file.
+         */
+        [[nodiscard]] std::string_view view() const;
+    }; // struct MappedFile
+} // namespace JoSon
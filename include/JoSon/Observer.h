@@ -0,0 +1,140 @@
+// Observer.h
+#pragma once
+
+#include "Doc.h"
+#include "Viso.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace JoSon {
+    /**
+     * @brief Work reported to an Observer.
+     */
+    enum class Phase : uint8_t {
+        Parse,    ///< Reading JSON text, into a tree or into events.
+        Serialize ///< Writing a document as JSON text.
+    };
+
+    /**
+     * @brief Counters of a parse or a serialization.
+     */
+    struct Stats {
+        static constexpr size_t type_count = static_cast<size_t>(Type::Dict) + 1; ///< Number of Type values.
+
+        size_t bytes = 0;              ///< Bytes consumed by a parse, produced by a serialization.
+        size_t nodes[type_count] = {}; ///< Values by Type, counted when Observer::counts_nodes is set.
+        size_t keys = 0;               ///< Members of objects, counted with the nodes.
+        size_t max_depth = 0;          ///< Deepest nesting of containers, counted with the nodes.
+        double seconds = 0;            ///< Wall-clock time of the phase.
+
+        /**
+         * @brief Get the number of values of a type.
+         *
+         * @param type The type.
+         */
+        [[nodiscard]] [[maybe_unused]] size_t count(Type type) const {
+            return nodes[static_cast<size_t>(type)];
+        }
+    }; // struct Stats
+
+    /**
+     * @brief Receives the progress and the counters of parses and
+     * serializations.
+     *
+     * An observer is passed to the overloads of JoSon::Utils taking one. It is
+     * called when a phase begins, every `interval` bytes, and when the phase
+     * ends; nothing is called per character or per token. Without an
+     * observer, the parser is instantiated without any reporting code.
+     *
+     * Counting values by type makes the parser call the observer's counters
+     * for every event, so it is only done for observers setting counts_nodes.
+     *
+     * Example:
+     * @code
+     * JoSon::StatsObserver stats;
+     * JoSon::Doc doc = JoSon::Utils::read_json_file("events.json", stats);
+     * std::cout << stats.parse.bytes / stats.parse.seconds / 1e6 << " MB/s, "
+     *           << stats.parse.count(JoSon::Type::Dict) << " objects\n";
+     * @endcode
+     */
+    struct Observer {
+        size_t interval;   ///< Bytes between two calls to on_progress(); read after on_begin().
+        bool counts_nodes; ///< Whether Stats::nodes, keys and max_depth are counted.
+
+        /**
+         * @brief Constructor.
+         *
+         * @param interval Bytes between two calls to on_progress().
+         * @param counts_nodes Whether values are counted by type.
+         */
+        explicit Observer(size_t interval = 1 << 20, bool counts_nodes = false)
+                : interval(interval), counts_nodes(counts_nodes) {}
+
+        virtual ~Observer() = default;
+
+        /**
+         * @brief A phase begins.
+         *
+         * @param phase The phase.
+         * @param total Bytes to parse, or 0 if unknown.
+         */
+        virtual void on_begin([[maybe_unused]] Phase phase, [[maybe_unused]] size_t total) {}
+
+        /**
+         * @brief Progress of a phase, at least `interval` bytes after the last call.
+         *
+         * @param phase The phase.
+         * @param done Bytes consumed or produced so far.
+         * @param total Bytes to parse, or 0 if unknown.
+         */
+        virtual void on_progress([[maybe_unused]] Phase phase, [[maybe_unused]] size_t done,
+                                 [[maybe_unused]] size_t total) {}
+
+        /**
+         * @brief A phase ends.
+         *
+         * @param phase The phase.
+         * @param stats The counters of the phase.
+         */
+        virtual void on_end([[maybe_unused]] Phase phase, [[maybe_unused]] const Stats& stats) {}
+    }; // struct Observer
+
+    /**
+     * @brief Observer keeping the counters of the last parse and serialization.
+     */
+    struct StatsObserver final : public Observer {
+        Stats parse;     ///< Counters of the last parse.
+        Stats serialize; ///< Counters of the last serialization.
+
+        /**
+         * @brief Constructor, counting values by type.
+         */
+        StatsObserver() : Observer(SIZE_MAX, true) {}
+
+        void on_end(Phase phase, const Stats& stats) override;
+    }; // struct StatsObserver
+
+    /**
+     * @brief Observer drawing a Viso::ProgressBar on the standard output.
+     *
+     * This is what the show_bar flags of JoSon::Utils use. The bar is redrawn
+     * every percent of the input.
+     */
+    struct ProgressObserver final : public Observer {
+    private:
+        std::atomic<size_t> done;  ///< Bytes parsed so far.
+        std::atomic<size_t> total; ///< Bytes to parse.
+        Viso::ProgressBar bar;     ///< The bar, reading done and total.
+
+    public:
+        /**
+         * @brief Constructor.
+         */
+        ProgressObserver();
+
+        void on_begin(Phase phase, size_t total) override;
+        void on_progress(Phase phase, size_t done, size_t total) override;
+        void on_end(Phase phase, const Stats& stats) override;
+    }; // struct ProgressObserver
+} // namespace JoSon
@@ -0,0 +1,114 @@
+// Parser.h
+#pragma once
+
+#include "Arena.h"
+#include "Doc.h"
+#include "KeyPool.h"
+#include <memory>
+#include <string>
+#include <string_view>
+
+namespace JoSon {
+    /**
+     * @brief Reusable parser keeping its working storage between documents.
+     *
+     * JoSon::Utils::string_to_doc() sets up a structural index, a stack of
+     * open containers and a Syntax for every call. A Parser keeps them, along
+     * with the buffer files are read into, so that once it has seen a document
+     * of a given size and depth, parsing another one allocates nothing but the
+     * nodes of the result. This is the way to parse many small documents, for
+     * instance one per request.
+     *
+     * A Parser can build its documents in an Arena and intern their keys in a
+     * KeyPool; both are the caller's, and are used for every document until
+     * changed. With neither, documents are heap-allocated and hold copies of
+     * their keys, as with string_to_doc().
+     *
+     * A Parser is not thread-safe: use one per thread.
+     *
+     * Example:
+     * @code
+     * JoSon::Parser parser;
+     * for (const std::string& body : requests) {
+     *     JoSon::Doc request = parser.parse(body);
+     *     handle(request);
+     * }
+     * @endcode
+     */
+    struct Parser {
+    private:
+        struct State;                 ///< Retained storage, defined with the parser.
+        std::unique_ptr<State> state; ///< The retained storage.
+
+    public:
+        /**
+         * @brief Constructor.
+         *
+         * @param arena Arena to build the documents in, or nullptr to use new.
+         * It must outlive the documents.
+         * @param keys Pool to intern the keys in, or nullptr for the default.
+         * It must outlive the documents.
+         */
+        explicit Parser(Arena* arena = nullptr, KeyPool* keys = nullptr);
+
+        Parser(const Parser&) = delete;
+
+        Parser& operator=(const Parser&) = delete;
+
+        /**
+         * @brief Move constructor, taking over the storage of other.
+         */
+        Parser(Parser&& other) noexcept;
+
+        /**
+         * @brief Move assignment, taking over the storage of other.
+         */
+        Parser& operator=(Parser&& other) noexcept;
+
+        /**
+         * @brief Destructor, freeing the retained storage.
+         */
+        ~Parser();
+
+        /**
+         * @brief Sets the arena of the next documents.
+         *
+         * @param arena The arena, or nullptr to use new.
+         */
+        [[maybe_unused]] void set_arena(Arena* arena);
+
+        /**
+         * @brief Sets the pool of the keys of the next documents.
+         *
+         * @param keys The pool, or nullptr for the default.
+         */
+        [[maybe_unused]] void set_keys(KeyPool* keys);
+
+        /**
+         * @brief Parses a JSON-formatted string, copying its keys and strings.
+         *
+         * @param input The JSON-formatted string. No null terminator is needed.
+         * @return The parsed document, as string_to_doc() would return it.
+         */
+        [[nodiscard]] Doc parse(std::string_view input);
+
+        /**
+         * @brief Parses a JSON-formatted buffer without copying its keys and
+         * strings.
+         *
+         * @param input The JSON-formatted buffer. It must outlive the returned
+         * document, see string_view_to_doc().
+         * @return The parsed document.
+         */
+        [[nodiscard]] [[maybe_unused]] Doc parse_view(std::string_view input);
+
+        /**
+         * @brief Reads a JSON file into the retained buffer and parses it.
+         *
+         * @param file_path The path to the JSON file.
+         * @return The parsed document, or a null document if the file cannot
+         * be opened.
+         */
+        [[nodiscard]] [[maybe_unused]] Doc parse_file(const std::string& file_path);
+    }; // struct Parser
+} // namespace JoSon
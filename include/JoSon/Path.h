@@ -0,0 +1,265 @@
+// Path.h
+#pragma once
+
+#include "Doc.h"
+#include "Image.h"
+#include "LazyDoc.h"
+#include "Sax.h"
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace JoSon {
+    /**
+     * @brief Compiled path to values of a document.
+     *
+     * A path is parsed once, from a JSON Pointer (RFC 6901) or from a small
+     * JSONPath subset, and can then be evaluated against any number of
+     * documents: trees (Doc), lazy views (LazyDoc), images (ImageDoc), or
+     * event streams (PathFilter), in which case only the matching sub-trees
+     * are built.
+     *
+     * The JSONPath subset is a '$' followed by steps:
+     * - `.name` or `['name']`: the member with this key,
+     * - `[3]`: the element with this index,
+     * - `.*` or `[*]`: every member or element.
+     *
+     * Example:
+     * @code
+     * auto path = JoSon::Path::from_json_path("$.users[*].name");
+     * for (const JoSon::Doc* name : path.select(doc)) {
+     *     std::cout << name->get_str() << '\n';
+     * }
+     * const JoSon::Doc* id = JoSon::Path::from_pointer("/users/0/id").find(doc);
+     * @endcode
+     */
+    struct Path {
+    public:
+        /**
+         * @brief One step of a path.
+         */
+        struct Step {
+            /** @brief What the step matches. */
+            enum class Kind : uint8_t {
+                Key,        ///< The member with the key.
+                Index,      ///< The element with the index.
+                KeyOrIndex, ///< A JSON Pointer token: a member, or an element if numeric.
+                Any         ///< Every member or element.
+            };
+
+            std::string key; ///< Key of the member, for Key and KeyOrIndex.
+            size_t index;    ///< Index of the element, for Index and KeyOrIndex.
+            Kind kind;       ///< What the step matches.
+
+            /**
+             * @brief Checks whether a member of a dictionary object matches.
+             *
+             * @param name The key of the member.
+             */
+            [[nodiscard]] bool matches(std::string_view name) const {
+                return kind == Kind::Any || (kind != Kind::Index && name == key);
+            }
+
+            /**
+             * @brief Checks whether an element of an array matches.
+             *
+             * @param i The index of the element.
+             */
+            [[nodiscard]] bool matches(size_t i) const {
+                return kind == Kind::Any || (kind != Kind::Key && i == index);
+            }
+        };
+
+    private:
+        std::vector<Step> steps; ///< The steps, from the root.
+
+    public:
+        /**
+         * @brief Default constructor, the path to the root.
+         */
+        Path() = default;
+
+        /**
+         * @brief Compiles a JSON Pointer (RFC 6901).
+         *
+         * "" is the whole document, and "/a/b/3" the element 3 of the member
+         * "b" of the member "a". In a token, "~1" stands for '/' and "~0" for
+         * '~'. A numeric token selects an element of an arraylist or a tuple,
+         * and the member with that key in a dictionary object.
+         *
+         * @param pointer The JSON Pointer.
+         * @return The compiled path.
+         * @throw std::runtime_error if pointer is not empty and does not start
+         * with '/', or has a '~' not followed by '0' or '1'.
+         */
+        [[nodiscard]] static Path from_pointer(std::string_view pointer);
+
+        /**
+         * @brief Compiles a JSONPath expression of the supported subset.
+         *
+         * @param expression The expression, starting with '$'.
+         * @return The compiled path.
+         * @throw std::runtime_error if the expression is outside the subset.
+         */
+        [[nodiscard]] static Path from_json_path(std::string_view expression);
+
+        /**
+         * @brief Decodes a JSON Pointer token, "~1" into '/' and "~0" into '~'.
+         *
+         * @param token The token, without its leading '/'.
+         * @param key Receives the decoded token.
+         * @return False if the token has a '~' not followed by '0' or '1'.
+         */
+        [[nodiscard]] static bool decode_token(std::string_view token, std::string& key);
+
+        /**
+         * @brief Reads an array index made of decimal digits.
+         *
+         * @param text The digits.
+         * @param index Receives the index.
+         * @return False if text is empty, has a non-digit, a leading zero, or
+         * is too long to be an index.
+         */
+        [[nodiscard]] static bool read_index(std::string_view text, size_t& index);
+
+        /**
+         * @brief Get the number of steps.
+         *
+         * @return The depth of the matches below the root.
+         */
+        [[nodiscard]] [[maybe_unused]] size_t size() const { return steps.size(); }
+
+        /**
+         * @brief Get the compiled steps, for evaluators of other document
+         * representations.
+         *
+         * @return The steps, from the root.
+         */
+        [[nodiscard]] const std::vector<Step>& get_steps() const { return steps; }
+
+        /**
+         * @brief Get the first match in a document.
+         *
+         * @param doc The document.
+         * @return The first value matching the path, or nullptr.
+         */
+        [[nodiscard]] const Doc* find(const Doc& doc) const;
+
+        /**
+         * @brief Get every match in a document.
+         *
+         * @param doc The document.
+         * @return The values matching the path, in document order.
+         */
+        [[nodiscard]] std::vector<const Doc*> select(const Doc& doc) const;
+
+        /**
+         * @brief Get the first match in a lazy view, parsing nothing.
+         *
+         * @param doc The lazy view.
+         * @param value Receives a view of the first match, if found.
+         * @return True if a value matches the path.
+         */
+        [[nodiscard]] bool find(const LazyDoc& doc, LazyDoc& value) const;
+
+        /**
+         * @brief Get every match in a lazy view, parsing nothing.
+         *
+         * @param doc The lazy view.
+         * @return Views of the values matching the path, in document order.
+         */
+        [[nodiscard]] std::vector<LazyDoc> select(const LazyDoc& doc) const;
+
+        /**
+         * @brief Get the first match in a document image, decoding nothing.
+         *
+         * @param doc The image value.
+         * @param value Receives a view of the first match, if found.
+         * @return True if a value matches the path.
+         */
+        [[nodiscard]] bool find(const ImageDoc& doc, ImageDoc& value) const;
+
+        /**
+         * @brief Get every match in a document image, decoding nothing.
+         *
+         * @param doc The image value.
+         * @return Views of the values matching the path, in document order.
+         */
+        [[nodiscard]] std::vector<ImageDoc> select(const ImageDoc& doc) const;
+    }; // struct Path
+
+    /**
+     * @brief Handler building only the values matching a path.
+     *
+     * Placed between a parser and the application, it follows the position of
+     * the events in the document and ignores every value off the path, so
+     * non-matching sub-trees are never built. Each match is built with a
+     * TreeBuilder and handed to the callback.
+     *
+     * Example:
+     * @code
+     * JoSon::PathFilter filter(JoSon::Path::from_json_path("$.events[*].id"),
+     *                          [&](JoSon::Doc& id) { ids.push_back(id); return true; });
+     * JoSon::Utils::stream_json_file("events.json", filter);
+     * @endcode
+     */
+    struct PathFilter final : public Handler {
+    public:
+        /** @brief Receives a match; returns false to stop the parse. */
+        using Callback = std::function<bool(Doc&)>;
+
+    private:
+        /**
+         * @brief An open container outside the matches.
+         */
+        struct Frame {
+            size_t next;  ///< Index of the next element of an array.
+            bool dict;    ///< Whether the container is an object.
+            bool on_path; ///< Whether its position matches the path so far.
+        };
+
+        Path path;                 ///< The path to match.
+        Callback callback;         ///< Receiver of the matches.
+        std::vector<Frame> frames; ///< Open containers outside the matches.
+        TreeBuilder builder;       ///< Builder of the current match.
+        size_t capture;            ///< Depth inside the current match, 0 outside.
+        bool key_matches;          ///< Whether the last key matches the path.
+
+        /**
+         * @brief Locates the value starting now.
+         *
+         * @param on_path Receives whether its position matches the path so far.
+         * @return True if the value is a match.
+         */
+        bool locate(bool& on_path);
+
+        /**
+         * @brief Hands the current match to the callback.
+         *
+         * @return The result of the callback.
+         */
+        bool deliver();
+
+    public:
+        /**
+         * @brief Constructor.
+         *
+         * @param path The path to match.
+         * @param callback Receives each match, in document order.
+         */
+        PathFilter(Path path, Callback callback);
+
+        bool on_begin_object() override;
+        bool on_end_object() override;
+        bool on_begin_array() override;
+        bool on_end_array() override;
+        bool on_key(std::string_view key) override;
+        bool on_string(std::string_view value) override;
+        bool on_number(const Doc& value) override;
+        bool on_bool(bool value) override;
+        bool on_null() override;
+    }; // struct PathFilter
+} // namespace JoSon
@@ -0,0 +1,330 @@
+// Sax.h
+#pragma once
+
+#include "Arena.h"
+#include "Doc.h"
+#include "KeyPool.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace JoSon {
+    /**
+     * @brief Receives the events of a JSON parse (SAX interface).
+     *
+     * Every callback returns true to continue parsing and false to stop it.
+     * The default implementations ignore the event and continue, so a handler
+     * only overrides what it needs.
+     *
+     * Each member of an object is reported as on_key() followed by the events
+     * of its value. The views passed to on_key() and on_string() are only valid
+     * during the call, unless the input they come from is known to outlive the
+     * handler (as with JoSon::Utils::parse_sax()). Strings are reported as they
+     * appear between the quotes, escape sequences included;
+     * JoSon::Utils::unescape_json_string() decodes them.
+     */
+    struct Handler {
+        virtual ~Handler() = default;
+
+        /** @brief An object starts. */
+        virtual bool on_begin_object() { return true; }
+
+        /** @brief The innermost object ends. */
+        virtual bool on_end_object() { return true; }
+
+        /** @brief An array starts. */
+        virtual bool on_begin_array() { return true; }
+
+        /** @brief The innermost array ends. */
+        virtual bool on_end_array() { return true; }
+
+        /**
+         * @brief The key of the next member of the innermost object.
+         *
+         * @param key The key, without quotes.
+         */
+        virtual bool on_key([[maybe_unused]] std::string_view key) { return true; }
+
+        /**
+         * @brief A string value.
+         *
+         * @param value The string, without quotes.
+         */
+        virtual bool on_string([[maybe_unused]] std::string_view value) { return true; }
+
+        /**
+         * @brief A number.
+         *
+         * @param value A Doc of Type::Int, Type::LLong or Type::Double, chosen
+         * as the tree builder would.
+         */
+        virtual bool on_number([[maybe_unused]] const Doc& value) { return true; }
+
+        /**
+         * @brief A boolean.
+         *
+         * @param value The boolean value.
+         */
+        virtual bool on_bool([[maybe_unused]] bool value) { return true; }
+
+        /** @brief A null, or a missing or malformed value. */
+        virtual bool on_null() { return true; }
+    }; // struct Handler
+
+    /**
+     * @brief Handler building a Doc tree from the events.
+     *
+     * This is the consumer used by string_to_doc() and read_json_file(). The
+     * escape sequences of keys and strings are decoded and their UTF-8 is
+     * validated, as by JoSon::Utils::unescape_json_string().
+     */
+    struct TreeBuilder final : public Handler {
+    private:
+        std::vector<Doc> ge_stk; ///< Open containers, innermost last.
+        Doc root;                ///< The document being built.
+        std::string_view key;    ///< Key of the next member of a dictionary.
+        Arena* arena;            ///< Arena to allocate from, or nullptr.
+        KeyPool* keys;           ///< Pool to intern keys in, or nullptr.
+        bool borrow;             ///< Whether keys and strings are kept as views.
+        std::string scratch;     ///< Buffer decoding the escapes of strings.
+        std::string key_scratch; ///< Buffer holding the key until its value is read.
+
+        /**
+         * @brief Stores a value in the innermost container, or as the root.
+         *
+         * @param value The value to move in.
+         */
+        void attach(Doc&& value);
+
+        /**
+         * @brief Opens a container.
+         *
+         * @param type Type::Dict or Type::Array.
+         */
+        void open(Type type);
+
+    public:
+        /**
+         * @brief Constructor.
+         *
+         * @param arena Arena to allocate the document from, or nullptr to use new.
+         * @param borrow Whether keys and strings are stored as views of the
+         * input instead of copies. Only valid if the views passed to the
+         * handler outlive the document. Keys and strings with escapes are
+         * decoded into copies anyway.
+         * @param keys Pool to intern the keys in, which then also interns the
+         * keys later inserted into the dictionary objects. With nullptr, each
+         * dictionary object holds copies of its keys, in the arena if there
+         * is one, freed with the document.
+         */
+        explicit TreeBuilder(Arena* arena = nullptr, bool borrow = false,
+                             KeyPool* keys = nullptr);
+
+        bool on_begin_object() override;
+        bool on_end_object() override;
+        bool on_begin_array() override;
+        bool on_end_array() override;
+        bool on_key(std::string_view key) override;
+        bool on_string(std::string_view value) override;
+        bool on_number(const Doc& value) override;
+        bool on_bool(bool value) override;
+        bool on_null() override;
+
+        /**
+         * @brief Get the document built so far.
+         *
+         * @return The root Doc, Type::Nullptr if nothing has been parsed.
+         */
+        [[nodiscard]] Doc result() const;
+
+        /**
+         * @brief Hands the document over and starts a new one.
+         *
+         * The storage of the stack of open containers is kept, so that the
+         * next document is built without allocating it again.
+         *
+         * @param arena Arena to allocate the next document from, or nullptr.
+         * @param borrow Whether keys and strings of the next document are views.
+         * @param keys Pool to intern the keys of the next document in, or nullptr.
+         * @return The document built so far, see result().
+         */
+        [[nodiscard]] Doc reset(Arena* arena = nullptr, bool borrow = false,
+                                KeyPool* keys = nullptr);
+    }; // struct TreeBuilder
+
+    /**
+     * @brief Turns JSON tokens into Handler events.
+     *
+     * The tokenizers of the library (the SIMD structural scanner and
+     * StreamParser) report brackets, colons, commas, strings and bare tokens;
+     * Syntax tracks where they are in the document and calls the handler. It
+     * keeps the leniency of the parser: unquoted keys are accepted, a missing
+     * value reads as null, and extra or missing commas are tolerated.
+     *
+     * Memory is proportional to the nesting depth only.
+     */
+    struct Syntax {
+    private:
+        /** @brief What the innermost container accepts next. */
+        enum class Expect : uint8_t { Key, Colon, Value, Comma };
+
+        Handler& handler;        ///< Receiver of the events.
+        std::vector<bool> dicts; ///< Whether each open container is an object.
+        Expect expect;           ///< Next token expected.
+        bool has_key;            ///< Whether a key is waiting for its value.
+
+        /**
+         * @brief Checks whether the innermost container is an object.
+         */
+        [[nodiscard]] bool in_dict() const { return !dicts.empty() && dicts.back(); }
+
+        /**
+         * @brief Prepares for a value, giving it an empty key if it has none.
+         *
+         * @return The result of the handler, if it was called.
+         */
+        bool begin_value();
+
+    public:
+        /**
+         * @brief Constructor.
+         *
+         * @param handler Receiver of the events. It must outlive the Syntax.
+         */
+        explicit Syntax(Handler& handler);
+
+        /**
+         * @brief Expects a new root value, keeping the storage of the stack of
+         * open containers.
+         */
+        void reset();
+
+        /**
+         * @brief A '{' or a '['.
+         *
+         * @param dict Whether it is a '{'.
+         * @return False if the handler asked to stop.
+         */
+        bool open(bool dict);
+
+        /**
+         * @brief A '}' or a ']', closing the innermost container.
+         *
+         * @return False if the handler asked to stop.
+         */
+        bool close();
+
+        /** @brief A ':'. */
+        void colon();
+
+        /**
+         * @brief A ','.
+         *
+         * @return False if the handler asked to stop.
+         */
+        bool comma();
+
+        /**
+         * @brief A quoted string, used as a key or a value depending on its
+         * position.
+         *
+         * @param text The characters between the quotes.
+         * @return False if the handler asked to stop.
+         */
+        bool string(std::string_view text);
+
+        /**
+         * @brief A bare token: a number, true, false, null, or an unquoted key.
+         *
+         * @param text Text starting at the token. It may extend past the
+         * token: a value ends at the first whitespace, ',', '}' or ']', and an
+         * unquoted key at the first ':'.
+         * @return False if the handler asked to stop.
+         */
+        bool bare(std::string_view text);
+
+        /**
+         * @brief Checks whether the next token is a key.
+         *
+         * @return True if a bare token would be read as an unquoted key.
+         */
+        [[nodiscard]] bool wants_key() const {
+            return in_dict() && (expect == Expect::Key || expect == Expect::Comma);
+        }
+
+        /**
+         * @brief Get the number of open containers.
+         */
+        [[nodiscard]] size_t depth() const { return dicts.size(); }
+    }; // struct Syntax
+
+    /**
+     * @brief Incremental parser fed with chunks of JSON text.
+     *
+     * Chunks can be cut anywhere, even inside a token. Only the token spanning
+     * a chunk boundary is buffered, so memory stays proportional to the
+     * nesting depth and the longest string, whatever the size of the document.
+     *
+     * Example:
+     * @code
+     * JoSon::TreeBuilder builder;
+     * JoSon::StreamParser parser(builder);
+     * while (read_some(buffer)) {
+     *     parser.feed(buffer);
+     * }
+     * parser.finish();
+     * JoSon::Doc doc = builder.result();
+     * @endcode
+     */
+    struct StreamParser {
+    private:
+        /** @brief What the tokenizer is in the middle of. */
+        enum class Lex : uint8_t { Space, String, Bare };
+
+        Syntax syntax;     ///< Turns tokens into events.
+        std::string token; ///< Start of a token cut by the end of a chunk.
+        Lex lex;           ///< Current token kind.
+        bool escape;       ///< Whether the last character of a string was a backslash.
+        bool key_token;    ///< Whether the current bare token is an unquoted key.
+        bool started;      ///< Whether the root value has started.
+        bool complete;     ///< Whether the root value is complete.
+        bool stopped;      ///< Whether the handler asked to stop.
+
+        /**
+         * @brief Records the result of an event.
+         *
+         * @param ok The result of the handler.
+         * @return False if parsing must stop.
+         */
+        bool after_event(bool ok);
+
+    public:
+        /**
+         * @brief Constructor.
+         *
+         * @param handler Receiver of the events. It must outlive the parser.
+         */
+        explicit StreamParser(Handler& handler);
+
+        /**
+         * @brief Parses the next chunk of the document.
+         *
+         * Text after the end of the root value is ignored.
+         *
+         * @param chunk The next bytes of the document; it need not outlive the
+         * call.
+         * @return False if the handler asked to stop.
+         */
+        bool feed(std::string_view chunk);
+
+        /**
+         * @brief Signals the end of the input.
+         *
+         * @return True if a complete root value has been parsed and the
+         * handler did not stop.
+         */
+        bool finish();
+    }; // struct StreamParser
+} // namespace JoSon
@@ -0,0 +1,120 @@
+// Snapshot.h
+#pragma once
+
+#include "Doc.h"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+namespace JoSon {
+    /**
+     * @brief Latest version of a document shared by many reading threads and
+     * replaced as a whole by writers.
+     *
+     * A writer builds the new document aside and publish()es it; readers that
+     * hold the previous version keep it alive until they let go, as with
+     * read-copy-update. Readers that go through a Snapshot::Reader only load an
+     * atomic version counter in steady state, so they scale across cores
+     * without taking a lock nor writing to shared memory.
+     *
+     * Example:
+     * @code
+     * JoSon::Snapshot config(JoSon::Utils::read_json_file("config.json"));
+     *
+     * // On each request thread
+     * thread_local JoSon::Snapshot::Reader reader(config);
+     * const JoSon::Doc& current = reader.get();
+     * if (const JoSon::Doc* limit = current.find("rate_limit")) { ... }
+     *
+     * // On reload
+     * config.publish(JoSon::Utils::read_json_file("config.json"));
+     * @endcode
+     *
+     * @warning A published document must not be modified: Doc copies share
+     * their containers, so publish a clone() of a document that is still being
+     * edited. Readers use the const lookups (Doc::find(), Doc::at(),
+     * Doc::operator()), never Doc::operator[], which inserts on a miss.
+     */
+    class Snapshot {
+    public:
+        /**
+         * @brief A reading thread's handle on a Snapshot, caching the version
+         * it last loaded.
+         *
+         * A Reader is used by one thread at a time and must not outlive its
+         * Snapshot.
+         */
+        class Reader {
+        public:
+            /**
+             * @brief Construct a reader of a snapshot.
+             *
+             * @param source The snapshot to read.
+             */
+            explicit Reader(const Snapshot& source) : source(&source) {}
+
+            /**
+             * @brief Get the latest published document.
+             *
+             * The reference stays valid until the next call to get() or the
+             * destruction of this reader, even if a newer version is published
+             * meanwhile.
+             *
+             * @return The document.
+             */
+            [[nodiscard]] const Doc& get();
+
+        private:
+            const Snapshot* source;          ///< The snapshot read.
+            std::shared_ptr<const Doc> held; ///< The version last loaded.
+            uint64_t seen = 0;               ///< Its version number, 0 before the first load.
+        }; // class Reader
+
+        /**
+         * @brief Construct a snapshot of a null document.
+         */
+        Snapshot();
+
+        /**
+         * @brief Construct a snapshot of a document.
+         *
+         * @param doc The first version, which is no longer modified.
+         */
+        explicit Snapshot(Doc doc);
+
+        Snapshot(const Snapshot&) = delete;
+
+        Snapshot& operator=(const Snapshot&) = delete;
+
+        /**
+         * @brief Replace the document seen by readers.
+         *
+         * Safe to call from any thread, concurrently with readers and other
+         * writers. The previous version is destroyed by whichever thread lets
+         * go of it last.
+         *
+         * @param doc The new version, which is no longer modified.
+         */
+        void publish(Doc doc);
+
+        /**
+         * @brief Get the latest published document.
+         *
+         * Unlike Reader::get(), every call copies a std::shared_ptr atomically.
+         *
+         * @return The document, kept alive by the pointer.
+         */
+        [[nodiscard]] std::shared_ptr<const Doc> load() const;
+
+        /**
+         * @brief Get the number of versions published, the first one included.
+         *
+         * @return The version number of the latest document.
+         */
+        [[nodiscard]] uint64_t version() const { return versions.load(std::memory_order_acquire); }
+
+    private:
+        std::shared_ptr<const Doc> current; ///< The latest version, read and written atomically.
+        std::atomic<uint64_t> versions{0};  ///< Bumped after current is replaced.
+    }; // class Snapshot
+} // namespace JoSon
@@ -28,11 +28,26 @@ namespace JoSon::Viso {
      * This function prints a formatted version of a JSON string, allowing
      * customization of colors for strings, digits, and keywords.
      *
+     * The output is buffered and written in blocks of 64 KiB, and a color
+     * escape sequence is written once per string, number or keyword.
+     *
      * @param json_str The JSON string to be printed.
      * @param indents The number of indent spaces to use.
      */
     [[maybe_unused]] void json_print(const std::string& json_str, int indents = 2);
 
+    /**
+     * @brief Prints a document with customizable colors, without formatting
+     * it as a string first.
+     *
+     * Values are shown as by Doc::str(true). Objects have one member per
+     * line, indented by level, and arrays and tuples stay on one line.
+     *
+     * @param doc The document to be printed.
+     * @param indents The number of indent spaces to use.
+     */
+    [[maybe_unused]] void json_print(const Doc& doc, int indents = 2);
+
 
     /**
      * @brief Represents a progress bar to visualize the progress of a task.
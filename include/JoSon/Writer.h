@@ -0,0 +1,265 @@
+// Writer.h
+#pragma once
+
+#include "Doc.h"
+#include <cstddef>
+#include <cstdio>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace JoSon {
+    /**
+     * @brief Serializes documents to JSON text.
+     *
+     * The text is appended to a contiguous buffer owned by the writer. Without
+     * a sink the buffer keeps growing and its content is read with view() or
+     * take(); with a sink the buffer is handed to the sink whenever it fills up
+     * and on flush(), so that arbitrarily large documents are written with a
+     * bounded amount of memory.
+     *
+     * The tree is walked with an explicit stack that is kept between calls,
+     * and nothing is allocated per node. Two layouts are available: compact
+     * (indent of 0, no whitespace at all) and pretty (one value per line,
+     * nested by the given number of spaces).
+     *
+     * Large exports need not be built as one Doc: a writer can open arrays
+     * and objects itself with begin_array() and begin_object(), take their
+     * elements one write() at a time, and close them with end_array() and
+     * end_object(). With a sink, memory stays bounded by the buffer and the
+     * largest element. write_line() writes newline-delimited JSON instead.
+     *
+     * Example:
+     * @code
+     * JoSon::Writer writer(2);
+     * writer.write(doc);
+     * std::cout << writer.view() << '\n';
+     *
+     * JoSon::Writer out(JoSon::Writer::file_sink(stdout));
+     * out.begin_array();
+     * for (const Row& row : rows) {
+     *     out.write(to_doc(row)); // Written as produced
+     * }
+     * out.end_array().flush();
+     * @endcode
+     */
+    struct Writer {
+    public:
+        /** @brief Receives chunks of serialized text. */
+        using Sink = std::function<void(std::string_view)>;
+
+    private:
+        /**
+         * @brief Position in a container being written.
+         */
+        struct Frame {
+            const Doc* doc;                 ///< The container.
+            size_t index;                   ///< Next element of an array or tuple.
+            DictObj::const_iterator it;     ///< Next entry of a dictionary object.
+        };
+
+        std::string out;           ///< Serialized text not yet handed to the sink.
+        Sink sink;                 ///< Destination of the text, or empty.
+        size_t flush_at;           ///< Buffer size that triggers a flush to the sink.
+        int indent;                ///< Spaces per level, 0 for compact output.
+        std::vector<Frame> frames; ///< Containers being written, innermost last.
+
+        /**
+         * @brief Container opened by begin_array() or begin_object().
+         */
+        struct Open {
+            bool dict;    ///< Whether it is an object.
+            bool has_key; ///< Whether a key is waiting for its value.
+            size_t count; ///< Elements or members written so far.
+        };
+
+        std::vector<Open> open; ///< Streamed containers, innermost last.
+
+        /**
+         * @brief Starts a new line at the given depth in pretty mode.
+         *
+         * @param depth The nesting depth of the next value.
+         */
+        void newline(size_t depth);
+
+        /**
+         * @brief Writes a primitive Doc.
+         *
+         * @param doc The Doc to write; it must not be a non-empty container.
+         */
+        void write_prim(const Doc& doc);
+
+        /**
+         * @brief Writes the separator of the next element of a streamed
+         * container, if one is open.
+         *
+         * @throw std::runtime_error if an object is open and no key is waiting.
+         */
+        void before_value();
+
+        /**
+         * @brief Closes the innermost streamed container.
+         *
+         * @param bracket ']' or '}'.
+         */
+        void close(char bracket);
+
+        /**
+         * @brief Hands the buffer to the sink if it is full.
+         */
+        void maybe_flush() {
+            if (sink && out.size() >= flush_at) {
+                flush();
+            }
+        }
+
+    public:
+        /**
+         * @brief Constructor writing into the internal buffer.
+         *
+         * @param indent Spaces per nesting level; 0 writes compact JSON.
+         */
+        explicit Writer(int indent = 0);
+
+        /**
+         * @brief Constructor writing to a sink.
+         *
+         * @param sink Receives the text in chunks of about buffer_size bytes.
+         * @param indent Spaces per nesting level; 0 writes compact JSON.
+         * @param buffer_size Bytes buffered before each call to the sink.
+         */
+        explicit Writer(Sink sink, int indent = 0, size_t buffer_size = 64 * 1024);
+
+        /**
+         * @brief Appends a document as JSON.
+         *
+         * Tuples are written as arrays and characters as their code. In a
+         * streamed array the document is its next element, and in a streamed
+         * object the value of the last key().
+         *
+         * @param doc The document to write.
+         * @return A reference to this writer.
+         * @throw std::runtime_error in a streamed object without a key waiting.
+         */
+        Writer& write(const Doc& doc);
+
+        /**
+         * @brief Appends a document as one line of newline-delimited JSON
+         * (JSON Lines), compact whatever the indent.
+         *
+         * @param doc The record to write.
+         * @return A reference to this writer.
+         * @throw std::runtime_error if a streamed container is open.
+         */
+        Writer& write_line(const Doc& doc);
+
+        /**
+         * @brief Opens an array whose elements are the next writes.
+         *
+         * It is an element or a member value itself if a streamed container
+         * is open.
+         *
+         * @return A reference to this writer.
+         */
+        Writer& begin_array();
+
+        /**
+         * @brief Opens an object whose members are the next key() and write()
+         * pairs.
+         *
+         * @return A reference to this writer.
+         */
+        Writer& begin_object();
+
+        /**
+         * @brief Starts a member of the innermost streamed object.
+         *
+         * The value follows with write(), begin_array() or begin_object().
+         *
+         * @param name The key, escaped as needed.
+         * @return A reference to this writer.
+         * @throw std::runtime_error if no object is open or a key is waiting.
+         */
+        Writer& key(std::string_view name);
+
+        /**
+         * @brief Closes the innermost streamed array.
+         *
+         * @return A reference to this writer.
+         * @throw std::runtime_error if it is not an array.
+         */
+        Writer& end_array();
+
+        /**
+         * @brief Closes the innermost streamed object.
+         *
+         * @return A reference to this writer.
+         * @throw std::runtime_error if it is not an object or a key is waiting.
+         */
+        Writer& end_object();
+
+        /**
+         * @brief Get the number of streamed containers still open.
+         */
+        [[nodiscard]] [[maybe_unused]] size_t depth() const { return open.size(); }
+
+        /**
+         * @brief Appends raw text.
+         *
+         * @param text The text to append, written as is.
+         * @return A reference to this writer.
+         */
+        Writer& write_raw(std::string_view text);
+
+        /**
+         * @brief Hands the buffered text to the sink, if there is one.
+         */
+        void flush();
+
+        /**
+         * @brief Get the buffered text.
+         *
+         * @return A view valid until the next call modifying the writer.
+         */
+        [[nodiscard]] std::string_view view() const { return out; }
+
+        /**
+         * @brief Moves the buffered text out of the writer.
+         *
+         * @return The buffered text; the writer is left empty.
+         */
+        [[nodiscard]] std::string take();
+
+        /**
+         * @brief Discards the buffered text, keeping its capacity.
+         */
+        void clear() { out.clear(); }
+
+        /**
+         * @brief Serializes a document into a string.
+         *
+         * @param doc The document to write.
+         * @param indent Spaces per nesting level; 0 writes compact JSON.
+         * @return The JSON text.
+         */
+        [[nodiscard]] static std::string to_string(const Doc& doc, int indent = 0);
+
+        /**
+         * @brief Get a sink writing to a C stream.
+         *
+         * @param file The stream, open for writing. It must outlive the writer.
+         * @return The sink; it throws std::runtime_error if a write fails.
+         */
+        [[nodiscard]] static Sink file_sink(std::FILE* file);
+
+        /**
+         * @brief Get a sink writing to a file descriptor, such as a pipe or a
+         * socket.
+         *
+         * @param fd The descriptor, open for writing. It must outlive the writer.
+         * @return The sink; it throws std::runtime_error if a write fails.
+         */
+        [[nodiscard]] static Sink fd_sink(int fd);
+    }; // struct Writer
+} // namespace JoSon
@@ -0,0 +1,73 @@
+// Arena.cpp
+#include "../include/JoSon/Arena.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+namespace {
+    constexpr size_t max_block_size = 64 * 1024 * 1024;
+    // Blocks stop doubling past this size; huge requests still get their own block.
+}
+
+JoSon::Arena::Arena(size_t block_size)
+        : head(nullptr), cur(nullptr), end(nullptr),
+          next_size(std::max<size_t>(block_size, 2 * sizeof(Block))), used(0),
+          reserved(0), initial_size(next_size) {}
+// Constructor records the first block size; nothing is allocated yet.
+
+JoSon::Arena::~Arena() { release(); }
+// Destructor returns every block to the heap.
+
+void JoSon::Arena::grow(size_t bytes, size_t alignment) {
+    size_t needed = sizeof(Block) + bytes + alignment;
+    size_t size = std::max(next_size, needed);
+    auto* block = static_cast<Block*>(::operator new(size));
+    block->next = head;
+    block->size = size;
+    head = block;
+    cur = reinterpret_cast<char*>(block) + sizeof(Block);
+    end = reinterpret_cast<char*>(block) + size;
+    reserved += size;
+    next_size = std::min(next_size * 2, max_block_size);
+}
+// Chains a new block in front of the previous ones.
+
+void* JoSon::Arena::do_allocate(size_t bytes, size_t alignment) {
+    auto align_up = [alignment](char* p) {
+        auto addr = reinterpret_cast<std::uintptr_t>(p);
+        return reinterpret_cast<char*>((addr + alignment - 1) & ~(alignment - 1));
+    };
+    char* p = align_up(cur);
+    if (cur == nullptr || p + bytes > end) {
+        grow(bytes, alignment);
+        p = align_up(cur);
+    }
+    cur = p + bytes;
+    used += bytes;
+    return p;
+}
+// Bumps the cursor, starting a new block when the current one is exhausted.
+
+std::string_view JoSon::Arena::copy_str(std::string_view str) {
+    auto* copy = static_cast<char*>(allocate(str.size() + 1, 1));
+    std::memcpy(copy, str.data(), str.size());
+    copy[str.size()] = '\0';
+    return {copy, str.size()};
+}
+// Copies the characters and a null terminator into the arena.
+
+void JoSon::Arena::release() {
+    while (head != nullptr) {
+        Block* next = head->next;
+        ::operator delete(head);
+        head = next;
+    }
+    cur = end = nullptr;
+    used = reserved = 0;
+    next_size = initial_size;
+}
+// Frees all blocks and restarts from the initial block size.
+
+[[maybe_unused]] size_t JoSon::Arena::bytes_used() const { return used; }
+
+[[maybe_unused]] size_t JoSon::Arena::bytes_reserved() const { return reserved; }
@@ -0,0 +1,203 @@
+// Async.cpp
+#include "../include/JoSon/Joson.h"
+#include <condition_variable>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+
+namespace {
+    /**
+     * @brief Two chunk buffers passed between a reading and a parsing thread.
+     *
+     * The reader fills one buffer while the parser consumes the other, so a
+     * load takes about as long as the slower of the two.
+     */
+    struct ChunkPipe {
+        std::mutex mutex;                          ///< Protects the counters and flags.
+        std::condition_variable changed;           ///< Signals a chunk read or released.
+        std::unique_ptr<char[]> buffers[2];        ///< Chunk k lives in buffers[k % 2].
+        size_t sizes[2] = {0, 0};                  ///< Bytes of each buffer.
+        size_t produced = 0;                       ///< Chunks read.
+        size_t consumed = 0;                       ///< Chunks parsed.
+        bool eof = false;                          ///< Whether the reader is done.
+        bool failed = false;                       ///< Whether a read failed.
+        bool cancel = false;                       ///< Whether the parser stopped.
+
+        explicit ChunkPipe(size_t chunk_size) {
+            buffers[0].reset(new char[chunk_size]);
+            buffers[1].reset(new char[chunk_size]);
+        }
+    };
+
+    /**
+     * @brief Reads a file into the pipe until its end, or until the parser
+     * stops.
+     */
+    void read_chunks(std::FILE* file, ChunkPipe& pipe, size_t chunk_size) {
+        for (size_t k = 0;; ++k) {
+            {
+                std::unique_lock<std::mutex> lock(pipe.mutex);
+                pipe.changed.wait(lock, [&] { return pipe.produced - pipe.consumed < 2 || pipe.cancel; });
+                if (pipe.cancel) {
+                    return;
+                }
+            }
+            // The buffer is free: the parser released it before the wait returned
+            const size_t got = std::fread(pipe.buffers[k % 2].get(), 1, chunk_size, file);
+            std::lock_guard<std::mutex> lock(pipe.mutex);
+            pipe.sizes[k % 2] = got;
+            if (got > 0) {
+                ++pipe.produced;
+            }
+            if (got < chunk_size) {
+                pipe.eof = true;
+                pipe.failed = std::ferror(file) != 0;
+                pipe.changed.notify_all();
+                return;
+            }
+            pipe.changed.notify_all();
+        }
+    }
+
+    /**
+     * @brief Stops and joins the reading thread and closes its file when the
+     * parse ends, by returning or by throwing.
+     */
+    struct ReaderGuard {
+        ChunkPipe& pipe;     ///< The pipe the reader fills.
+        std::thread& reader; ///< The reading thread.
+        std::FILE* file;     ///< The file being read.
+
+        ~ReaderGuard() {
+            {
+                std::lock_guard<std::mutex> lock(pipe.mutex);
+                pipe.cancel = true; // No effect once the reader reached the end
+                pipe.changed.notify_all();
+            }
+            reader.join();
+            std::fclose(file);
+        }
+    };
+
+    /**
+     * @brief Reads and parses a file, the read of each chunk overlapping the
+     * parse of the previous one.
+     *
+     * @throw std::runtime_error if the file cannot be opened or read, or does
+     * not hold a complete JSON document.
+     */
+    JoSon::Doc load_json_file(const std::string& file_path, size_t chunk_size) {
+        chunk_size = chunk_size > 0 ? chunk_size : 1;
+        std::FILE* file = std::fopen(file_path.c_str(), "rb");
+        if (!file) {
+            throw std::runtime_error("Error: Unable to open JSON file '" + file_path + "'.");
+        }
+        ChunkPipe pipe(chunk_size);
+        JoSon::TreeBuilder builder;
+        JoSon::StreamParser parser(builder);
+        std::thread reader;
+        try {
+            reader = std::thread(read_chunks, file, std::ref(pipe), chunk_size);
+        } catch (...) {
+            std::fclose(file);
+            throw;
+        }
+        bool ok = true;
+        {
+            ReaderGuard guard{pipe, reader, file};
+            for (size_t k = 0; ok; ++k) {
+                {
+                    std::unique_lock<std::mutex> lock(pipe.mutex);
+                    pipe.changed.wait(lock, [&] { return pipe.consumed < pipe.produced || pipe.eof; });
+                    if (pipe.consumed == pipe.produced) {
+                        break; // End of the file
+                    }
+                }
+                ok = parser.feed({pipe.buffers[k % 2].get(), pipe.sizes[k % 2]});
+                std::lock_guard<std::mutex> lock(pipe.mutex);
+                ++pipe.consumed;
+                pipe.changed.notify_all();
+            }
+        }
+        if (pipe.failed || !ok || !parser.finish()) {
+            throw std::runtime_error("Error: Unable to read JSON file '" + file_path + "'.");
+        }
+        return builder.reset();
+    }
+
+    /**
+     * @brief Stores a document as store_doc_to_json() does.
+     *
+     * @throw std::runtime_error if the file cannot be opened or written.
+     */
+    void save_json_file(const std::string& path, const JoSon::Doc& json_doc, int space_counts) {
+        std::FILE* file = std::fopen(path.c_str(), "wb");
+        if (!file) {
+            throw std::runtime_error("Error: Unable to open file '" + path + "' for writing.");
+        }
+        try {
+            JoSon::Writer writer(JoSon::Writer::file_sink(file), space_counts);
+            if (json_doc.get_type() == JoSon::Type::Dict) {
+                writer.write(json_doc);
+            } else {
+                JoSon::Doc to_store(JoSon::Type::Dict);
+                to_store.upsert("Welcome to JoSon", json_doc);
+                writer.write(to_store);
+            }
+            writer.write_raw("\n");
+            writer.flush();
+        } catch (...) {
+            std::fclose(file);
+            throw;
+        }
+        if (std::fclose(file) != 0) {
+            throw std::runtime_error("Error: Unable to write file '" + path + "'.");
+        }
+    }
+} // namespace
+
+[[nodiscard]] [[maybe_unused]] std::future<JoSon::Doc>
+JoSon::Utils::read_json_file_async(const std::string& file_path, size_t chunk_size) {
+    return std::async(std::launch::async, load_json_file, file_path, chunk_size);
+}
+
+[[maybe_unused]] void
+JoSon::Utils::read_json_file_async(const std::string& file_path,
+                                   std::function<void(Doc&, std::exception_ptr)> callback,
+                                   size_t chunk_size) {
+    std::thread([file_path, callback = std::move(callback), chunk_size] {
+        Doc doc;
+        std::exception_ptr error;
+        try {
+            doc = load_json_file(file_path, chunk_size);
+        } catch (...) {
+            error = std::current_exception();
+        }
+        callback(doc, error);
+    }).detach();
+}
+// The callback runs on the loading thread, which ends with it.
+
+[[nodiscard]] [[maybe_unused]] std::future<void>
+JoSon::Utils::store_doc_to_json_async(const std::string& path, const Doc& json_doc,
+                                      int space_counts) {
+    return std::async(std::launch::async, save_json_file, path, json_doc, space_counts);
+}
+
+[[maybe_unused]] void
+JoSon::Utils::store_doc_to_json_async(const std::string& path, const Doc& json_doc,
+                                      std::function<void(std::exception_ptr)> callback,
+                                      int space_counts) {
+    std::thread([path, json_doc, callback = std::move(callback), space_counts] {
+        std::exception_ptr error;
+        try {
+            save_json_file(path, json_doc, space_counts);
+        } catch (...) {
+            error = std::current_exception();
+        }
+        callback(error);
+    }).detach();
+}
@@ -0,0 +1,493 @@
+// Binary.cpp
+#include "../include/JoSon/Joson.h"
+#include <cstring>
+#include <unordered_map>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+
+/*
+ * JoSon binary format (version 1)
+ *
+ * An 8-byte header: the magic "JoSB", the version, 1 for little-endian hosts
+ * (0 for big-endian ones), sizeof(long double), and a zero byte. Then the key
+ * table: a uint32 count and each distinct key of the document as a uint32
+ * length and its characters. Then the root value, written as a tag byte
+ * holding its JoSon::Type followed by a payload in the byte order of the
+ * header:
+ *
+ * - Char, Bool: 1 byte; Int, Float: 4 bytes; LLong, Double: 8 bytes;
+ * - LDouble: 16 bytes, the long double padded with zeros;
+ * - Str: a uint32 length and the characters;
+ * - Nullptr: nothing;
+ * - Tuple, Array: a uint32 count, a uint64 byte size of the elements, then the
+ *   elements;
+ * - Dict: a uint32 count, a uint64 byte size of the members, then each member
+ *   as the uint32 position of its key in the key table and the value.
+ *
+ * The byte sizes let a reader jump over a whole sub-tree without reading it,
+ * and the key table lets it intern each distinct key once.
+ */
+
+namespace {
+    constexpr char magic[4] = {'J', 'o', 'S', 'B'};            ///< First bytes of a binary document.
+    constexpr uint8_t version = 1;                             ///< Version of the format.
+    constexpr size_t header_size = 8;                          ///< Bytes of the header.
+    constexpr size_t ldouble_size = 16;                        ///< Bytes of a long double payload.
+
+    /**
+     * @brief Checks whether the host is little-endian.
+     */
+    bool little_endian() {
+        const uint16_t probe = 1;
+        uint8_t first;
+        std::memcpy(&first, &probe, 1);
+        return first == 1;
+    }
+
+    /**
+     * @brief Appends the bytes of a trivially copyable value.
+     *
+     * @param out The encoded bytes.
+     * @param value The value to append.
+     */
+    template <typename T> void put(std::string& out, T value) {
+        char bytes[sizeof(T)];
+        std::memcpy(bytes, &value, sizeof(T));
+        out.append(bytes, sizeof(T));
+    }
+
+    /**
+     * @brief Sequential reader of an encoded document.
+     */
+    struct Reader {
+        std::string_view data; ///< The encoded bytes.
+        size_t offset;         ///< Next byte to read.
+
+        /**
+         * @brief Checks that the next bytes exist.
+         *
+         * @param n Number of bytes.
+         * @throw std::runtime_error if fewer bytes remain.
+         */
+        void need(size_t n) const {
+            if (offset > data.size() || data.size() - offset < n) {
+                throw std::runtime_error("Error: Truncated binary document.");
+            }
+        }
+
+        /**
+         * @brief Reads a trivially copyable value.
+         */
+        template <typename T> T get() {
+            need(sizeof(T));
+            T value;
+            std::memcpy(&value, data.data() + offset, sizeof(T));
+            offset += sizeof(T);
+            return value;
+        }
+
+        /**
+         * @brief Reads a uint32 length and the characters after it.
+         */
+        std::string_view get_chars() {
+            auto length = get<uint32_t>();
+            need(length);
+            std::string_view chars = data.substr(offset, length);
+            offset += length;
+            return chars;
+        }
+
+        /**
+         * @brief Reads a tag byte.
+         *
+         * @throw std::runtime_error if it is not a JoSon::Type.
+         */
+        JoSon::Type get_type() {
+            auto tag = get<uint8_t>();
+            if (tag > static_cast<uint8_t>(JoSon::Type::Dict)) {
+                throw std::runtime_error("Error: Invalid type tag in binary document.");
+            }
+            return static_cast<JoSon::Type>(tag);
+        }
+
+        /**
+         * @brief Skips the value starting at offset, jumping over containers.
+         */
+        void skip() {
+            switch (get_type()) {
+                case JoSon::Type::Char:
+                case JoSon::Type::Bool:
+                    offset += 1;
+                    break;
+                case JoSon::Type::Int:
+                case JoSon::Type::Float:
+                    offset += 4;
+                    break;
+                case JoSon::Type::LLong:
+                case JoSon::Type::Double:
+                    offset += 8;
+                    break;
+                case JoSon::Type::LDouble:
+                    offset += ldouble_size;
+                    break;
+                case JoSon::Type::Str:
+                    offset += get<uint32_t>();
+                    break;
+                case JoSon::Type::Nullptr:
+                    break;
+                default:
+                    (void)get<uint32_t>();
+                    offset += get<uint64_t>();
+                    break;
+            }
+            need(0);
+        }
+    };
+} // namespace
+
+/**
+ * @brief Checks the header of an encoded document.
+ *
+ * @param data The encoded bytes.
+ * @throw std::runtime_error if the header is missing or from another platform.
+ */
+static void check_header(std::string_view data) {
+    if (data.size() < header_size || std::memcmp(data.data(), magic, 4) != 0) {
+        throw std::runtime_error("Error: Not a JoSon binary document.");
+    } else if (static_cast<uint8_t>(data[4]) != version) {
+        throw std::runtime_error("Error: Unsupported JoSon binary version.");
+    } else if (data[5] != (little_endian() ? 1 : 0) ||
+               static_cast<uint8_t>(data[6]) != sizeof(long double)) {
+        throw std::runtime_error("Error: Binary document written on another platform.");
+    }
+}
+
+/**
+ * @brief Reads the key table following the header.
+ *
+ * @param reader The reader, at the key table, left after it.
+ * @return The keys, views of the data that the dictionary objects copy.
+ */
+static std::vector<std::string_view> read_keys(Reader& reader) {
+    auto count = reader.get<uint32_t>();
+    reader.need(count); // Every key takes at least its length
+    std::vector<std::string_view> keys(count);
+    for (auto& key : keys) {
+        key = reader.get_chars();
+    }
+    return keys;
+}
+
+/**
+ * @brief Reads the position of a key in the key table.
+ *
+ * @param reader The reader.
+ * @param keys The key table.
+ * @return The key.
+ * @throw std::runtime_error if the position is outside the table.
+ */
+static std::string_view read_key(Reader& reader, const std::vector<std::string_view>& keys) {
+    auto id = reader.get<uint32_t>();
+    if (id >= keys.size()) {
+        throw std::runtime_error("Error: Invalid key in binary document.");
+    }
+    return keys[id];
+}
+
+/**
+ * @brief Decodes the value at the reader's offset.
+ *
+ * Containers are filled in place with an explicit stack, so the depth of the
+ * document does not consume call stack.
+ *
+ * @param reader The reader, left after the value.
+ * @param keys The key table.
+ * @return The decoded value.
+ */
+static JoSon::Doc decode_value(Reader& reader, const std::vector<std::string_view>& keys) {
+    using JoSon::Doc, JoSon::Type;
+    /** @brief A container being filled. */
+    struct Frame {
+        Doc container;    ///< The container.
+        Doc* slots;       ///< Elements of a tuple, filled in place.
+        size_t remaining; ///< Members or elements still to read.
+        size_t next;      ///< Next slot of a tuple.
+    };
+    std::vector<Frame> frames;
+    Doc root;
+    bool has_root = false;
+    while (!has_root || !frames.empty()) {
+        if (!frames.empty() && frames.back().remaining == 0) {
+            frames.pop_back();
+            continue;
+        }
+        std::string_view key;
+        if (!frames.empty() && frames.back().container.get_type() == Type::Dict) {
+            key = read_key(reader, keys);
+        }
+
+        Doc value;
+        Type type = reader.get_type();
+        size_t count = 0;
+        Doc* slots = nullptr;
+        switch (type) {
+            case Type::Char:
+                value = Doc(reader.get<char>());
+                break;
+            case Type::Int:
+                value = Doc(reader.get<int32_t>());
+                break;
+            case Type::LLong:
+                value = Doc(reader.get<long long>());
+                break;
+            case Type::Float:
+                value = Doc(reader.get<float>());
+                break;
+            case Type::Double:
+                value = Doc(reader.get<double>());
+                break;
+            case Type::LDouble: {
+                reader.need(ldouble_size);
+                long double number;
+                std::memcpy(&number, reader.data.data() + reader.offset, sizeof(long double));
+                reader.offset += ldouble_size;
+                value = Doc(number);
+                break;
+            }
+            case Type::Bool:
+                value = Doc(reader.get<uint8_t>() != 0);
+                break;
+            case Type::Str: {
+                std::string_view chars = reader.get_chars();
+                value = Doc(chars.data(), chars.size());
+                break;
+            }
+            case Type::Nullptr:
+                break;
+            case Type::Tuple:
+                count = reader.get<uint32_t>();
+                (void)reader.get<uint64_t>();
+                reader.need(count); // Every element takes at least a byte
+                slots = count > 0 ? new Doc[count] : nullptr;
+                value = Doc(new JoSon::DocTuple(slots, count));
+                break;
+            case Type::Array:
+                count = reader.get<uint32_t>();
+                (void)reader.get<uint64_t>();
+                reader.need(count);
+                value = Doc(new JoSon::DocArr(count > 0 ? count : 8));
+                break;
+            case Type::Dict: {
+                count = reader.get<uint32_t>();
+                (void)reader.get<uint64_t>();
+                reader.need(count);
+                auto* dict = new JoSon::DictObj();
+                dict->reserve(count);
+                value = Doc(dict);
+                break;
+            }
+        }
+
+        Doc handle = count > 0 ? value : Doc(); // Shares the container with its parent
+        if (frames.empty()) {
+            root = std::move(value);
+            has_root = true;
+        } else {
+            Frame& frame = frames.back();
+            --frame.remaining;
+            switch (frame.container.get_type()) {
+                case Type::Dict:
+                    frame.container.get_dict_obj()[key] = std::move(value);
+                    break;
+                case Type::Array:
+                    frame.container.get_arr().emplace_back(std::move(value));
+                    break;
+                default:
+                    frame.slots[frame.next++] = std::move(value);
+                    break;
+            }
+        }
+        if (count > 0) {
+            frames.push_back({std::move(handle), slots, count, 0});
+        }
+    }
+    return root;
+}
+
+[[nodiscard]] std::string JoSon::Utils::doc_to_binary(const Doc& doc) {
+    std::string out; // The root value, written after the key table
+    std::unordered_map<std::string_view, uint32_t> key_ids;
+    std::vector<std::string_view> keys;
+
+    /** @brief A container being written. */
+    struct Frame {
+        const Doc* doc;             ///< The container.
+        size_t index;               ///< Next element of an array or tuple.
+        DictObj::const_iterator it; ///< Next member of a dictionary object.
+        size_t size_at;             ///< Offset of the byte size to patch.
+    };
+    std::vector<Frame> frames;
+    const Doc* next = &doc;
+    while (true) {
+        if (next) {
+            const Type type = next->get_type();
+            out += static_cast<char>(type);
+            switch (type) {
+                case Type::Char:
+                    put(out, next->get_char());
+                    break;
+                case Type::Int:
+                    put(out, static_cast<int32_t>(next->get_int()));
+                    break;
+                case Type::LLong:
+                    put(out, next->get_l_long());
+                    break;
+                case Type::Float:
+                    put(out, next->get_float());
+                    break;
+                case Type::Double:
+                    put(out, next->get_double());
+                    break;
+                case Type::LDouble: {
+                    char bytes[ldouble_size] = {};
+                    long double number = next->get_long_double();
+                    std::memcpy(bytes, &number, sizeof(long double));
+                    out.append(bytes, ldouble_size);
+                    break;
+                }
+                case Type::Bool:
+                    put(out, static_cast<uint8_t>(next->get_bool()));
+                    break;
+                case Type::Str: {
+                    std::string_view chars = next->get_str_view();
+                    put(out, static_cast<uint32_t>(chars.size()));
+                    out.append(chars);
+                    break;
+                }
+                case Type::Nullptr:
+                    break;
+                default: {
+                    put(out, static_cast<uint32_t>(next->size()));
+                    Frame frame{next, 0, {}, out.size()};
+                    if (type == Type::Dict) {
+                        frame.it = next->get_dict_obj().cbegin();
+                    }
+                    put(out, uint64_t(0));
+                    frames.push_back(frame);
+                    break;
+                }
+            }
+            next = nullptr;
+        }
+        if (frames.empty()) {
+            std::string bytes(magic, 4);
+            bytes += static_cast<char>(version);
+            bytes += static_cast<char>(little_endian() ? 1 : 0);
+            bytes += static_cast<char>(sizeof(long double));
+            bytes += '\0';
+            put(bytes, static_cast<uint32_t>(keys.size()));
+            for (std::string_view key : keys) {
+                put(bytes, static_cast<uint32_t>(key.size()));
+                bytes.append(key);
+            }
+            bytes.reserve(bytes.size() + out.size());
+            bytes.append(out);
+            return bytes;
+        }
+
+        // Move on to the next child of the innermost container
+        Frame& frame = frames.back();
+        const Doc& container = *frame.doc;
+        if (container.get_type() == Type::Dict) {
+            if (frame.it != container.get_dict_obj().cend()) {
+                auto id = key_ids.emplace(frame.it->first, static_cast<uint32_t>(keys.size()));
+                if (id.second) {
+                    keys.push_back(frame.it->first);
+                }
+                put(out, id.first->second);
+                next = &frame.it->second;
+                ++frame.it;
+            }
+        } else if (frame.index < container.size()) {
+            next = container.get_type() == Type::Array ? &container.get_arr()[frame.index]
+                                                       : &container.get_tuple()[frame.index];
+            ++frame.index;
+        }
+        if (!next) {
+            const uint64_t bytes = out.size() - frame.size_at - sizeof(uint64_t);
+            std::memcpy(&out[frame.size_at], &bytes, sizeof(uint64_t));
+            frames.pop_back();
+        }
+    }
+}
+
+[[nodiscard]] JoSon::Doc JoSon::Utils::binary_to_doc(std::string_view data) {
+    check_header(data);
+    Reader reader{data, header_size};
+    std::vector<std::string_view> keys = read_keys(reader);
+    return decode_value(reader, keys);
+}
+
+[[nodiscard]] [[maybe_unused]] std::vector<JoSon::Doc>
+JoSon::Utils::binary_select(std::string_view data, const Path& path) {
+    check_header(data);
+    Reader table{data, header_size};
+    std::vector<std::string_view> keys = read_keys(table);
+    std::vector<size_t> current{table.offset};
+    std::vector<size_t> next;
+    for (const auto& step : path.get_steps()) {
+        next.clear();
+        for (size_t offset : current) {
+            Reader reader{data, offset};
+            const Type type = reader.get_type();
+            if (type != Type::Dict && type != Type::Array && type != Type::Tuple) {
+                continue;
+            }
+            auto count = reader.get<uint32_t>();
+            (void)reader.get<uint64_t>();
+            for (size_t i = 0; i < count; ++i) {
+                bool match;
+                if (type == Type::Dict) {
+                    match = step.matches(read_key(reader, keys));
+                } else {
+                    match = step.matches(i);
+                }
+                if (match) {
+                    next.push_back(reader.offset);
+                }
+                reader.skip(); // Jump over the value through its byte size
+            }
+        }
+        current.swap(next);
+    }
+    std::vector<Doc> values;
+    values.reserve(current.size());
+    for (size_t offset : current) {
+        Reader reader{data, offset};
+        values.push_back(decode_value(reader, keys));
+    }
+    return values;
+}
+
+[[maybe_unused]] void JoSon::Utils::store_doc_to_binary(const std::string& path,
+                                                        const Doc& doc) {
+    std::ofstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        std::cerr << "Error: Unable to open file '" << path << "' for writing."
+                  << std::endl;
+        return;
+    }
+    std::string bytes = doc_to_binary(doc);
+    file.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+}
+
+[[nodiscard]] [[maybe_unused]] JoSon::Doc
+JoSon::Utils::read_binary_file(const std::string& file_path) {
+    MappedFile file(file_path);
+    if (!file.is_open()) {
+        std::cerr << "Error: Unable to open binary file." << std::endl;
+        return Doc(Type::Nullptr);
+    }
+    return binary_to_doc(file.view());
+}
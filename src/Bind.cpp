@@ -0,0 +1,227 @@
+// Bind.cpp
+#include "../include/JoSon/Bind.h"
+#include "../include/JoSon/Parser.h"
+#include "../include/JoSon/Writer.h"
+#include "Format.h"
+#include "Text.h"
+#include <charconv>
+#include <cstdlib>
+
+namespace {
+    inline bool is_space(char c) { return c == ' ' || c == '\n' || c == '\t' || c == '\r'; }
+
+    inline bool ends_token(char c) {
+        return is_space(c) || c == ',' || c == ':' || c == '}' || c == ']';
+    }
+} // namespace
+
+char JoSon::Bind::Cursor::peek() {
+    while (pos < text.size() && is_space(text[pos])) {
+        ++pos;
+    }
+    return pos < text.size() ? text[pos] : '\0';
+}
+
+bool JoSon::Bind::Cursor::consume(char c) {
+    if (peek() == c && pos < text.size()) {
+        ++pos;
+        return true;
+    }
+    return false;
+}
+
+void JoSon::Bind::Cursor::expect(char c) {
+    if (!consume(c)) {
+        const char expected[] = {'\'', c, '\'', '\0'};
+        fail(expected);
+    }
+}
+
+void JoSon::Bind::Cursor::fail(const char* expected) const {
+    throw std::runtime_error(std::string("Error: Expected ") + expected + " at offset " +
+                             std::to_string(pos) + " of the JSON text.");
+}
+
+bool JoSon::Bind::Cursor::read_null() {
+    if (peek() == 'n' && text.compare(pos, 4, "null") == 0 &&
+        (pos + 4 == text.size() || ends_token(text[pos + 4]))) {
+        pos += 4;
+        return true;
+    }
+    return false;
+}
+
+bool JoSon::Bind::Cursor::read_bool() {
+    peek();
+    auto literal = [this](std::string_view word) {
+        const size_t end = pos + word.size();
+        return text.compare(pos, word.size(), word) == 0 &&
+               (end == text.size() || ends_token(text[end]));
+    };
+    if (literal("true")) {
+        pos += 4;
+        return true;
+    } else if (literal("false")) {
+        pos += 5;
+        return false;
+    }
+    fail("true or false");
+}
+
+long long JoSon::Bind::Cursor::read_integer() {
+    peek();
+    long long value = 0;
+    auto [ptr, ec] = std::from_chars(text.data() + pos, text.data() + text.size(), value);
+    const size_t end = static_cast<size_t>(ptr - text.data());
+    if (ec != std::errc() || (end < text.size() && !ends_token(text[end]))) {
+        fail("an integer");
+    }
+    pos = end;
+    return value;
+}
+
+unsigned long long JoSon::Bind::Cursor::read_unsigned() {
+    peek();
+    unsigned long long value = 0;
+    auto [ptr, ec] = std::from_chars(text.data() + pos, text.data() + text.size(), value);
+    const size_t end = static_cast<size_t>(ptr - text.data());
+    if (ec != std::errc() || (end < text.size() && !ends_token(text[end]))) {
+        fail("a non-negative integer");
+    }
+    pos = end;
+    return value;
+}
+
+double JoSon::Bind::Cursor::read_double() {
+    peek();
+    double value = 0;
+    auto [ptr, ec] = std::from_chars(text.data() + pos, text.data() + text.size(), value);
+    const size_t end = static_cast<size_t>(ptr - text.data());
+    if (ec != std::errc() || (end < text.size() && !ends_token(text[end]))) {
+        fail("a number");
+    }
+    pos = end;
+    return value;
+}
+
+long double JoSon::Bind::Cursor::read_long_double() {
+    peek();
+    size_t end = pos;
+    while (end < text.size() && !ends_token(text[end])) {
+        ++end;
+    }
+    const std::string token(text.substr(pos, end - pos)); // strtold needs a terminator
+    char* stop = nullptr;
+    const long double value = std::strtold(token.c_str(), &stop);
+    if (token.empty() || stop != token.c_str() + token.size()) {
+        fail("a number");
+    }
+    pos = end;
+    return value;
+}
+
+void JoSon::Bind::Cursor::read_string(std::string& out) {
+    std::string_view key = read_key(out);
+    if (key.data() != out.data()) {
+        out.assign(key);
+    }
+}
+
+std::string_view JoSon::Bind::Cursor::read_key(std::string& scratch) {
+    expect('"');
+    size_t end = pos;
+    while (end < text.size() && text[end] != '"') {
+        end += text[end] == '\\' ? 2 : 1;
+    }
+    if (end >= text.size()) {
+        fail("the end of a string");
+    }
+    const std::string_view raw = text.substr(pos, end - pos);
+    pos = end + 1;
+    if (Text::plain_length(raw) == raw.size()) {
+        return raw;
+    }
+    scratch.clear();
+    Text::unescape(raw, scratch);
+    return scratch;
+}
+// A key without escapes is a view of the text.
+
+void JoSon::Bind::Cursor::skip_value() {
+    size_t depth = 0;
+    do {
+        const char c = peek();
+        if (c == '"') {
+            ++pos;
+            while (pos < text.size() && text[pos] != '"') {
+                pos += text[pos] == '\\' ? 2 : 1;
+            }
+            pos = pos < text.size() ? pos + 1 : text.size();
+        } else if (c == '{' || c == '[') {
+            ++depth;
+            ++pos;
+        } else if (c == '}' || c == ']') {
+            if (depth == 0) {
+                return; // A missing value, its container ends here
+            }
+            --depth;
+            ++pos;
+        } else if (c == ',' || c == ':') {
+            if (depth == 0) {
+                return;
+            }
+            ++pos;
+        } else if (c == '\0') {
+            return;
+        } else {
+            while (pos < text.size() && !ends_token(text[pos])) {
+                ++pos;
+            }
+        }
+    } while (depth > 0);
+}
+// Walks nested values with a counter, whatever their depth.
+
+JoSon::Doc JoSon::Bind::Cursor::read_doc() {
+    peek();
+    const size_t begin = pos;
+    skip_value();
+    thread_local Parser parser;
+    return parser.parse(text.substr(begin, pos - begin));
+}
+
+void JoSon::Bind::write_string(std::string& out, std::string_view text) {
+    Text::quote(text, out);
+}
+
+void JoSon::Bind::write_integer(std::string& out, long long value) {
+    char buffer[64];
+    out.append(buffer, Format::number_to_chars(buffer, value));
+}
+
+void JoSon::Bind::write_unsigned(std::string& out, unsigned long long value) {
+    char buffer[64];
+    out.append(buffer, Format::number_to_chars(buffer, value));
+}
+
+void JoSon::Bind::write_float(std::string& out, float value) {
+    char buffer[64];
+    out.append(buffer, Format::number_to_chars(buffer, value));
+}
+
+void JoSon::Bind::write_float(std::string& out, double value) {
+    char buffer[64];
+    out.append(buffer, Format::number_to_chars(buffer, value));
+}
+
+void JoSon::Bind::write_float(std::string& out, long double value) {
+    char buffer[64];
+    out.append(buffer, Format::number_to_chars(buffer, value));
+}
+
+void JoSon::Bind::write_doc(std::string& out, const Doc& doc) {
+    thread_local Writer writer;
+    writer.clear();
+    writer.write(doc);
+    out.append(writer.view());
+}
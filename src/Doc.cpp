@@ -1,8 +1,16 @@
 // Doc.cpp
 #include "../include/JoSon/Doc.h"
+#include "../include/JoSon/KeyPool.h"
+#include "Format.h"
+#include "Text.h"
+#include <algorithm>
+#include <memory>
+#include <new>
 #include <stack>
 #include <vector>
 
+using JoSon::Format::number_to_chars;
+
 JoSon::DocTuple::DocTuple() : tpl(nullptr), s(0) {}
 // Default constructor initializes tpl to nullptr and s to 0.
 
@@ -65,7 +73,7 @@ JoSon::DocTuple::set_values(std::initializer_list<Doc> values) {
 }
 // Converts the tuple to a string representation.
 
-JoSon::DocTuple::DocTuple(const DocTuple& other) noexcept : s(other.s) {
+JoSon::DocTuple::DocTuple(const DocTuple& other) noexcept : Shared(), s(other.s) {
     Doc* new_tup = new Doc[s];
     std::copy(other.tpl, other.tpl + s, new_tup);
     tpl = static_cast<const Doc*>(new_tup);
@@ -86,6 +94,25 @@ JoSon::DocTuple& JoSon::DocTuple::operator=(const DocTuple& other) noexcept {
 }
 // Copy assignment operator
 
+JoSon::DocTuple::DocTuple(DocTuple&& other) noexcept
+        : tpl(other.tpl), s(other.s) {
+    other.tpl = nullptr;
+    other.s = 0;
+}
+// Move constructor takes over the documents of the other tuple.
+
+JoSon::DocTuple& JoSon::DocTuple::operator=(DocTuple&& other) noexcept {
+    if (this != &other) {
+        delete[] tpl;
+        tpl = other.tpl;
+        s = other.s;
+        other.tpl = nullptr;
+        other.s = 0;
+    }
+    return *this;
+}
+// Move assignment operator releases this tuple and takes over the other one.
+
 const JoSon::Doc& JoSon::DocTuple::operator[](size_t index) const {
     if (index >= s) {
         throw std::out_of_range("Error: Index out of bounds.");
@@ -100,13 +127,31 @@ JoSon::DocTuple::~DocTuple() {
 }
 // Destructor deallocates memory used by the tuple.
 
-JoSon::DocArr::DocArr() : arr(new Doc[8]), s(0), cap(8) {}
+JoSon::Doc* JoSon::DocArr::allocate(size_t n) const {
+    if (arena == nullptr) {
+        return new Doc[n];
+    }
+    auto* storage = static_cast<Doc*>(arena->allocate(n * sizeof(Doc), alignof(Doc)));
+    std::uninitialized_default_construct_n(storage, n);
+    return storage;
+}
+// Allocates n documents from the arena if any, otherwise with new[].
+
+void JoSon::DocArr::deallocate() {
+    if (arena == nullptr) {
+        delete[] arr;
+    }
+    arr = nullptr;
+}
+// Deletes heap storage; arena storage is reclaimed by Arena::release().
+
+JoSon::DocArr::DocArr() : arr(new Doc[8]), s(0), cap(8), arena(nullptr) {}
 /* Default constructor initializes arr with a new array of capacity 8, s to
  * 0, and cap to 8.
  */
 
 JoSon::DocArr::DocArr(Doc* array, size_t size)
-        : arr(array), s(size), cap(size) {}
+        : arr(array), s(size), cap(size), arena(nullptr) {}
 /* Constructor initializes arr with the provided array pointer, s with the
  * provided size, and cap with the provided size.
  */
@@ -115,11 +160,20 @@ JoSon::DocArr::DocArr(size_t capacity) {
     arr = new Doc[capacity];
     s = 0;
     cap = capacity;
+    arena = nullptr;
 }
 /* Constructor initializes arr with a new array of the specified capacity, s
  * to 0, and cap to the specified capacity.
  */
 
+JoSon::DocArr::DocArr(size_t capacity, Arena& arena)
+        : arr(nullptr), s(0), cap(capacity), arena(&arena) {
+    arr = allocate(capacity);
+}
+/* Constructor initializes arr with storage of the specified capacity taken
+ * from the arena.
+ */
+
 bool JoSon::DocArr::full() const { return s == cap; }
 // Returns true if the array is full, otherwise false.
 
@@ -140,26 +194,54 @@ void JoSon::DocArr::emplace_back(const Doc& doc) {
     if (!this->full()) {
         arr[s++] = doc;
     } else {
-        cap *= 2;
-        Doc* new_arr = new Doc[cap];
-        std::copy(arr, arr + s, new_arr);
-        new_arr[s++] = doc;
-        delete[] arr;
+        cap = cap > 0 ? cap * 2 : 8;
+        Doc* new_arr = allocate(cap);
+        new_arr[s] = doc; // Before moving, doc may be one of the elements
+        std::move(arr, arr + s, new_arr);
+        ++s;
+        deallocate();
         arr = new_arr;
     }
 }
 // Adds a document to the end of the array, resizing if necessary.
 
+void JoSon::DocArr::emplace_back(Doc&& doc) {
+    if (!this->full()) {
+        arr[s++] = std::move(doc);
+    } else {
+        cap = cap > 0 ? cap * 2 : 8;
+        Doc* new_arr = allocate(cap);
+        new_arr[s] = std::move(doc);
+        std::move(arr, arr + s, new_arr);
+        ++s;
+        deallocate();
+        arr = new_arr;
+    }
+}
+// Moves a document to the end of the array, resizing if necessary.
+
+[[maybe_unused]] void JoSon::DocArr::append(DocArr&& other) {
+    if (&other == this) {
+        return;
+    }
+    if (s + other.s > cap) {
+        resize(std::max(s + other.s, cap * 2));
+    }
+    std::move(other.arr, other.arr + other.s, arr + s);
+    s += other.s;
+    other.s = 0;
+}
+// Moves the documents of another array to the end of the array in one resize.
+
 bool JoSon::DocArr::pop_back() {
     if (this->s == 0) {
         return false;
     } else {
-        arr[s] = Doc(JoSon::Type::Nullptr);
-        s--;
+        arr[--s] = Doc(JoSon::Type::Nullptr);
         return true;
     }
 }
-// Removes the last document from the array.
+// Removes the last document from the array, releasing its value.
 
 [[maybe_unused]] bool JoSon::DocArr::set_value(size_t pos, const Doc& doc) {
     if (pos >= s) {
@@ -173,15 +255,50 @@ bool JoSon::DocArr::pop_back() {
 }
 // Sets the value of a document at the specified position.
 
+[[maybe_unused]] bool JoSon::DocArr::insert(size_t pos, Doc&& doc) {
+    if (pos > s) {
+        return false;
+    }
+    Doc moved(std::move(doc)); // Before shifting, doc may be one of the elements
+    if (!this->full()) {
+        std::move_backward(arr + pos, arr + s, arr + s + 1);
+        arr[pos] = std::move(moved);
+    } else {
+        cap = cap > 0 ? cap * 2 : 8;
+        Doc* new_arr = allocate(cap);
+        std::move(arr, arr + pos, new_arr);
+        new_arr[pos] = std::move(moved);
+        std::move(arr + pos, arr + s, new_arr + pos + 1);
+        deallocate();
+        arr = new_arr;
+    }
+    ++s;
+    return true;
+}
+// Moves a document into the array at the specified position, resizing if necessary.
+
+[[maybe_unused]] bool JoSon::DocArr::erase(size_t pos) {
+    if (pos >= s) {
+        return false;
+    }
+    std::move(arr + pos + 1, arr + s, arr + pos);
+    arr[--s] = Doc(JoSon::Type::Nullptr);
+    return true;
+}
+// Removes the document at the specified position, releasing its value.
+
 [[maybe_unused]] void
 JoSon::DocArr::set_values(std::initializer_list<Doc> values) {
     size_t length = values.size();
 
     if (length > cap) {
         cap = std::max(length, 2 * cap);
-        Doc* new_arr = new Doc[cap];
+        Doc* new_arr = allocate(cap);
         std::copy(values.begin(), values.end(), new_arr);
-        delete[] arr;
+        if (s > length) {
+            std::move(arr + length, arr + s, new_arr + length);
+        }
+        deallocate();
         arr = new_arr;
     } else {
         std::copy(values.begin(), values.end(), arr);
@@ -195,9 +312,9 @@ JoSon::DocArr::set_values(std::initializer_list<Doc> values) {
     if (new_cap < s) {
         s = new_cap;
     }
-    Doc* new_arr = new Doc[new_cap];
-    std::copy(arr, arr + s, new_arr);
-    delete[] arr;
+    Doc* new_arr = allocate(new_cap);
+    std::move(arr, arr + s, new_arr);
+    deallocate();
     arr = new_arr;
     cap = new_cap;
 }
@@ -217,7 +334,7 @@ JoSon::DocArr::set_values(std::initializer_list<Doc> values) {
 // Converts the array to a string representation.
 
 JoSon::DocArr::DocArr(const DocArr& other) noexcept
-        : s(other.s), cap(other.cap) {
+        : Shared(), s(other.s), cap(other.cap), arena(nullptr) {
     arr = new Doc[cap];
     std::copy(other.arr, other.arr + s, arr);
 }
@@ -226,18 +343,39 @@ JoSon::DocArr::DocArr(const DocArr& other) noexcept
 JoSon::DocArr& JoSon::DocArr::operator=(const DocArr& other) noexcept {
     if (this != &other) {
         // Deallocate existing memory
-        delete[] arr;
+        deallocate();
         // Copy s and capacity
         s = other.s;
         cap = other.cap;
         // Allocate new memory and copy elements
-        arr = new Doc[cap];
+        arr = allocate(cap);
         std::copy(other.arr, other.arr + s, arr);
     }
     return *this;
 }
 // Copy assignment operator copies the contents of another array.
 
+JoSon::DocArr::DocArr(DocArr&& other) noexcept
+        : arr(other.arr), s(other.s), cap(other.cap), arena(other.arena) {
+    other.arr = nullptr;
+    other.s = other.cap = 0;
+}
+// Move constructor takes over the storage of the other array.
+
+JoSon::DocArr& JoSon::DocArr::operator=(DocArr&& other) noexcept {
+    if (this != &other) {
+        deallocate();
+        arr = other.arr;
+        s = other.s;
+        cap = other.cap;
+        arena = other.arena;
+        other.arr = nullptr;
+        other.s = other.cap = 0;
+    }
+    return *this;
+}
+// Move assignment operator releases this array and takes over the other one.
+
 const JoSon::Doc& JoSon::DocArr::operator[](size_t index) const {
     if (index >= s) {
         throw std::out_of_range("Error: Index out of bounds.");
@@ -246,64 +384,480 @@ const JoSon::Doc& JoSon::DocArr::operator[](size_t index) const {
 }
 // Access operator to access documents in the array by index.
 
-JoSon::DocArr::~DocArr() {
-    delete[] arr;
-    arr = nullptr;
+[[maybe_unused]] JoSon::Doc& JoSon::DocArr::at(size_t index) {
+    if (index >= s) {
+        throw std::out_of_range("Error: Index out of bounds.");
+    }
+    return arr[index];
 }
+// Access to modify documents in the array by index.
+
+JoSon::DocArr::~DocArr() { deallocate(); }
 // Destructor deallocates memory used by the array.
 
-void JoSon::Doc::delete_var() {
-    switch (t) {
-        case JoSon::Type::Array:
-            if (auto* arrPtr = std::get_if<DocArr*>(&var)) {
-                var = nullptr;
-                delete[] * arrPtr;
-                *arrPtr = nullptr;
+/**
+ * @brief Get the reference count of a string copied to the heap.
+ *
+ * The count is stored right before the characters.
+ *
+ * @param chars The characters of the string.
+ * @return The count.
+ */
+static JoSon::Shared* string_block(const char* chars) {
+    return reinterpret_cast<JoSon::Shared*>(const_cast<char*>(chars) - sizeof(JoSon::Shared));
+}
+
+JoSon::DictObj::DictObj(std::pmr::memory_resource* resource)
+        : entries(resource), index(resource), held(resource), chars(resource) {}
+// Constructor allocates the members, the index and the keys from the resource.
+
+JoSon::DictObj::DictObj(const DictObj& other)
+        : Shared(), entries(other.entries), index(other.index), held(other.held), pool(other.pool) {
+    for (size_t i = 0; i < entries.size(); ++i) {
+        if (!held[i]) {
+            continue;
+        } else if (other.chars == nullptr) {
+            string_block(entries[i].first.data())->refs.fetch_add(1, std::memory_order_relaxed);
+        } else {
+            entries[i].first = hold_key(entries[i].first);
+        }
+    }
+}
+// Heap blocks of keys are shared, keys in a resource copied to the heap.
+
+JoSon::DictObj::DictObj(DictObj&& other) noexcept
+        : Shared(), entries(std::move(other.entries)), index(std::move(other.index)),
+          held(std::move(other.held)), chars(other.chars), pool(other.pool) {
+    other.clear();
+}
+
+JoSon::DictObj& JoSon::DictObj::operator=(const DictObj& other) {
+    if (this != &other) {
+        clear();
+        entries.reserve(other.size());
+        for (const auto& [key, value] : other) {
+            (*this)[key] = value;
+        }
+    }
+    return *this;
+}
+// The keys are copied into the storage of this dictionary object.
+
+JoSon::DictObj& JoSon::DictObj::operator=(DictObj&& other) {
+    if (this == &other) {
+        return *this;
+    } else if (chars != other.chars || entries.get_allocator() != other.entries.get_allocator()) {
+        *this = static_cast<const DictObj&>(other);
+        other.clear();
+        return *this;
+    }
+    clear();
+    entries = std::move(other.entries);
+    index = std::move(other.index);
+    held = std::move(other.held);
+    pool = other.pool;
+    other.clear();
+    return *this;
+}
+// Members and keys are taken over when they live with the same allocators.
+
+JoSon::DictObj::~DictObj() { clear(); }
+
+std::string_view JoSon::DictObj::hold_key(std::string_view key) const {
+    char* copy;
+    if (chars != nullptr) {
+        copy = static_cast<char*>(chars->allocate(key.size() + 1, 1));
+    } else {
+        // One block holds the reference count and the characters, as for strings
+        void* block = ::operator new(sizeof(Shared) + key.size() + 1);
+        ::new (block) Shared();
+        static_cast<Shared*>(block)->refs.store(1, std::memory_order_relaxed);
+        copy = static_cast<char*>(block) + sizeof(Shared);
+    }
+    std::memcpy(copy, key.data(), key.size());
+    copy[key.size()] = '\0';
+    return {copy, key.size()};
+}
+
+void JoSon::DictObj::release_key(std::string_view key) const {
+    if (chars != nullptr) {
+        chars->deallocate(const_cast<char*>(key.data()), key.size() + 1, 1);
+        return;
+    }
+    Shared* shared = string_block(key.data());
+    if (shared->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        shared->~Shared();
+        ::operator delete(shared);
+    }
+}
+// The last dictionary object holding a heap block deletes it.
+
+bool JoSon::DictObj::own_key(const DictObj& other, size_t i) {
+    std::string_view& key = entries[i].first;
+    if (other.held[i] && other.chars == nullptr) {
+        string_block(key.data())->refs.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    } else if (pool != nullptr) {
+        key = pool->intern(key);
+        return false;
+    }
+    key = hold_key(key);
+    return true;
+}
+
+JoSon::DictObj* JoSon::DictObj::clone_keys() const {
+    std::unique_ptr<DictObj> copy(new DictObj());
+    copy->pool = pool;
+    copy->entries.reserve(entries.size());
+    copy->held.reserve(entries.size());
+    for (size_t i = 0; i < entries.size(); ++i) {
+        copy->entries.emplace_back(entries[i].first, Doc());
+        copy->held.push_back(false); // Until the key is owned, in case that throws
+        copy->held.back() = copy->own_key(*this, i);
+    }
+    copy->index.assign(index.begin(), index.end()); // Same keys at the same positions
+    return copy.release();
+}
+
+/**
+ * @brief Compares two keys, trying the addresses first.
+ *
+ * Keys interned in the same KeyPool share their characters, so equal
+ * pointers settle the comparison without reading them.
+ */
+static bool same_key(std::string_view lhs, std::string_view rhs) {
+    if (lhs.size() != rhs.size()) {
+        return false;
+    }
+    return lhs.data() == rhs.data() || lhs == rhs;
+}
+
+size_t JoSon::DictObj::slot_of(std::string_view key) const {
+    const size_t mask = index.size() - 1;
+    size_t slot = std::hash<std::string_view>()(key) & mask;
+    // Linear probing, the index is never more than half full
+    while (index[slot] != 0 && !same_key(entries[index[slot] - 1].first, key)) {
+        slot = (slot + 1) & mask;
+    }
+    return slot;
+}
+
+void JoSon::DictObj::rehash(size_t slots) {
+    index.assign(slots, 0);
+    for (size_t i = 0; i < entries.size(); ++i) {
+        index[slot_of(entries[i].first)] = static_cast<uint32_t>(i + 1);
+    }
+}
+// Rebuilds the index from the members.
+
+size_t JoSon::DictObj::position(std::string_view key) const {
+    if (index.empty()) {
+        for (size_t i = 0; i < entries.size(); ++i) {
+            if (same_key(entries[i].first, key)) {
+                return i;
             }
-            break;
-        case JoSon::Type::Tuple:
-            if (auto* tupPtr = std::get_if<DocTuple*>(&var)) {
-                var = nullptr;
-                delete *tupPtr;
-                *tupPtr = nullptr;
+        }
+        return entries.size();
+    }
+    uint32_t found = index[slot_of(key)];
+    return found != 0 ? found - 1 : entries.size();
+}
+// Small dictionaries are scanned, large ones looked up in the index.
+
+JoSon::DictObj::iterator JoSon::DictObj::find(std::string_view key) {
+    return entries.begin() + static_cast<std::ptrdiff_t>(position(key));
+}
+
+JoSon::DictObj::const_iterator
+JoSon::DictObj::find(std::string_view key) const {
+    return entries.begin() + static_cast<std::ptrdiff_t>(position(key));
+}
+
+size_t JoSon::DictObj::count(std::string_view key) const {
+    return position(key) != entries.size() ? 1 : 0;
+}
+
+JoSon::Doc& JoSon::DictObj::append(std::string_view key, bool holds) {
+    try {
+        entries.emplace_back(key, Doc());
+        held.push_back(holds);
+    } catch (...) {
+        if (entries.size() > held.size()) {
+            entries.pop_back();
+        }
+        if (holds) {
+            release_key(key);
+        }
+        throw;
+    }
+    if (!index.empty() && entries.size() * 2 <= index.size()) {
+        index[slot_of(key)] = static_cast<uint32_t>(entries.size());
+    } else if (entries.size() > flat_limit) {
+        rehash(index.empty() ? 4 * flat_limit : 2 * index.size());
+    }
+    return entries.back().second;
+}
+
+JoSon::Doc& JoSon::DictObj::operator[](std::string_view key) {
+    size_t pos = position(key);
+    if (pos != entries.size()) {
+        return entries[pos].second;
+    } else if (pool != nullptr) {
+        return append(pool->intern(key), false);
+    }
+    return append(hold_key(key), true);
+}
+// Appends a null member with a copy of the key if the key is new.
+
+JoSon::Doc& JoSon::DictObj::emplace_view(std::string_view key) {
+    size_t pos = position(key);
+    if (pos != entries.size()) {
+        return entries[pos].second;
+    }
+    return append(key, false);
+}
+// Appends a null member viewing the key if the key is new.
+
+const JoSon::Doc& JoSon::DictObj::at(std::string_view key) const {
+    size_t pos = position(key);
+    if (pos == entries.size()) {
+        throw std::out_of_range("Error: Key not found.");
+    }
+    return entries[pos].second;
+}
+
+JoSon::DictObj::iterator JoSon::DictObj::erase(const_iterator pos) {
+    const auto i = pos - entries.cbegin();
+    const std::string_view key = pos->first;
+    const bool holds = held[static_cast<size_t>(i)];
+    const bool indexed = entries.size() - 1 > flat_limit;
+    if (indexed) {
+        // Backward-shift deletion: later members of the probe run move into the hole
+        const size_t mask = index.size() - 1;
+        size_t hole = slot_of(key);
+        for (size_t slot = (hole + 1) & mask; index[slot] != 0; slot = (slot + 1) & mask) {
+            const size_t home = std::hash<std::string_view>()(entries[index[slot] - 1].first) & mask;
+            if (((slot - home) & mask) >= ((slot - hole) & mask)) {
+                index[hole] = index[slot];
+                hole = slot;
             }
-            break;
+        }
+        index[hole] = 0;
+    }
+    auto next = entries.erase(pos);
+    held.erase(held.begin() + i);
+    if (holds) {
+        release_key(key);
+    }
+    if (!indexed) {
+        index.clear();
+    } else {
+        const auto erased = static_cast<uint32_t>(i + 1);
+        for (uint32_t& slot : index) {
+            slot -= slot > erased ? 1 : 0; // The following members moved down by one
+        }
+    }
+    return next;
+}
+// Closes the gap so that the other members keep their order.
+
+size_t JoSon::DictObj::erase(std::string_view key) {
+    auto it = find(key);
+    if (it == entries.end()) {
+        return 0;
+    }
+    erase(it);
+    return 1;
+}
+
+void JoSon::DictObj::clear() {
+    for (size_t i = 0; i < entries.size(); ++i) {
+        if (held[i]) {
+            release_key(entries[i].first);
+        }
+    }
+    entries.clear();
+    index.clear();
+    held.clear();
+}
+
+void JoSon::DictObj::reserve(size_t n) {
+    entries.reserve(n);
+    held.reserve(n);
+}
+
+static_assert(sizeof(JoSon::Doc) <= 16, "A Doc should fit in 16 bytes");
+
+/**
+ * @brief Get the reference count of a value held on the heap.
+ *
+ * @param type The type of the value.
+ * @param val The value.
+ * @return The count, or nullptr if the value is not shared.
+ */
+static JoSon::Shared* shared_of(JoSon::Type type, const JoSon::Value& val) {
+    switch (type) {
+        case JoSon::Type::Str:
+            return string_block(val.str);
+        case JoSon::Type::Tuple:
+            return val.tuple;
+        case JoSon::Type::Array:
+            return val.arr;
         case JoSon::Type::Dict:
-            if (auto* mapPtr = std::get_if<DictObj*>(&var)) {
-                var = nullptr;
-                delete *mapPtr;
-                *mapPtr = nullptr;
-            }
+            return val.dict;
+        default:
+            return nullptr;
+    }
+}
+
+void JoSon::Doc::retain() {
+    if (!(flags & Owned)) {
+        return;
+    }
+    if (t == JoSon::Type::LDouble) {
+        val.ld = new long double(*val.ld); // Too small to be worth sharing
+    } else if (Shared* shared = shared_of(t, val)) {
+        shared->refs.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+// Adds a holder to the value, if this Doc owns one.
+
+/**
+ * @brief Containers released while another one is being deleted on this
+ * thread, with their types.
+ *
+ * Deleting a container destroys its documents, which would delete the
+ * containers they hold in turn, one stack frame per level of nesting. The
+ * outermost delete_var() of a thread deletes the containers of this list one
+ * after the other instead, whatever the depth of the tree. The list keeps its
+ * storage between deletions, so that tearing down a tree does not allocate.
+ */
+static thread_local std::vector<std::pair<JoSon::Type, JoSon::Shared*>> released;
+static thread_local bool releasing = false; ///< Whether released is being emptied.
+
+/**
+ * @brief Deletes a container whose last holder was deleted.
+ *
+ * @param type The type of the container.
+ * @param shared The container.
+ */
+static void delete_container(JoSon::Type type, JoSon::Shared* shared) {
+    switch (type) {
+        case JoSon::Type::Tuple:
+            delete static_cast<JoSon::DocTuple*>(shared);
             break;
-        case JoSon::Type::Str:
-            if (auto* strPtr = std::get_if<const char*>(&var)) {
-                var = nullptr;
-                delete *strPtr;
-                *strPtr = nullptr;
-            }
+        case JoSon::Type::Array:
+            delete static_cast<JoSon::DocArr*>(shared);
+            break;
+        case JoSon::Type::Dict:
+            delete static_cast<JoSon::DictObj*>(shared);
             break;
         default:
             break;
     }
 }
+
+void JoSon::Doc::delete_var() {
+    Value old = val;
+    bool owned = flags & Owned;
+    // Detach first: deleting the container may reach this Doc again
+    val = Value{};
+    len = 0;
+    flags = 0;
+    if (!owned) {
+        // Primitive, in an arena, or held by the caller
+        return;
+    }
+    if (t == JoSon::Type::LDouble) {
+        delete old.ld;
+        return;
+    }
+    Shared* shared = shared_of(t, old);
+    if (shared == nullptr ||
+        shared->refs.fetch_sub(1, std::memory_order_acq_rel) != 1) {
+        return; // Still held by other documents
+    }
+    if (t == JoSon::Type::Str) {
+        shared->~Shared();
+        ::operator delete(shared);
+        return;
+    }
+    if (releasing) {
+        try {
+            released.emplace_back(t, shared);
+            return; // Deleted by the outermost call
+        } catch (const std::bad_alloc&) {
+            delete_container(t, shared); // One more level of recursion
+            return;
+        }
+    }
+    releasing = true;
+    delete_container(t, shared);
+    while (!released.empty()) {
+        auto [type, container] = released.back();
+        released.pop_back();
+        delete_container(type, container);
+    }
+    releasing = false;
+}
 /* Function to delete dynamically allocated memory based on the type of the
- * variable.
+ * variable. Nested containers are deleted iteratively, see released.
  */
 
+void JoSon::Doc::copy_str(std::string_view str) {
+    if (str.size() >= UINT32_MAX) {
+        throw std::length_error("Error: String too long.");
+    }
+    len = static_cast<uint32_t>(str.size());
+    if (str.size() < sizeof(val.small)) {
+        std::memcpy(val.small, str.data(), str.size());
+        val.small[str.size()] = '\0';
+        flags = Inline;
+        return;
+    }
+    // One block holds the reference count and the characters
+    void* block = ::operator new(sizeof(Shared) + str.size() + 1);
+    char* chars = static_cast<char*>(block) + sizeof(Shared);
+    ::new (block) Shared();
+    std::memcpy(chars, str.data(), str.size());
+    chars[str.size()] = '\0';
+    val.str = chars;
+    flags = Owned;
+    retain();
+}
+// Short strings are stored in place, longer ones in a shared heap block.
+
+void JoSon::Doc::refer_str(std::string_view str, bool borrowed) {
+    if (str.size() >= UINT32_MAX) {
+        throw std::length_error("Error: String too long.");
+    }
+    val.str = str.data();
+    len = static_cast<uint32_t>(str.size());
+    flags = borrowed ? Borrowed : 0;
+}
+// Points at characters owned by the caller or an arena.
+
+void JoSon::Doc::expect(Type type) const {
+    if (t != type) {
+        throw std::runtime_error(std::string("Error: Doc of type ") +
+                                 get_type_str() + " read as another type.");
+    }
+}
+
 inline std::string JoSon::Doc::prim_to_str(bool visualize) const {
     std::string result;
     switch (t) {
         case JoSon::Type::Char:
             if (visualize) {
                 result.append("'");
-                result.push_back(std::get<char>(var));
+                result.push_back(val.c);
                 result.append("'");
             } else {
-                result += std::to_string(static_cast<int>(std::get<char>(var)));
+                result += std::to_string(static_cast<int>(val.c));
             }
             break;
         case JoSon::Type::Int: {
-            int value = std::get<int>(var);
+            int value = val.i;
             if (visualize) {
                 if (value < 0) {
                     result.push_back('-');
@@ -316,11 +870,12 @@ inline std::string JoSon::Doc::prim_to_str(bool visualize) const {
                 }
                 result += valueStr;
             } else {
-                result += std::to_string(value);
+                char buffer[64];
+                result.append(buffer, number_to_chars(buffer, value));
             }
         } break;
         case JoSon::Type::LLong: {
-            long long value = std::get<long long>(var);
+            long long value = val.ll;
             if (visualize) {
                 if (value < 0) {
                     result.push_back('-');
@@ -333,46 +888,52 @@ inline std::string JoSon::Doc::prim_to_str(bool visualize) const {
                 }
                 result += valueStr;
             } else {
-                result += std::to_string(value);
+                char buffer[64];
+                result.append(buffer, number_to_chars(buffer, value));
             }
         } break;
         case JoSon::Type::Float:
             if (visualize) {
                 char buffer[32];
-                std::sprintf(buffer, "%.4e", std::get<float>(var));
+                std::sprintf(buffer, "%.4e", val.f);
                 result += buffer;
             } else {
-                result += std::to_string(std::get<float>(var));
+                char buffer[64];
+                result.append(buffer, number_to_chars(buffer, val.f));
             }
             break;
         case JoSon::Type::Double:
             if (visualize) {
                 char buffer[64];
-                std::sprintf(buffer, "%.8e", std::get<double>(var));
+                std::sprintf(buffer, "%.8e", val.d);
                 result.append(buffer);
             } else {
-                result.append(std::to_string(std::get<double>(var)));
+                char buffer[64];
+                result.append(buffer, number_to_chars(buffer, val.d));
             }
             break;
         case JoSon::Type::LDouble:
             if (visualize) {
                 char buffer[128];
-                std::sprintf(buffer, "%.12Le", std::get<long double>(var));
+                std::sprintf(buffer, "%.12Le", *val.ld);
                 result.append(buffer);
             } else {
-                result.append(std::to_string(std::get<long double>(var)));
+                char buffer[64];
+                result.append(buffer, number_to_chars(buffer, *val.ld));
             }
             break;
         case JoSon::Type::Bool:
-            result.append(visualize ? (std::get<bool>(var) ? "True" : "False")
-                                    : (std::get<bool>(var) ? "true" : "false"));
+            result.append(visualize ? (val.b ? "True" : "False")
+                                    : (val.b ? "true" : "false"));
             break;
         case JoSon::Type::Nullptr:
             result.append(visualize ? "NullPtr" : "null");
             break;
         case JoSon::Type::Str: {
-            const char* strValue = *(std::get_if<const char*>(&var));
-            if (strValue) {
+            std::string_view strValue = get_str_view();
+            if (strValue.data() && !visualize) {
+                Text::quote(strValue, result);
+            } else if (strValue.data()) {
                 result.push_back('\"');
                 std::string str(strValue);
                 size_t pos = 0;
@@ -400,31 +961,49 @@ inline std::string JoSon::Doc::prim_to_str(bool visualize) const {
 template <typename T> JoSon::Doc::Doc(T value) {
     if constexpr (std::is_same_v<T, char>) {
         t = JoSon::Type::Char;
+        val.c = value;
     } else if constexpr (std::is_same_v<T, int>) {
         t = JoSon::Type::Int;
+        val.i = value;
     } else if constexpr (std::is_same_v<T, long long>) {
         t = JoSon::Type::LLong;
+        val.ll = value;
     } else if constexpr (std::is_same_v<T, float>) {
         t = JoSon::Type::Float;
+        val.f = value;
     } else if constexpr (std::is_same_v<T, double>) {
         t = JoSon::Type::Double;
+        val.d = value;
     } else if constexpr (std::is_same_v<T, long double>) {
         t = JoSon::Type::LDouble;
+        val.ld = new long double(value);
+        flags = Owned;
     } else if constexpr (std::is_same_v<T, bool>) {
         t = JoSon::Type::Bool;
+        val.b = value;
     } else if constexpr (std::is_same_v<T, const char*>) {
         t = JoSon::Type::Str;
+        // Measure the C-string once and keep its length
+        refer_str(value ? std::string_view(value) : std::string_view(), false);
     } else if constexpr (std::is_same_v<T, DocTuple*>) {
         t = JoSon::Type::Tuple;
+        val.tuple = value;
     } else if constexpr (std::is_same_v<T, DocArr*>) {
         t = JoSon::Type::Array;
+        val.arr = value;
     } else if constexpr (std::is_same_v<T, DictObj*>) {
         t = JoSon::Type::Dict;
+        val.dict = value;
     } else {
         t = JoSon::Type::Nullptr;
         throw std::runtime_error("Error: Incorrect type");
     }
-    var = value;
+    if constexpr (std::is_pointer_v<T> && !std::is_same_v<T, const char*>) {
+        if (value != nullptr) {
+            flags = Owned;
+            retain(); // Containers are adopted
+        }
+    }
 }
 /* Constructor template that initializes the type and value of the document
  * based on the provided value.
@@ -446,172 +1025,312 @@ template JoSon::Doc::Doc(DictObj*);
 
 JoSon::Doc::Doc(Type type) : t(type) {
     switch (type) {
-        case JoSon::Type::Char:
-            var = static_cast<char>(0);
-            break;
-        case JoSon::Type::Int:
-            var = static_cast<int>(0);
-            break;
-        case JoSon::Type::LLong:
-            var = static_cast<long long>(0);
-            break;
-        case JoSon::Type::Float:
-            var = static_cast<float>(0);
-            break;
-        case JoSon::Type::Double:
-            var = static_cast<double>(0);
-            break;
         case JoSon::Type::LDouble:
-            var = static_cast<long double>(0);
-            break;
-        case JoSon::Type::Bool:
-            var = false;
-            break;
+            val.ld = new long double(0);
+            flags = Owned;
+            return; // Boxes are not counted, see retain()
         case JoSon::Type::Str:
-            var = "";
-            break;
-        case JoSon::Type::Nullptr:
-            var = nullptr;
+            refer_str("", false);
             break;
         case JoSon::Type::Tuple:
-            var = new DocTuple();
+            val.tuple = new DocTuple();
+            flags = Owned;
             break;
         case JoSon::Type::Array:
-            var = new DocArr();
+            val.arr = new DocArr();
+            flags = Owned;
             break;
         case JoSon::Type::Dict:
-            var = new DictObj;
+            val.dict = new DictObj;
+            flags = Owned;
+            break;
+        default:
+            // Primitive types start from zero, false or null
             break;
     }
+    retain();
 }
 /* Constructor that initializes the type and value of the document based on the
  * provided type.
  */
 
-JoSon::Doc::Doc() : t(JoSon::Type::Nullptr), var(nullptr) {}
+JoSon::Doc::Doc(Type type, Arena& arena) : t(type) {
+    switch (type) {
+        case JoSon::Type::Array:
+            val.arr = arena.create<DocArr>(8, arena);
+            break;
+        case JoSon::Type::Dict:
+            val.dict = arena.create<DictObj>(&arena);
+            break;
+        default:
+            *this = Doc(type);
+            break;
+    }
+}
+/* Constructor that creates arraylists and dictionary objects in the arena,
+ * falling back to Doc(Type) for the other types.
+ */
+
+JoSon::Doc::Doc(std::string_view str, Arena& arena) : t(JoSon::Type::Str) {
+    refer_str(arena.copy_str(str), false);
+}
+/* Constructor that copies the characters into the arena as a C-string.
+ */
+
+JoSon::Doc::Doc(std::string_view str) : t(JoSon::Type::Str) {
+    refer_str(str, true);
+}
+/* Constructor that refers to the characters without copying them.
+ */
+
+JoSon::Doc::Doc(const char* str, size_t length) : t(JoSon::Type::Str) {
+    copy_str({str, length});
+}
+/* Constructor that copies the characters, in place if they are few.
+ */
+
+JoSon::Doc::Doc(const std::string& str) : Doc(str.data(), str.size()) {}
+
+JoSon::Doc::Doc() : t(JoSon::Type::Nullptr) {}
 /* Default constructor initializes the document with type Nullptr and nullptr as
  * the value.
  */
 
+JoSon::Doc::Doc(const Doc& other)
+        : val(other.val), len(other.len), t(other.t), flags(other.flags) {
+    retain();
+}
+/* Copy constructor shares the container of the other document.
+ */
+
+JoSon::Doc::Doc(Doc&& other) noexcept
+        : val(other.val), len(other.len), t(other.t), flags(other.flags) {
+    other.val = Value{};
+    other.len = 0;
+    other.t = JoSon::Type::Nullptr;
+    other.flags = 0;
+}
+/* Move constructor takes over the value of the other document, leaving it
+ * null.
+ */
+
 JoSon::Doc::~Doc() { delete_var(); }
 /* Destructor calls the delete_var function to deallocate dynamically allocated
  * memory.
  */
 
+JoSon::Doc JoSon::Doc::clone() const {
+    Doc root;
+    // Values still to copy, with the Doc receiving each of them
+    std::vector<std::pair<const Doc*, Doc*>> pending{{this, &root}};
+    while (!pending.empty()) {
+        auto [source, target] = pending.back();
+        pending.pop_back();
+        switch (source->t) {
+            case JoSon::Type::Str:
+                if (source->flags & (Owned | Inline)) {
+                    *target = *source; // Strings are never modified, sharing them is safe
+                } else {
+                    std::string_view chars = source->get_str_view();
+                    *target = Doc(chars.data(), chars.size());
+                }
+                break;
+            case JoSon::Type::LDouble:
+                *target = Doc(source->get_long_double());
+                break;
+            case JoSon::Type::Tuple: {
+                const DocTuple& tuple = *source->val.tuple;
+                Doc* slots = tuple.size() > 0 ? new Doc[tuple.size()] : nullptr;
+                *target = Doc(new DocTuple(slots, tuple.size()));
+                for (size_t i = 0; i < tuple.size(); ++i) {
+                    pending.emplace_back(&tuple[i], &slots[i]);
+                }
+                break;
+            }
+            case JoSon::Type::Array: {
+                const DocArr& arr = *source->val.arr;
+                if (arr.size() == 0) {
+                    *target = Doc(new DocArr());
+                    break;
+                }
+                Doc* slots = new Doc[arr.size()];
+                *target = Doc(new DocArr(slots, arr.size()));
+                for (size_t i = 0; i < arr.size(); ++i) {
+                    pending.emplace_back(&arr[i], &slots[i]);
+                }
+                break;
+            }
+            case JoSon::Type::Dict: {
+                const DictObj& dict = *source->val.dict;
+                auto* copy = dict.clone_keys();
+                *target = Doc(copy);
+                auto slot = copy->begin();
+                for (const auto& member : dict) {
+                    pending.emplace_back(&member.second, &(slot++)->second);
+                }
+                break;
+            }
+            default:
+                *target = *source;
+                break;
+        }
+    }
+    return root;
+}
+/* Copies the tree with an explicit stack. The containers are created with
+ * their final size, so the addresses of the pending documents stay valid.
+ */
+
 [[maybe_unused]] char JoSon::Doc::get_char() const {
-    return std::get<char>(var);
+    expect(JoSon::Type::Char);
+    return val.c;
 }
 
 [[maybe_unused]] int JoSon::Doc::get_int() const {
-    return std::get<int>(var);
+    expect(JoSon::Type::Int);
+    return val.i;
 }
 
 [[maybe_unused]] long long JoSon::Doc::get_l_long() const {
-    return std::get<long long>(var);
+    expect(JoSon::Type::LLong);
+    return val.ll;
 }
 
 [[maybe_unused]] float JoSon::Doc::get_float() const {
-    return std::get<float>(var);
+    expect(JoSon::Type::Float);
+    return val.f;
 }
 
 [[maybe_unused]] double JoSon::Doc::get_double() const {
-    return std::get<double>(var);
+    expect(JoSon::Type::Double);
+    return val.d;
 }
 
 [[maybe_unused]] long double JoSon::Doc::get_long_double() const {
-    return std::get<long double>(var);
+    expect(JoSon::Type::LDouble);
+    return *val.ld;
 }
 
 [[maybe_unused]] bool JoSon::Doc::get_bool() const {
-    return std::get<bool>(var);
+    expect(JoSon::Type::Bool);
+    return val.b;
 }
 
 [[maybe_unused]] const char* JoSon::Doc::get_str() const {
-    return std::get<const char*>(var);
+    expect(JoSon::Type::Str);
+    if (flags & Borrowed) {
+        throw std::runtime_error("Error: String view has no null terminator, "
+                                 "use get_str_view().");
+    }
+    return (flags & Inline) ? val.small : val.str;
+}
+
+[[maybe_unused]] std::string_view JoSon::Doc::get_str_view() const {
+    expect(JoSon::Type::Str);
+    return {(flags & Inline) ? val.small : val.str, len};
 }
 
 [[maybe_unused]] JoSon::DocTuple& JoSon::Doc::get_tuple() const {
-    return *(std::get<DocTuple*>(var));
+    expect(JoSon::Type::Tuple);
+    return *val.tuple;
 }
 
 [[maybe_unused]] JoSon::DocArr& JoSon::Doc::get_arr() const {
-    return *(std::get<DocArr*>(var));
+    expect(JoSon::Type::Array);
+    return *val.arr;
 }
 
 [[maybe_unused]] JoSon::DictObj& JoSon::Doc::get_dict_obj() const {
-    return *(std::get<DictObj*>(var));
+    expect(JoSon::Type::Dict);
+    return *val.dict;
 }
 
 [[maybe_unused]] void JoSon::Doc::set_char(char value) {
     delete_var();
     t = JoSon::Type::Char;
-    var = value;
+    val.c = value;
 }
 
 [[maybe_unused]] void JoSon::Doc::set_int(int value) {
     delete_var();
     t = JoSon::Type::Int;
-    var = value;
+    val.i = value;
 }
 
 [[maybe_unused]] void JoSon::Doc::set_l_long(long long value) {
     delete_var();
     t = JoSon::Type::LLong;
-    var = value;
+    val.ll = value;
 }
 
 [[maybe_unused]] void JoSon::Doc::set_float(float value) {
     delete_var();
     t = JoSon::Type::Float;
-    var = value;
+    val.f = value;
 }
 
 [[maybe_unused]] void JoSon::Doc::set_double(double value) {
     delete_var();
     t = JoSon::Type::Double;
-    var = value;
+    val.d = value;
 }
 
 [[maybe_unused]] void JoSon::Doc::set_long_double(long double value) {
+    if (t == JoSon::Type::LDouble && (flags & Owned)) {
+        *val.ld = value; // Reuse the box
+        return;
+    }
     delete_var();
     t = JoSon::Type::LDouble;
-    var = value;
+    val.ld = new long double(value);
+    flags = Owned;
 }
 
 [[maybe_unused]] void JoSon::Doc::set_bool(bool value) {
     delete_var();
     t = JoSon::Type::Bool;
-    var = value;
+    val.b = value;
 }
 
 [[maybe_unused]] void JoSon::Doc::set_str(const char* value) {
     delete_var();
     t = JoSon::Type::Str;
-    var = value;
+    refer_str(value ? std::string_view(value) : std::string_view(), false);
 }
 
 [[maybe_unused]] void JoSon::Doc::set_tuple(DocTuple& value) {
-    delete_var();
-    t = JoSon::Type::Tuple;
-    var = static_cast<DocTuple*>(&value);
+    Doc held;
+    held.t = JoSon::Type::Tuple;
+    held.val.tuple = &value;
+    // Shared with the Doc instances holding it, if any, otherwise borrowed
+    held.flags = value.refs.load(std::memory_order_relaxed) == 0 ? Borrowed : Owned;
+    held.retain();
+    *this = std::move(held);
 }
 
 [[maybe_unused]] void JoSon::Doc::set_arr(DocArr& value) {
-    delete_var();
-    t = JoSon::Type::Array;
-    var = static_cast<DocArr*>(&value);
+    Doc held;
+    held.t = JoSon::Type::Array;
+    held.val.arr = &value;
+    // Shared with the Doc instances holding it, if any, otherwise borrowed
+    held.flags = value.refs.load(std::memory_order_relaxed) == 0 ? Borrowed : Owned;
+    held.retain();
+    *this = std::move(held);
 }
 
 [[maybe_unused]] void JoSon::Doc::set_dict(DictObj& value) {
-    delete_var();
-    t = JoSon::Type::Dict;
-    var = static_cast<DictObj*>(&value);
+    Doc held;
+    held.t = JoSon::Type::Dict;
+    held.val.dict = &value;
+    // Shared with the Doc instances holding it, if any, otherwise borrowed
+    held.flags = value.refs.load(std::memory_order_relaxed) == 0 ? Borrowed : Owned;
+    held.retain();
+    *this = std::move(held);
 }
 
 [[maybe_unused]] void JoSon::Doc::set_null() {
     delete_var();
     t = JoSon::Type::Nullptr;
-    var = nullptr;
 }
 
 [[maybe_unused]] bool JoSon::Doc::null_check() const {
@@ -632,13 +1351,13 @@ JoSon::Doc::~Doc() { delete_var(); }
 
         case JoSon::Type::Tuple:
             // If it's a Tuple, return the s stored in the DocTuple object
-            return std::get<DocTuple*>(var)->size();
+            return val.tuple ? val.tuple->size() : 0;
         case JoSon::Type::Array:
             // If it's an Array, return the s stored in the DocArr object
-            return std::get<DocArr*>(var)->size();
+            return val.arr ? val.arr->size() : 0;
         case JoSon::Type::Dict:
-            // If it's a Dict (unordered_map), return the s of the map
-            return std::get<DictObj*>(var)->size();
+            // If it's a Dict, return the s of the dictionary object
+            return val.dict ? val.dict->size() : 0;
         case JoSon::Type::Nullptr:
             break;
     }
@@ -679,95 +1398,107 @@ JoSon::Doc::~Doc() { delete_var(); }
 
 JoSon::Type JoSon::Doc::get_type() const { return t; }
 
-void JoSon::Doc::upsert(const char* key, const Doc& doc) {
-    if (t == JoSon::Type::Dict) {
-        if (auto* map_ptr = std::get_if<DictObj*>(&var)) {
-            // Dereference the pointer to access the unordered_map
-            auto& map = *map_ptr;
-
-            // Use operator[] to insert or update the key-doc pair
-            (*map)[key] = doc;
-            return;
-        }
+void JoSon::Doc::upsert(std::string_view key, const Doc& doc) {
+    if (t != JoSon::Type::Dict) {
+        throw std::runtime_error("Error: Key-Value pair only available for Dict "
+                                 "(DictObj)");
     }
-    throw std::runtime_error("Error: Key-Value pair only available for Dict "
-                             "(std::unordered_map<const char*, Doc>)");
+    // Copy first: appending the key may move the member doc refers to
+    Doc value(doc);
+    (*val.dict)[key] = std::move(value);
 }
 
-[[maybe_unused]] bool JoSon::Doc::erase(const char* key) {
-    if (t == JoSon::Type::Dict) {
-        if (auto* map_ptr = std::get_if<DictObj*>(&var)) {
-            auto& map = *map_ptr;
+void JoSon::Doc::upsert(std::string_view key, Doc&& doc) {
+    if (t != JoSon::Type::Dict) {
+        throw std::runtime_error("Error: Key-Value pair only available for Dict "
+                                 "(DictObj)");
+    }
+    Doc value(std::move(doc)); // doc may be a member of this dictionary
+    (*val.dict)[key] = std::move(value);
+}
 
-            // Find the element with the given key
-            auto it = map->find(key);
-            if (it != map->end()) {
-                // Erase the element if found
-                map->erase(it);
-                return true; // Return true indicating successful removal
-            } else {
-                return false; // Return false indicating key not found
-            }
-        }
+[[maybe_unused]] bool JoSon::Doc::erase(std::string_view key) {
+    if (t != JoSon::Type::Dict) {
+        throw std::runtime_error("Error: Key-Value pair only available for Dict "
+                                 "(DictObj).");
+    }
+    // Find the element with the given key
+    auto it = val.dict->find(key);
+    if (it == val.dict->end()) {
+        return false; // Return false indicating key not found
     }
-    throw std::runtime_error("Error: Key-Value pair only available for Dict "
-                             "(std::unordered_map<const char*, Doc>).");
+    // Erase the element if found
+    val.dict->erase(it);
+    return true; // Return true indicating successful removal
 }
 
 void JoSon::Doc::emplace_back(const Doc& doc) {
-    if (t == JoSon::Type::Array) {
-        if (auto* arr_ptr = std::get_if<DocArr*>(&var)) {
-            auto& array = *arr_ptr;
-            array->emplace_back(doc);
-            return;
-        }
+    if (t != JoSon::Type::Array) {
+        throw std::runtime_error(
+                "Error: Can only emplace back for ArrayList type.");
+    }
+    val.arr->emplace_back(doc);
+}
+
+void JoSon::Doc::emplace_back(Doc&& doc) {
+    if (t != JoSon::Type::Array) {
+        throw std::runtime_error(
+                "Error: Can only emplace back for ArrayList type.");
     }
-    throw std::runtime_error(
-            "Error: Can only emplace back for ArrayList type.");
+    val.arr->emplace_back(std::move(doc));
 }
 
 [[maybe_unused]] bool JoSon::Doc::pop_back() {
-    if (t == JoSon::Type::Array) {
-        if (auto* arr_ptr = std::get_if<DocArr*>(&var)) {
-            auto& array = *arr_ptr;
-            return array->pop_back();
-        }
+    if (t != JoSon::Type::Array) {
+        throw std::runtime_error("Error: Can only pop back for ArrayList type.");
     }
-    throw std::runtime_error("Error: Can only pop back for ArrayList type.");
+    return val.arr->pop_back();
 }
 
-// Implement operator[] for accessing elements in the unordered_map
-JoSon::Doc& JoSon::Doc::operator[](const char* key) {
-    if (t == JoSon::Type::Dict) {
-        if (auto* map_ptr = std::get_if<DictObj*>(&var)) {
-            auto& map = *map_ptr;
-            // Return a reference to the value associated with the key
-            return (*map)[key];
-        }
+// Implement operator[] for accessing elements in the dictionary object
+JoSon::Doc& JoSon::Doc::operator[](std::string_view key) {
+    if (t != JoSon::Type::Dict) {
+        throw std::runtime_error("Error: Key-Value pair only available for Dict "
+                                 "(DictObj).");
+    }
+    // Return a reference to the value associated with the key
+    return (*val.dict)[key];
+}
+
+const JoSon::Doc* JoSon::Doc::find(std::string_view key) const {
+    if (t != JoSon::Type::Dict) {
+        return nullptr;
+    }
+    auto it = static_cast<const DictObj&>(*val.dict).find(key);
+    return it != val.dict->cend() ? &it->second : nullptr;
+}
+
+const JoSon::Doc& JoSon::Doc::at(std::string_view key) const {
+    if (t != JoSon::Type::Dict) {
+        throw std::runtime_error("Error: Key-Value pair only available for Dict "
+                                 "(DictObj).");
     }
-    throw std::runtime_error("Error: Key-Value pair only available for Dict "
-                             "(std::unordered_map<const char*, Doc>).");
+    return static_cast<const DictObj&>(*val.dict).at(key);
 }
+// Both use the const lookups of DictObj, which read the members and the index only.
 
 // Implement operator() for accessing elements in DocArr and DocTuple
 const JoSon::Doc& JoSon::Doc::operator()(size_t index) const {
-    if (auto* arr_ptr = std::get_if<DocArr*>(&var)) {
-        auto& arr = *arr_ptr;
-        if (index >= arr->size()) {
-            throw std::out_of_range("Error: Index out of bounds.");
-        }
-        // Return reference to the element at the specified index
-        return (*arr)[index];
-    } else if (auto* tup_ptr = std::get_if<DocTuple*>(&var)) {
-        auto& tup = *tup_ptr;
-        if (index >= tup->size()) {
-            throw std::out_of_range("Error: Index out of bounds.");
-        }
-        // Return reference to the element at the specified index
-        return (*tup)[index];
-    } else {
-        throw std::runtime_error("Error: Operator () only available for "
-                                 "Type::Tuple and Type::Array.");
+    switch (t) {
+        case JoSon::Type::Array:
+            if (index >= val.arr->size()) {
+                throw std::out_of_range("Error: Index out of bounds.");
+            }
+            // Return reference to the element at the specified index
+            return (*val.arr)[index];
+        case JoSon::Type::Tuple:
+            if (index >= val.tuple->size()) {
+                throw std::out_of_range("Error: Index out of bounds.");
+            }
+            return (*val.tuple)[index];
+        default:
+            throw std::runtime_error("Error: Operator () only available for "
+                                     "Type::Tuple and Type::Array.");
     }
 }
 
@@ -778,7 +1509,7 @@ std::string JoSon::Doc::str(bool visualize) const {
     doc_stk.emplace(this, "", 0);
     while (!doc_stk.empty()) {
         auto [doc_pos, str, lvl] = doc_stk.top();
-        auto doc = *doc_pos;
+        const Doc& doc = *doc_pos;
         doc_stk.pop();
         result.append(str);
         if ((doc.get_type() != JoSon::Type::Tuple &&
@@ -856,9 +1587,13 @@ std::string JoSon::Doc::str(bool visualize) const {
             result.append("{\n");
             char_stk.emplace('}');
             auto new_lvl = lvl + 1;
-            for (const auto& it : doc.get_dict_obj()) {
-                std::string new_str = "\"" + std::string(it.first) + "\": ";
-                doc_stk.emplace(&it.second, std::move(new_str), new_lvl);
+            const DictObj& dict = doc.get_dict_obj();
+            for (auto it = dict.rbegin(); it != dict.rend(); ++it) {
+                std::string new_str;
+                Text::quote(it->first, new_str);
+                new_str.append(": ");
+                doc_stk.emplace(&it->second, std::move(new_str), new_lvl);
+                // push in backwards so the first one will be the first out
             }
         }
     }
@@ -867,9 +1602,28 @@ std::string JoSon::Doc::str(bool visualize) const {
 
 JoSon::Doc& JoSon::Doc::operator=(const Doc& other) {
     if (this != &other) {
-        delete_var();
-        t = other.t;
-        var = other.var;
+        // Hold the value before releasing ours, other may live inside it
+        Doc copy(other);
+        *this = std::move(copy);
+    }
+    return *this;
+}
+
+JoSon::Doc& JoSon::Doc::operator=(Doc&& other) noexcept {
+    if (this != &other) {
+        Value value = other.val;
+        uint32_t length = other.len;
+        Type type = other.t;
+        uint8_t storage = other.flags;
+        other.val = Value{};
+        other.len = 0;
+        other.t = JoSon::Type::Nullptr;
+        other.flags = 0;
+        delete_var(); // May destroy other, its value is already taken
+        val = value;
+        len = length;
+        t = type;
+        flags = storage;
     }
     return *this;
 }
@@ -892,7 +1646,7 @@ JoSon::Doc& JoSon::Doc::operator=(const Doc& other) {
     doc_stk.emplace(&document, "", 0);
     while (!doc_stk.empty()) {
         auto [doc_pos, str, lvl] = doc_stk.top();
-        auto doc = *doc_pos;
+        const Doc& doc = *doc_pos;
         doc_stk.pop();
         stream << str;
         if ((doc.get_type() != JoSon::Type::Tuple &&
@@ -902,54 +1656,48 @@ JoSon::Doc& JoSon::Doc::operator=(const Doc& other) {
             // doc is primitive or void container
             if (doc.size() == 1 || doc.null_check()) {
                 // primitive
+                char buffer[64];
                 switch (doc.t) {
                     case JoSon::Type::Char:
-                        if (const char* value = std::get_if<char>(&doc.var)) {
-                            stream << static_cast<int>(*value);
-                        }
+                        stream << static_cast<int>(doc.val.c);
                         break;
                     case JoSon::Type::Int:
-                        if (const int* value = std::get_if<int>(&doc.var)) {
-                            stream << *value;
-                        }
+                        stream.write(buffer, static_cast<std::streamsize>(
+                                number_to_chars(buffer, doc.val.i)));
                         break;
                     case JoSon::Type::LLong:
-                        if (const long long* value =
-                                std::get_if<long long>(&doc.var)) {
-                            stream << *value;
-                        }
+                        stream.write(buffer, static_cast<std::streamsize>(
+                                number_to_chars(buffer, doc.val.ll)));
                         break;
                     case JoSon::Type::Float:
-                        if (const float* value = std::get_if<float>(&doc.var)) {
-                            stream << *value;
-                        }
+                        stream.write(buffer, static_cast<std::streamsize>(
+                                number_to_chars(buffer, doc.val.f)));
                         break;
                     case JoSon::Type::Double:
-                        if (const double* value = std::get_if<double>(&doc.var)) {
-                            stream << *value;
-                        }
+                        stream.write(buffer, static_cast<std::streamsize>(
+                                number_to_chars(buffer, doc.val.d)));
                         break;
                     case JoSon::Type::LDouble:
-                        if (const long double* value =
-                                std::get_if<long double>(&doc.var)) {
-                            stream << *value;
-                        }
+                        stream.write(buffer, static_cast<std::streamsize>(
+                                number_to_chars(buffer, *doc.val.ld)));
                         break;
                     case JoSon::Type::Bool:
-                        if (const bool* value = std::get_if<bool>(&doc.var)) {
-                            stream << std::boolalpha
-                                   << *value; // Output "true" or "false"
-                        }
+                        stream << std::boolalpha
+                               << doc.val.b; // Output "true" or "false"
                         break;
                     case JoSon::Type::Nullptr:
                         stream << "null";
                         break;
-                    case JoSon::Type::Str:
-                        if (const char** value =
-                                std::get_if<const char*>(&doc.var)) {
-                            stream << '"' << *value << '"';
+                    case JoSon::Type::Str: {
+                        std::string_view chars = doc.get_str_view();
+                        if (Text::safe_length(chars) == chars.size()) {
+                            stream << '"' << chars << '"';
+                        } else {
+                            std::string quoted;
+                            Text::quote(chars, quoted);
+                            stream << quoted;
                         }
-                        break;
+                    } break;
                     case JoSon::Type::Tuple:
                     case JoSon::Type::Array:
                     case JoSon::Type::Dict:
@@ -1018,9 +1766,13 @@ JoSon::Doc& JoSon::Doc::operator=(const Doc& other) {
             stream << "{\n" << get_indents(lvl);
             char_stk.emplace('}');
 
-            for (const auto& it : doc.get_dict_obj()) {
-                std::string new_str = "\"" + std::string(it.first) + "\": ";
-                doc_stk.emplace(&it.second, std::move(new_str), new_lvl);
+            const DictObj& dict = doc.get_dict_obj();
+            for (auto it = dict.rbegin(); it != dict.rend(); ++it) {
+                std::string new_str;
+                Text::quote(it->first, new_str);
+                new_str.append(": ");
+                doc_stk.emplace(&it->second, std::move(new_str), new_lvl);
+                // push in backwards so the first one will be the first out
             }
         }
     }
@@ -0,0 +1,45 @@
+// Format.h
+#pragma once
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <type_traits>
+
+namespace JoSon::Format {
+
+    /**
+     * @brief Writes a number in its JSON form.
+     *
+     * Integers are written in full and floating-point numbers in the shortest
+     * form that reads back to the same value, independently of the locale. A
+     * floating-point number that looks integral gets a ".0" suffix so that it is
+     * parsed back as a floating-point number, and NaN and infinities, which JSON
+     * cannot represent, are written as null.
+     *
+     * @param buffer The buffer to write to.
+     * @param value The number to write.
+     * @return The number of characters written.
+     */
+    template <typename T>
+    inline size_t number_to_chars(char (&buffer)[64], T value) {
+        if constexpr (std::is_floating_point_v<T>) {
+            if (!std::isfinite(value)) {
+                std::memcpy(buffer, "null", 4);
+                return 4;
+            }
+        }
+        auto res = std::to_chars(buffer, buffer + sizeof(buffer), value);
+        auto len = static_cast<size_t>(res.ptr - buffer);
+        if constexpr (std::is_floating_point_v<T>) {
+            if (std::find_if(buffer, res.ptr,
+                             [](char c) { return c == '.' || c == 'e'; }) == res.ptr) {
+                buffer[len++] = '.';
+                buffer[len++] = '0';
+            }
+        }
+        return len;
+    }
+} // namespace JoSon::Format
@@ -0,0 +1,517 @@
+// Image.cpp
+#include "../include/JoSon/Image.h"
+#include "../include/JoSon/Joson.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <unordered_map>
+
+/*
+ * JoSon image format (version 1)
+ *
+ * A 16-byte header: the magic "JoSI", the version, 1 for little-endian hosts
+ * (0 for big-endian ones), sizeof(long double), a zero byte, and the uint64
+ * size of the image. The slot of the root value follows at offset 16.
+ *
+ * A slot is 16 bytes: a byte holding the JoSon::Type, three zero bytes, a
+ * uint32 size, and an 8-byte payload. Offsets are from the start of the image.
+ *
+ * - Char, Int, LLong, Float, Double, Bool: the value, in the payload;
+ * - LDouble: the offset of 16 bytes holding the long double;
+ * - Str: the length as size, the offset of the null-terminated characters;
+ * - Nullptr: nothing;
+ * - Tuple, Array: the count as size, the offset of the slots of the elements;
+ * - Dict: the count as size, and the offset of the members sorted by key,
+ *   32 bytes each (the uint64 offset of the key, its uint32 length, four zero
+ *   bytes, and the slot of the value), followed by a uint32 per member, in
+ *   insertion order, giving its position in the sorted members.
+ *
+ * Keys are stored once, whatever the number of dictionary objects using them.
+ */
+
+namespace {
+    constexpr char magic[4] = {'J', 'o', 'S', 'I'};  ///< First bytes of an image.
+    constexpr uint8_t version = 1;                   ///< Version of the format.
+    constexpr size_t header_size = 16;               ///< Bytes of the header.
+    constexpr size_t slot_bytes = 16;                ///< Bytes of a slot.
+    constexpr size_t entry_bytes = 32;               ///< Bytes of a dictionary member.
+
+    /**
+     * @brief Checks whether the host is little-endian.
+     */
+    bool little_endian() {
+        const uint16_t probe = 1;
+        uint8_t first;
+        std::memcpy(&first, &probe, 1);
+        return first == 1;
+    }
+
+    /**
+     * @brief Writes a trivially copyable value at an offset of the image.
+     */
+    template <typename T> void store(std::string& out, size_t offset, T value) {
+        std::memcpy(&out[offset], &value, sizeof(T));
+    }
+
+    /**
+     * @brief Pads the image to a multiple of an alignment.
+     */
+    void align(std::string& out, size_t alignment) {
+        out.resize((out.size() + alignment - 1) / alignment * alignment, '\0');
+    }
+} // namespace
+
+[[nodiscard]] std::string JoSon::Utils::doc_to_image(const Doc& doc) {
+    std::string out(header_size + slot_bytes, '\0');
+    std::memcpy(&out[0], magic, 4);
+    out[4] = static_cast<char>(version);
+    out[5] = static_cast<char>(little_endian() ? 1 : 0);
+    out[6] = static_cast<char>(sizeof(long double));
+
+    std::unordered_map<std::string_view, uint64_t> key_at; // Keys already written
+    auto write_chars = [&out](std::string_view chars) {
+        const uint64_t at = out.size();
+        out.append(chars);
+        out += '\0';
+        return at;
+    };
+
+    // Slots are filled from an explicit stack, children after their parent
+    std::vector<std::pair<const Doc*, size_t>> pending{{&doc, header_size}};
+    std::vector<std::pair<std::string_view, size_t>> sorted; // Key and insertion position
+    while (!pending.empty()) {
+        auto [value, slot] = pending.back();
+        pending.pop_back();
+        const Type type = value->get_type();
+        uint32_t size = 0;
+        uint64_t payload = 0;
+        switch (type) {
+            case Type::Char: {
+                char c = value->get_char();
+                std::memcpy(&payload, &c, sizeof(c));
+                break;
+            }
+            case Type::Int: {
+                int32_t i = value->get_int();
+                std::memcpy(&payload, &i, sizeof(i));
+                break;
+            }
+            case Type::LLong: {
+                long long ll = value->get_l_long();
+                std::memcpy(&payload, &ll, sizeof(ll));
+                break;
+            }
+            case Type::Float: {
+                float f = value->get_float();
+                std::memcpy(&payload, &f, sizeof(f));
+                break;
+            }
+            case Type::Double: {
+                double d = value->get_double();
+                std::memcpy(&payload, &d, sizeof(d));
+                break;
+            }
+            case Type::LDouble: {
+                align(out, 16);
+                payload = out.size();
+                out.resize(out.size() + 16, '\0');
+                store(out, payload, value->get_long_double());
+                break;
+            }
+            case Type::Bool:
+                payload = value->get_bool() ? 1 : 0;
+                break;
+            case Type::Str: {
+                std::string_view chars = value->get_str_view();
+                size = static_cast<uint32_t>(chars.size());
+                payload = write_chars(chars);
+                break;
+            }
+            case Type::Nullptr:
+                break;
+            case Type::Tuple:
+            case Type::Array: {
+                size = static_cast<uint32_t>(value->size());
+                align(out, 8);
+                payload = out.size();
+                out.resize(out.size() + size * slot_bytes, '\0');
+                for (size_t i = 0; i < size; ++i) {
+                    const Doc& element = type == Type::Array ? value->get_arr()[i]
+                                                             : value->get_tuple()[i];
+                    pending.emplace_back(&element, payload + i * slot_bytes);
+                }
+                break;
+            }
+            case Type::Dict: {
+                const DictObj& dict = value->get_dict_obj();
+                size = static_cast<uint32_t>(dict.size());
+                sorted.clear();
+                for (const auto& member : dict) {
+                    sorted.emplace_back(member.first, sorted.size());
+                }
+                std::sort(sorted.begin(), sorted.end());
+                // Keys first, so that the members stay aligned
+                std::vector<uint64_t> keys(size);
+                for (size_t j = 0; j < size; ++j) {
+                    auto known = key_at.find(sorted[j].first);
+                    keys[j] = known != key_at.end() ? known->second
+                                                    : key_at[sorted[j].first] = write_chars(sorted[j].first);
+                }
+                align(out, 8);
+                payload = out.size();
+                out.resize(out.size() + size * (entry_bytes + sizeof(uint32_t)), '\0');
+                auto it = dict.cbegin();
+                std::vector<const Doc*> values(size);
+                for (size_t i = 0; i < size; ++i, ++it) {
+                    values[i] = &it->second;
+                }
+                for (size_t j = 0; j < size; ++j) {
+                    const size_t entry = payload + j * entry_bytes;
+                    store(out, entry, keys[j]);
+                    store(out, entry + 8, static_cast<uint32_t>(sorted[j].first.size()));
+                    store(out, payload + size * entry_bytes + sorted[j].second * sizeof(uint32_t),
+                          static_cast<uint32_t>(j));
+                    pending.emplace_back(values[sorted[j].second], entry + 16);
+                }
+                break;
+            }
+        }
+        out[slot] = static_cast<char>(type);
+        store(out, slot + 4, size);
+        store(out, slot + 8, payload);
+    }
+    store(out, 8, static_cast<uint64_t>(out.size()));
+    return out;
+}
+
+[[maybe_unused]] void JoSon::Utils::store_doc_to_image(const std::string& path,
+                                                       const Doc& doc) {
+    std::ofstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        std::cerr << "Error: Unable to open file '" << path << "' for writing."
+                  << std::endl;
+        return;
+    }
+    std::string bytes = doc_to_image(doc);
+    file.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+}
+
+JoSon::ImageDoc::ImageDoc(const char* base, size_t length, size_t slot)
+        : base(base), length(length), slot(slot) {}
+
+template <typename T> T JoSon::ImageDoc::load(size_t offset) const {
+    if (offset > length || length - offset < sizeof(T)) {
+        throw std::runtime_error("Error: Offset outside the image.");
+    }
+    T value;
+    std::memcpy(&value, base + offset, sizeof(T));
+    return value;
+}
+// Unaligned-safe read, checked against the size of the image.
+
+uint32_t JoSon::ImageDoc::slot_size() const { return load<uint32_t>(slot + 4); }
+
+uint64_t JoSon::ImageDoc::payload() const { return load<uint64_t>(slot + 8); }
+
+JoSon::Type JoSon::ImageDoc::get_type() const {
+    auto tag = load<uint8_t>(slot);
+    if (tag > static_cast<uint8_t>(Type::Dict)) {
+        throw std::runtime_error("Error: Invalid type tag in image.");
+    }
+    return static_cast<Type>(tag);
+}
+
+void JoSon::ImageDoc::expect(Type type) const {
+    if (get_type() != type) {
+        throw std::runtime_error("Error: Image value read as another type.");
+    }
+}
+
+size_t JoSon::ImageDoc::size() const {
+    switch (get_type()) {
+        case Type::Str:
+        case Type::Tuple:
+        case Type::Array:
+        case Type::Dict:
+            return slot_size();
+        default:
+            return 1;
+    }
+}
+
+std::string_view JoSon::ImageDoc::entry_key(size_t body, size_t i) const {
+    const size_t entry = body + i * entry_bytes;
+    const auto at = load<uint64_t>(entry);
+    const auto len = load<uint32_t>(entry + 8);
+    if (at > length || length - at < len) {
+        throw std::runtime_error("Error: Offset outside the image.");
+    }
+    return {base + at, len};
+}
+
+bool JoSon::ImageDoc::find(std::string_view key, ImageDoc& value) const {
+    if (get_type() != Type::Dict) {
+        return false;
+    }
+    const size_t body = payload();
+    size_t low = 0;
+    size_t high = slot_size();
+    while (low < high) {
+        size_t mid = low + (high - low) / 2;
+        std::string_view probe = entry_key(body, mid);
+        if (probe < key) {
+            low = mid + 1;
+        } else if (key < probe) {
+            high = mid;
+        } else {
+            value = ImageDoc(base, length, body + mid * entry_bytes + 16);
+            return true;
+        }
+    }
+    return false;
+}
+// Binary search over the members sorted by key.
+
+bool JoSon::ImageDoc::find(size_t index, ImageDoc& value) const {
+    const Type type = get_type();
+    if ((type != Type::Array && type != Type::Tuple) || index >= slot_size()) {
+        return false;
+    }
+    value = ImageDoc(base, length, payload() + index * slot_bytes);
+    return true;
+}
+
+uint64_t JoSon::ImageDoc::body() const {
+    const uint64_t at = payload();
+    if (at <= slot || at > length) {
+        throw std::runtime_error("Error: Offset outside the image.");
+    }
+    return at;
+}
+// Bodies always follow their slot, so that a corrupted image cannot loop.
+
+size_t JoSon::ImageDoc::count(std::string_view key) const {
+    ImageDoc value = *this;
+    return find(key, value) ? 1 : 0;
+}
+
+JoSon::ImageDoc JoSon::ImageDoc::operator[](std::string_view key) const {
+    expect(Type::Dict);
+    ImageDoc value = *this;
+    if (!find(key, value)) {
+        throw std::out_of_range("Error: Key '" + std::string(key) + "' not found in image.");
+    }
+    return value;
+}
+
+JoSon::ImageDoc JoSon::ImageDoc::operator()(size_t index) const {
+    const Type type = get_type();
+    if (type != Type::Array && type != Type::Tuple) {
+        throw std::runtime_error("Error: Image value read as another type.");
+    }
+    ImageDoc value = *this;
+    if (!find(index, value)) {
+        throw std::out_of_range("Error: Index out of range.");
+    }
+    return value;
+}
+
+std::vector<std::pair<std::string_view, JoSon::ImageDoc>> JoSon::ImageDoc::members() const {
+    std::vector<std::pair<std::string_view, ImageDoc>> out;
+    if (get_type() != Type::Dict) {
+        return out;
+    }
+    const size_t entries = body();
+    const size_t count = slot_size();
+    if ((length - entries) / (entry_bytes + sizeof(uint32_t)) < count) {
+        throw std::runtime_error("Error: Offset outside the image.");
+    }
+    out.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        auto j = load<uint32_t>(entries + count * entry_bytes + i * sizeof(uint32_t));
+        if (j >= count) {
+            throw std::runtime_error("Error: Invalid member order in image.");
+        }
+        out.emplace_back(entry_key(entries, j), ImageDoc(base, length, entries + j * entry_bytes + 16));
+    }
+    return out;
+}
+// Follows the insertion order stored after the sorted members.
+
+std::vector<JoSon::ImageDoc> JoSon::ImageDoc::children() const {
+    std::vector<ImageDoc> out;
+    const Type type = get_type();
+    if (type == Type::Dict) {
+        for (auto& member : members()) {
+            out.push_back(member.second);
+        }
+    } else if (type == Type::Array || type == Type::Tuple) {
+        const size_t elements = body();
+        const size_t count = slot_size();
+        if ((length - elements) / slot_bytes < count) {
+            throw std::runtime_error("Error: Offset outside the image.");
+        }
+        out.reserve(count);
+        for (size_t i = 0; i < count; ++i) {
+            out.push_back(ImageDoc(base, length, elements + i * slot_bytes));
+        }
+    }
+    return out;
+}
+
+char JoSon::ImageDoc::get_char() const {
+    expect(Type::Char);
+    return load<char>(slot + 8);
+}
+
+int JoSon::ImageDoc::get_int() const {
+    expect(Type::Int);
+    return load<int32_t>(slot + 8);
+}
+
+long long JoSon::ImageDoc::get_l_long() const {
+    expect(Type::LLong);
+    return load<long long>(slot + 8);
+}
+
+float JoSon::ImageDoc::get_float() const {
+    expect(Type::Float);
+    return load<float>(slot + 8);
+}
+
+double JoSon::ImageDoc::get_double() const {
+    expect(Type::Double);
+    return load<double>(slot + 8);
+}
+
+long double JoSon::ImageDoc::get_long_double() const {
+    expect(Type::LDouble);
+    return load<long double>(body());
+}
+
+bool JoSon::ImageDoc::get_bool() const {
+    expect(Type::Bool);
+    return load<uint8_t>(slot + 8) != 0;
+}
+
+std::string_view JoSon::ImageDoc::get_str_view() const {
+    expect(Type::Str);
+    const uint64_t at = body();
+    const uint32_t len = slot_size();
+    if (length - at <= len) {
+        throw std::runtime_error("Error: Offset outside the image.");
+    }
+    return {base + at, len};
+}
+// The check leaves room for the null terminator.
+
+const char* JoSon::ImageDoc::get_str() const { return get_str_view().data(); }
+
+JoSon::Doc JoSon::ImageDoc::to_doc() const {
+    Doc root;
+    // Values still to copy, with the Doc receiving each of them
+    std::vector<std::pair<ImageDoc, Doc*>> pending{{*this, &root}};
+    while (!pending.empty()) {
+        auto [value, target] = pending.back();
+        pending.pop_back();
+        switch (value.get_type()) {
+            case Type::Char:
+                *target = Doc(value.get_char());
+                break;
+            case Type::Int:
+                *target = Doc(value.get_int());
+                break;
+            case Type::LLong:
+                *target = Doc(value.get_l_long());
+                break;
+            case Type::Float:
+                *target = Doc(value.get_float());
+                break;
+            case Type::Double:
+                *target = Doc(value.get_double());
+                break;
+            case Type::LDouble:
+                *target = Doc(value.get_long_double());
+                break;
+            case Type::Bool:
+                *target = Doc(value.get_bool());
+                break;
+            case Type::Str: {
+                std::string_view chars = value.get_str_view();
+                *target = Doc(chars.data(), chars.size());
+                break;
+            }
+            case Type::Nullptr:
+                *target = Doc(Type::Nullptr);
+                break;
+            case Type::Tuple: {
+                std::vector<ImageDoc> elements = value.children();
+                Doc* slots = elements.empty() ? nullptr : new Doc[elements.size()];
+                *target = Doc(new DocTuple(slots, elements.size()));
+                for (size_t i = 0; i < elements.size(); ++i) {
+                    pending.emplace_back(elements[i], &slots[i]);
+                }
+                break;
+            }
+            case Type::Array: {
+                std::vector<ImageDoc> elements = value.children();
+                if (elements.empty()) {
+                    *target = Doc(new DocArr(8));
+                    break;
+                }
+                Doc* slots = new Doc[elements.size()];
+                *target = Doc(new DocArr(slots, elements.size()));
+                for (size_t i = 0; i < elements.size(); ++i) {
+                    pending.emplace_back(elements[i], &slots[i]);
+                }
+                break;
+            }
+            case Type::Dict: {
+                auto members = value.members();
+                auto* dict = new DictObj();
+                dict->reserve(members.size());
+                *target = Doc(dict);
+                for (auto& member : members) {
+                    Doc& slot = (*dict)[member.first];
+                    pending.emplace_back(member.second, &slot);
+                }
+                break;
+            }
+        }
+    }
+    return root;
+}
+// Iterative copy: the containers are created with their final size, so the
+// addresses of the pending elements stay valid while they are filled.
+
+JoSon::Image::Image(const std::string& path) : file(path) {
+    if (!file.is_open()) {
+        throw std::runtime_error("Error: Unable to open image file '" + path + "'.");
+    }
+    data = file.view();
+    check();
+}
+
+JoSon::Image::Image(const char* bytes, size_t size) : data(bytes, size) { check(); }
+
+void JoSon::Image::check() const {
+    if (data.size() < header_size + slot_bytes || std::memcmp(data.data(), magic, 4) != 0) {
+        throw std::runtime_error("Error: Not a JoSon document image.");
+    } else if (static_cast<uint8_t>(data[4]) != version) {
+        throw std::runtime_error("Error: Unsupported JoSon image version.");
+    } else if (data[5] != (little_endian() ? 1 : 0) ||
+               static_cast<uint8_t>(data[6]) != sizeof(long double)) {
+        throw std::runtime_error("Error: JoSon image written on an incompatible platform.");
+    }
+    uint64_t size;
+    std::memcpy(&size, data.data() + 8, sizeof(size));
+    if (size != data.size()) {
+        throw std::runtime_error("Error: Truncated JoSon document image.");
+    }
+}
+
+JoSon::ImageDoc JoSon::Image::root() const {
+    return ImageDoc(data.data(), data.size(), header_size);
+}
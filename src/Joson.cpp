@@ -1,197 +1,280 @@
 // JoSon.cpp
-#include <cmath>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
 #include <fstream>
+#include <functional>
 #include <iostream>
-#include <stack>
+#include <memory>
+#include <thread>
 
 #include "../include/JoSon/Doc.h"
 #include "../include/JoSon/Joson.h"
+#include "../include/JoSon/MappedFile.h"
+#include "../include/JoSon/Observer.h"
+#include "../include/JoSon/Sax.h"
+#include "Pool.h"
+#include "Scan.h"
+#include "Text.h"
 
-[[maybe_unused]] void
-JoSon::Utils::store_doc_to_json(const std::string& path,
-                                const JoSon::Doc& json_doc) {
-    bool sync_state = std::ostream::sync_with_stdio(false);
-    std::ofstream file(path);
+/**
+ * @brief Stores a document as JSON in a file, reporting to an observer if
+ * given.
+ *
+ * @param path The file path to store the JSON.
+ * @param json_doc The document to be stored as JSON.
+ * @param space_counts The number of spaces for indentation, 0 for compact JSON.
+ * @param observer The observer, or nullptr.
+ */
+static void store_json(const std::string& path, const JoSon::Doc& json_doc,
+                       int space_counts, JoSon::Observer* observer) {
+    std::ofstream file(path, std::ios::binary);
     if (!file.is_open()) {
         std::cerr << "Error: Unable to open file '" << path << "' for writing."
                   << std::endl;
         return;
     }
 
+    JoSon::Stats stats;
+    size_t next = observer ? observer->interval : SIZE_MAX; // Bytes of the next report
+    if (observer) {
+        observer->on_begin(JoSon::Phase::Serialize, 0);
+    }
+    const auto start = std::chrono::steady_clock::now();
+    JoSon::Writer writer(
+            [&](std::string_view chunk) {
+                file.write(chunk.data(), static_cast<std::streamsize>(chunk.size()));
+                stats.bytes += chunk.size();
+                if (stats.bytes >= next) {
+                    observer->on_progress(JoSon::Phase::Serialize, stats.bytes, 0);
+                    next = observer->interval > SIZE_MAX - stats.bytes ? SIZE_MAX
+                                                                      : stats.bytes + observer->interval;
+                }
+            },
+            space_counts);
     if (json_doc.get_type() == JoSon::Type::Dict) {
-        file << json_doc;
+        writer.write(json_doc);
     } else {
         JoSon::Doc to_store(JoSon::Type::Dict);
         to_store.upsert("Welcome to JoSon", json_doc);
-        file << to_store;
+        writer.write(to_store);
     }
-    std::ostream::sync_with_stdio(sync_state);
+    writer.write_raw("\n");
+    writer.flush();
     file.close(); // Close the file stream
+    if (observer) {
+        stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        observer->on_end(JoSon::Phase::Serialize, stats);
+    }
 }
 
+[[maybe_unused]] void
+JoSon::Utils::store_doc_to_json(const std::string& path,
+                                const JoSon::Doc& json_doc, int space_counts) {
+    store_json(path, json_doc, space_counts, nullptr);
+}
+
+[[maybe_unused]] void
+JoSon::Utils::store_doc_to_json(const std::string& path, const JoSon::Doc& json_doc,
+                                Observer& observer, int space_counts) {
+    store_json(path, json_doc, space_counts, &observer);
+}
+
+/**
+ * @brief Progress reporter of a parse without observer, compiled away.
+ */
+struct NoReport {
+    static constexpr bool enabled = false; ///< Whether feed_syntax() reports.
+    size_t next = SIZE_MAX;                ///< Offset of the next report.
+    size_t done = 0;                       ///< Bytes consumed.
+
+    void operator()([[maybe_unused]] size_t pos) {}
+};
+
 /**
- * @brief Constructs a primitive Doc object from a substring of the input
- * string.
+ * @brief Progress reporter calling an Observer every Observer::interval bytes.
+ */
+struct ObserverReport {
+    static constexpr bool enabled = true; ///< Whether feed_syntax() reports.
+    JoSon::Observer& observer;            ///< The observer.
+    size_t total;                         ///< Bytes to parse.
+    size_t next;                          ///< Offset of the next report.
+    size_t done = 0;                      ///< Bytes consumed.
+
+    ObserverReport(JoSon::Observer& observer, size_t total)
+            : observer(observer), total(total), next(observer.interval) {}
+
+    /**
+     * @brief Reports the offset reached and schedules the next report.
+     *
+     * @param pos The offset reached.
+     */
+    void operator()(size_t pos) {
+        observer.on_progress(JoSon::Phase::Parse, pos, total);
+        next = observer.interval > SIZE_MAX - pos ? SIZE_MAX : pos + observer.interval;
+    }
+};
+
+/**
+ * @brief Feeds the structural characters of a JSON text to a Syntax.
+ *
+ * Scan::Indexer finds the structural characters (brackets, colons, commas,
+ * quotes and the start of bare tokens) with SIMD, and only those positions
+ * are handed to the Syntax. Feeding stops when the outermost container
+ * closes.
  *
- * @param input The input string.
- * @param pos A pointer to the position in the input string.
- * @param fin The final character to stop parsing at.
- * @return A primitive Doc object.
+ * @tparam Report NoReport, or ObserverReport to report the progress.
+ * @param input The JSON text, starting outside any string.
+ * @param syntax The receiver of the tokens.
+ * @param report Called with the offset reached once it passes report.next;
+ * receives the number of bytes consumed in report.done.
+ * @param indexer The indexer to run over input, whose storage is reused.
+ * @return False if the handler asked to stop.
  */
-inline JoSon::Doc string_to_prim_doc(const char* input, size_t* pos,
-                                     char fin = ' ') {
-    // String
-    if (input[*pos] == '\"') {
-        size_t parse = ++(*pos);
-        while (input[parse] != '\"') {
-            ++parse;
+template <typename Report>
+static bool feed_syntax(std::string_view input, JoSon::Syntax& syntax, Report& report,
+                        JoSon::Scan::Indexer& indexer) {
+    indexer.reset(input);
+    size_t pos = 0;
+    bool ok = true;
+    while (ok && indexer.next(pos)) {
+        if constexpr (Report::enabled) {
+            if (pos >= report.next) {
+                report(pos);
+            }
         }
-        char* str =
-                new char[parse - (*pos) + 1]; // Allocate memory for C-string
-        // (+1 for null terminator)
-        std::copy(input + *pos, input + parse, str);
-        // Copy substring contents to C-string
-        str[parse - (*pos)] = '\0'; // Add null terminator
-        *pos = parse + 1;
-        return JoSon::Doc(static_cast<const char*>(str));
-    }
-        // Bool
-    else if (strncmp(input + *pos, "true", 4) == 0) {
-        *pos += 4;
-        return JoSon::Doc(true);
-    }
-        // Check for "false"
-    else if (strncmp(input + *pos, "false", 5) == 0) {
-        *pos += 5;
-        return JoSon::Doc(false);
-    }
-        // Check for "null"
-    else if (strncmp(input + *pos, "null", 4) == 0) {
-        *pos += 4;
-        return JoSon::Doc(JoSon::Type::Nullptr);
-
-    } else if (input[*pos] == '+' || input[*pos] == '-' || input[*pos] == '.' ||
-               (input[*pos] >= '0' && input[*pos] <= '9')) {
-        bool sign = true;                 // Default sign is positive
-        JoSon::Type t = JoSon::Type::Int; // Default type is integer
-        size_t floating = 0; // Count of digits after the decimal point
-        size_t len = 0;      // Length of the number
-        int int_val = 0;
-        long long long_val = 0L;
-        double decimal = 0.0;
-
-        // Check sign
-        if (input[*pos] == '-') {
-            sign = false;
-            ++(*pos);
-        } else if (input[*pos] == '+') {
-            ++(*pos);
+        const char c = input[pos];
+        if (c == '{' || c == '[') {
+            ok = syntax.open(c == '{');
+        } else if (c == '}' || c == ']') {
+            // reaching the end of this object
+            ok = syntax.close();
+            if (syntax.depth() == 0) {
+                break;
+            }
+        } else if (c == ':') {
+            syntax.colon();
+        } else if (c == ',') {
+            ok = syntax.comma();
+        } else if (c == '"') {
+            // The closing quote is always the next structural
+            size_t close;
+            if (!indexer.next(close)) {
+                break; // Unterminated string
+            }
+            ok = syntax.string(input.substr(pos + 1, close - pos - 1));
+        } else {
+            // Primitive types and unquoted keys
+            ok = syntax.bare(input.substr(pos));
         }
+    }
+    report.done = ok && syntax.depth() == 0 ? input.size() : std::min(pos + 1, input.size());
+    return ok;
+}
 
-        // Check if the number is a floating-point number
-        bool has_point = false;
-        if (input[*pos] == '.') {
-            has_point = true;
-            t = JoSon::Type::Double;
-            ++(*pos);
-        }
+/**
+ * @brief Feeds the structural characters of a JSON text to a Syntax, with an
+ * indexer of its own.
+ */
+template <typename Report>
+static bool feed_syntax(std::string_view input, JoSon::Syntax& syntax, Report& report) {
+    JoSon::Scan::Indexer indexer(input);
+    return feed_syntax(input, syntax, report, indexer);
+}
 
-        // Read digits
-        while ((input[*pos] >= '0' && input[*pos] <= '9') ||
-               input[*pos] == '.') {
-            if (input[*pos] == '.') {
-                if (has_point) {
-                    return JoSon::Doc(JoSon::Type::Nullptr);
-                }
-                has_point = true;
-                if (t == JoSon::Type::Int) {
-                    decimal = static_cast<double>(int_val);
-                } else if (t == JoSon::Type::LLong) {
-                    decimal = static_cast<double>(long_val);
-                }
-                t = JoSon::Type::Double;
-                ++(*pos);
-                continue;
-            }
-            if (t == JoSon::Type::Int && len == 9) {
-                // Switch to long_long if the number is too long for int
-                t = JoSon::Type::LLong;
-                long_val = static_cast<long long>(int_val);
-            }
+/**
+ * @brief Handler counting the events of a parse before forwarding them.
+ *
+ * Only inserted for observers setting Observer::counts_nodes.
+ */
+struct CountingHandler final : public JoSon::Handler {
+    JoSon::Handler& target; ///< The receiver of the events.
+    JoSon::Stats& stats;    ///< The counters.
+    size_t depth = 0;       ///< Current nesting of containers.
+
+    CountingHandler(JoSon::Handler& target, JoSon::Stats& stats)
+            : target(target), stats(stats) {}
+
+    /**
+     * @brief Counts a value of a type.
+     */
+    void count(JoSon::Type type) { ++stats.nodes[static_cast<size_t>(type)]; }
+
+    bool on_begin_object() override {
+        count(JoSon::Type::Dict);
+        stats.max_depth = std::max(stats.max_depth, ++depth);
+        return target.on_begin_object();
+    }
 
-            if (t == JoSon::Type::LLong && len == 16) {
-                // Switch to double if the number is too long for long
-                t = JoSon::Type::Double;
-                decimal = static_cast<double>(long_val);
-            }
+    bool on_end_object() override {
+        depth -= depth > 0;
+        return target.on_end_object();
+    }
 
-            if (has_point) {
-                ++floating;
-            }
+    bool on_begin_array() override {
+        count(JoSon::Type::Array);
+        stats.max_depth = std::max(stats.max_depth, ++depth);
+        return target.on_begin_array();
+    }
 
-            if (t == JoSon::Type::Int) {
-                int_val *= 10;
-                int_val += input[*pos] - '0';
-            } else if (t == JoSon::Type::LLong) {
-                long_val *= 10;
-                long_val += input[*pos] - '0';
-            } else {
-                decimal *= 10;
-                decimal += input[*pos] - '0';
-            }
-            ++len;
-            ++*pos;
-        }
+    bool on_end_array() override {
+        depth -= depth > 0;
+        return target.on_end_array();
+    }
+
+    bool on_key(std::string_view key) override {
+        ++stats.keys;
+        return target.on_key(key);
+    }
 
-        decimal *= pow(10.0, static_cast<int>(-floating));
+    bool on_string(std::string_view value) override {
+        count(JoSon::Type::Str);
+        return target.on_string(value);
+    }
 
-        if (input[*pos] == 'e' || input[*pos] == 'E') {
-            if (t == JoSon::Type::Int) {
-                decimal = static_cast<double>(int_val);
-            } else if (t == JoSon::Type::LLong) {
-                decimal = static_cast<double>(long_val);
-            }
-            t = JoSon::Type::Double;
-            ++(*pos);
-            bool e_sign = true;
-            if (input[*pos] == '+' || input[*pos] == '-') {
-                e_sign = (input[*pos] != '-');
-                ++(*pos);
-            }
-            double exp = 0.0;
-            while (input[*pos] >= '0' && input[*pos] <= '9') {
-                exp *= 10;
-                exp += input[*pos] - '0';
-                ++(*pos);
-            }
-            decimal *= pow(10.0, e_sign ? exp : -exp);
-        }
+    bool on_number(const JoSon::Doc& value) override {
+        count(value.get_type());
+        return target.on_number(value);
+    }
 
-        if (input[*pos] == '\0' || input[*pos] == ' ' || input[*pos] == ',' ||
-            input[*pos] == '\t' || input[*pos] == '\n' || input[*pos] == '\r' ||
-            input[*pos] == fin) {
-            // All characters parsed successfully
-            if (t == JoSon::Type::Int) {
-                return JoSon::Doc(sign ? int_val : -int_val);
-            } else if (t == JoSon::Type::LLong) {
-                return JoSon::Doc(sign ? long_val : -long_val);
-            } else {
-                if (!sign) {
-                    decimal *= -1;
-                }
-                return JoSon::Doc(decimal);
-            }
-        }
+    bool on_bool(bool value) override {
+        count(JoSon::Type::Bool);
+        return target.on_bool(value);
     }
-    // the format is not respected, read to the end
-    while (input[*pos] != '\0' && input[*pos] != ',' && input[*pos] != fin) {
-        ++(*pos);
+
+    bool on_null() override {
+        count(JoSon::Type::Nullptr);
+        return target.on_null();
     }
-    return JoSon::Doc(JoSon::Type::Nullptr); // Default case, treated as null
-}
+};
 
-[[nodiscard]] JoSon::Doc JoSon::Utils::string_to_doc(const std::string& input,
-                                                     bool show_bar) {
+/**
+ * @brief Parses a JSON-formatted string into handler events.
+ *
+ * The input is parsed in two stages: Scan::Indexer finds the structural
+ * characters (brackets, colons, commas, quotes and the start of bare tokens)
+ * with SIMD, and only those positions are handed to a Syntax, which calls the
+ * handler. Every key and string passed to the handler is a view of input.
+ *
+ * @param input The JSON-formatted string to be parsed. No null terminator is
+ * needed.
+ * @tparam Report NoReport, or ObserverReport to report the progress.
+ * @param syntax The Syntax calling the receiver of the events, expecting a
+ * root value.
+ * @param report The progress reporter, see feed_syntax().
+ * @param indexer The indexer to run over input, whose storage is reused.
+ * @return False if the format is wrong or the handler asked to stop.
+ */
+template <typename Report>
+static bool parse_events(std::string_view input, JoSon::Syntax& syntax, Report& report,
+                         JoSon::Scan::Indexer& indexer) {
+    report.done = input.size(); // Unless the text is fed to the Syntax
+    if (input.empty()) {
+        std::cerr << "Error: Empty or invalid JSON content." << std::endl;
+        return false;
+    }
     size_t start = 0;
     size_t end = input.size() - 1;
 
@@ -212,213 +295,673 @@ inline JoSon::Doc string_to_prim_doc(const char* input, size_t* pos,
     // Empty or all spaces
     if (start > end) {
         std::cerr << "Error: Empty or invalid JSON content." << std::endl;
-        return Doc(Type::Nullptr);
+        return false;
     }
 
-    std::stack<Doc> ge_stk;
-    size_t count;
-    if (input[start] == '{' && input[end] == '}') {
-        count = start + 1;
-        Doc res(Type::Dict);
-        ge_stk.emplace(res);
-    } else if (input[start] == '[' && input[end] == ']') {
-        count = start + 1;
-        Doc res(Type::Array);
-        ge_stk.emplace(res);
+    if (input[start] == '"') {
+        // A string as the root value
+        size_t close = start + 1;
+        while (close <= end && input[close] != '"') {
+            close += input[close] == '\\' ? 2 : 1; // Skip escaped characters
+        }
+        close = close < end ? close : end + (input[end] != '"');
+        return syntax.string(input.substr(start + 1, close - start - 1));
     } else if (input[start] != '[' && input[end] != ']' &&
                input[start] != '{' && input[end] != '}') {
-        count = start;
-        return string_to_prim_doc(input.c_str(), &count);
-    } else {
+        return syntax.bare(input.substr(start, end - start + 1));
+    } else if (!(input[start] == '{' && input[end] == '}') &&
+               !(input[start] == '[' && input[end] == ']')) {
         // Wrong format
-        return Doc(Type::Nullptr);
+        return false;
     }
-    const size_t totalCharacters = input.size();
-    if (show_bar) {
-        std::cout << "\nParsing..." << '\n';
+    return feed_syntax(input.substr(0, end + 1), syntax, report, indexer);
+}
+
+/**
+ * @brief Parses a JSON-formatted string into handler events, reporting to an
+ * observer if given.
+ *
+ * @param input The JSON-formatted string to be parsed.
+ * @param handler The receiver of the events.
+ * @param observer The observer, or nullptr for the parser without reporting.
+ * @return False if the format is wrong or the handler asked to stop.
+ */
+static bool parse_to_events(std::string_view input, JoSon::Handler& handler,
+                            JoSon::Observer* observer) {
+    JoSon::Scan::Indexer indexer({});
+    if (observer == nullptr) {
+        NoReport report;
+        JoSon::Syntax syntax(handler);
+        return parse_events(input, syntax, report, indexer);
+    }
+    JoSon::Stats stats;
+    observer->on_begin(JoSon::Phase::Parse, input.size());
+    ObserverReport report(*observer, input.size());
+    const auto start = std::chrono::steady_clock::now();
+    bool ok;
+    if (observer->counts_nodes) {
+        CountingHandler counter(handler, stats);
+        JoSon::Syntax syntax(counter);
+        ok = parse_events(input, syntax, report, indexer);
+    } else {
+        JoSon::Syntax syntax(handler);
+        ok = parse_events(input, syntax, report, indexer);
     }
-    const auto input_str = input.c_str();
-    Viso::ProgressBar progressBar(reinterpret_cast<std::atomic<size_t> *const>(&count),
-                                  reinterpret_cast<const std::atomic<size_t> *>(&totalCharacters));
-    while (count < totalCharacters) {
+    stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    stats.bytes = report.done;
+    observer->on_end(JoSon::Phase::Parse, stats);
+    return ok;
+}
 
-        if (input_str[count] == ' ' || input_str[count] == '\n' ||
-            input_str[count] == '\t' || input_str[count] == '\r') {
-            ++count;
-            continue;
+/**
+ * @brief Parses a JSON-formatted string into handler events, with a progress
+ * bar if asked.
+ *
+ * @param input The JSON-formatted string to be parsed.
+ * @param handler The receiver of the events.
+ * @param show_bar Flag indicating whether to display a progress bar.
+ * @return False if the format is wrong or the handler asked to stop.
+ */
+static bool parse_to_events(std::string_view input, JoSon::Handler& handler,
+                            bool show_bar) {
+    if (!show_bar) {
+        return parse_to_events(input, handler, nullptr);
+    }
+    JoSon::ProgressObserver bar;
+    return parse_to_events(input, handler, &bar);
+}
+
+/**
+ * @brief Parses a JSON-formatted string, allocating from an arena if given.
+ *
+ * The parser keeps the leniency of the original byte-by-byte loop: keys may be
+ * unquoted, a missing value reads as null, and an unterminated document
+ * returns what has been built so far.
+ *
+ * @param input The JSON-formatted string to be parsed. No null terminator is
+ * needed.
+ * @tparam Progress bool for the show_bar flag, or JoSon::Observer*.
+ * @param progress Whether to display a progress bar, or the observer.
+ * @param arena The arena to build the document in, or nullptr to use new.
+ * @param borrow Whether keys and strings are views into input instead of
+ * copies.
+ * @param keys The pool to intern keys in, or nullptr to copy them.
+ * @return The parsed document.
+ */
+template <typename Progress>
+static JoSon::Doc parse_to_doc(std::string_view input, Progress progress,
+                               JoSon::Arena* arena, bool borrow,
+                               JoSon::KeyPool* keys = nullptr) {
+    JoSon::TreeBuilder builder(arena, borrow, keys);
+    parse_to_events(input, builder, progress);
+    return builder.result();
+}
+
+/**
+ * @brief Collects the next non-blank lines of a JSON Lines input.
+ *
+ * @param input The whole input.
+ * @param offset Offset of the first unread byte, advanced past the lines read.
+ * @param max Maximum number of lines to collect.
+ * @param lines Receives views of the lines, without their newline.
+ */
+static void next_lines(std::string_view input, size_t& offset, size_t max,
+                       std::vector<std::string_view>& lines) {
+    lines.clear();
+    while (offset < input.size() && lines.size() < max) {
+        const void* nl = std::memchr(input.data() + offset, '\n', input.size() - offset);
+        size_t end = nl ? static_cast<size_t>(static_cast<const char*>(nl) - input.data())
+                        : input.size();
+        std::string_view line = input.substr(offset, end - offset);
+        offset = end + 1;
+        if (line.find_first_not_of(" \t\r") != std::string_view::npos) {
+            lines.push_back(line);
         }
-        auto doc = ge_stk.top();
+    }
+}
 
-        if (input_str[count] == ',') {
-            ++count;
-            continue;
-        } else if (input_str[count] == '}' || input_str[count] == ']') {
-            // reaching the end of this object
-            ++count;
-            ge_stk.pop();
-            if (ge_stk.empty()) {
-                if (show_bar) {
-                    progressBar.update();
-                    std::cout << "\nProgress Finished.\n";
-                }
-                return doc;
+/**
+ * @brief Parses lines in parallel, one document per line.
+ *
+ * @param lines The records to parse.
+ * @param docs Receives the documents, in the order of lines.
+ * @param pool The threads to parse with.
+ */
+static void parse_lines(const std::vector<std::string_view>& lines,
+                        std::vector<JoSon::Doc>& docs, JoSon::Pool& pool) {
+    constexpr size_t grain = 32; // Lines claimed at a time by a thread
+    const size_t offset = docs.size();
+    docs.resize(offset + lines.size());
+    std::atomic<size_t> next(0);
+    pool.run([&]() {
+        while (true) {
+            size_t begin = next.fetch_add(grain, std::memory_order_relaxed);
+            if (begin >= lines.size()) {
+                return;
             }
+            size_t end = std::min(begin + grain, lines.size());
+            for (size_t i = begin; i < end; ++i) {
+                docs[offset + i] = parse_to_doc(lines[i], false, nullptr, false);
+            }
+        }
+    });
+}
+
+/**
+ * @brief Parses JSON Lines in batches, handing the records to a callback in
+ * order.
+ *
+ * @param input The whole input.
+ * @param callback Receives each record with its index.
+ * @param threads Number of threads, 0 for one per hardware thread.
+ * @return The number of records.
+ */
+static size_t parse_lines_in_batches(std::string_view input,
+                                     const std::function<void(size_t, JoSon::Doc&)>& callback,
+                                     size_t threads) {
+    JoSon::Pool pool(threads);
+    const size_t batch = 1024 * pool.size();
+    std::vector<std::string_view> lines;
+    std::vector<JoSon::Doc> docs;
+    size_t offset = 0;
+    size_t count = 0;
+    while (next_lines(input, offset, batch, lines), !lines.empty()) {
+        docs.clear();
+        parse_lines(lines, docs, pool);
+        for (auto& doc : docs) {
+            callback(count++, doc);
+        }
+    }
+    return count;
+}
+
+/**
+ * @brief Parses a whole JSON Lines input.
+ *
+ * @param input The whole input.
+ * @param threads Number of threads, 0 for one per hardware thread.
+ * @return One document per non-blank line.
+ */
+static std::vector<JoSon::Doc> parse_all_lines(std::string_view input, size_t threads) {
+    std::vector<std::string_view> lines;
+    size_t offset = 0;
+    next_lines(input, offset, static_cast<size_t>(-1), lines);
+    std::vector<JoSon::Doc> docs;
+    docs.reserve(lines.size());
+    // A thread per 256 lines at most, starting threads costs more than small inputs
+    if (threads == 0) {
+        threads = std::thread::hardware_concurrency();
+    }
+    JoSon::Pool pool(std::max<size_t>(1, std::min(threads, lines.size() / 256)));
+    parse_lines(lines, docs, pool);
+    return docs;
+}
+
+/**
+ * @brief Quote and depth summary of a chunk of JSON text.
+ *
+ * A chunk is scanned once, before it is known whether it starts inside a
+ * string, so the depth change is counted for both cases: bytes outside
+ * strings under one assumption are exactly the bytes inside strings under the
+ * other.
+ */
+struct ChunkSummary {
+    bool odd_quotes = false; ///< Whether the chunk flips the in-string state.
+    long depth_out = 0;      ///< Depth change if the chunk starts outside a string.
+    long depth_in = 0;       ///< Depth change if the chunk starts inside a string.
+};
+
+/**
+ * @brief Checks whether the byte at pos is escaped by the backslashes before it.
+ *
+ * @param input The whole input.
+ * @param pos Offset of the byte.
+ * @return True if an odd number of backslashes precedes it.
+ */
+static bool escaped_at(std::string_view input, size_t pos) {
+    size_t run = 0;
+    while (pos > run && input[pos - run - 1] == '\\') {
+        ++run;
+    }
+    return (run & 1) != 0;
+}
+
+/**
+ * @brief Scans a chunk for its quote and depth summary.
+ *
+ * @param input The whole input.
+ * @param begin Offset of the chunk.
+ * @param end Offset of the end of the chunk.
+ * @return The summary of the chunk.
+ */
+static ChunkSummary summarize_chunk(std::string_view input, size_t begin, size_t end) {
+    ChunkSummary summary;
+    bool escaped = escaped_at(input, begin);
+    bool inside = false; // Assuming the chunk starts outside a string
+    for (size_t i = begin; i < end; ++i) {
+        const char c = input[i];
+        if (escaped) {
+            escaped = false;
+        } else if (c == '\\') {
+            escaped = true;
+        } else if (c == '"') {
+            inside = !inside;
+        } else if (c == '{' || c == '[' || c == '}' || c == ']') {
+            long step = (c == '{' || c == '[') ? 1 : -1;
+            (inside ? summary.depth_in : summary.depth_out) += step;
+        }
+    }
+    summary.odd_quotes = inside;
+    return summary;
+}
+
+/**
+ * @brief Finds the first comma separating two members of the root container.
+ *
+ * @param input The whole input.
+ * @param begin Offset to search from.
+ * @param end Offset of the closing bracket of the root container.
+ * @param inside Whether begin is inside a string.
+ * @param depth Nesting depth at begin, 1 being directly in the root.
+ * @return The offset of the comma, or end if there is none.
+ */
+static size_t find_split(std::string_view input, size_t begin, size_t end,
+                         bool inside, long depth) {
+    bool escaped = escaped_at(input, begin);
+    for (size_t i = begin; i < end; ++i) {
+        const char c = input[i];
+        if (escaped) {
+            escaped = false;
+        } else if (c == '\\') {
+            escaped = true;
+        } else if (c == '"') {
+            inside = !inside;
+        } else if (inside) {
             continue;
+        } else if (c == '{' || c == '[') {
+            ++depth;
+        } else if (c == '}' || c == ']') {
+            --depth;
+        } else if (c == ',' && depth == 1) {
+            return i;
         }
-        if (doc.get_type() == Type::Dict) {
-            size_t next = count + 1;
-            while (next < totalCharacters) {
-                if (input_str[next] == ':') {
-                    break;
-                }
-                ++next;
-            }
-            if (next == totalCharacters) {
-                count = next;
-                break;
-            }
-            size_t left = count;
-            size_t right = next - 1;
-            if (input_str[left] == '"') {
-                ++left;
-            }
-            while (left < right) {
-                if (input_str[right] == ' ' || input_str[right] == '\n' ||
-                    input_str[right] == '\t' || input_str[right] == '\r') {
-                    --right;
-                } else {
-                    break;
-                }
-            }
+    }
+    return end;
+}
 
-            if(input_str[right] != '"'){
-                ++right;
-            }
+/**
+ * @brief Parses a slice of the members of a root container.
+ *
+ * @param slice The members, without the brackets of the container.
+ * @param dict Whether the container is an object.
+ * @param result Receives a container holding the members of the slice.
+ * @return False if the slice does not hold complete members.
+ */
+static bool parse_slice(std::string_view slice, bool dict, JoSon::Doc& result) {
+    JoSon::TreeBuilder builder;
+    JoSon::Syntax syntax(builder);
+    syntax.open(dict);
+    NoReport report;
+    if (!feed_syntax(slice, syntax, report) || syntax.depth() != 1) {
+        return false;
+    }
+    syntax.close();
+    result = builder.result();
+    return true;
+}
 
-            char* str = new char[right - left + 1];
-            // Allocate memory for C-string (+1 for null terminator)
-            std::copy(input_str + left, input_str + right, str);
-            // Copy substring contents to C-string
-            str[right - left] = '\0'; // Add null terminator
-            auto key = static_cast<const char*>(str);
-
-            count = next + 1;
-            while (count < totalCharacters) {
-                if (input_str[count] == ' ' || input_str[count] == '\n' ||
-                    input_str[count] == '\t' || input_str[count] == '\r') {
-                    ++count;
-                    continue;
-                } else {
-                    break;
-                }
-            }
+/**
+ * @brief Parses one large document on several threads.
+ *
+ * The root array or object is cut into slices at commas between its members,
+ * each slice is parsed by a thread into a container of its own, and the
+ * containers are stitched together in order.
+ *
+ * To find the commas, the input is cut into chunks and every chunk is
+ * summarized in parallel by summarize_chunk(); a prefix over the summaries
+ * gives the in-string state and depth at each chunk start, from which a thread
+ * looks for the next comma directly inside the root. If the summaries do not
+ * balance, or a slice does not hold complete members, the speculation failed
+ * and the document is parsed serially instead.
+ *
+ * @param input The JSON-formatted string to be parsed.
+ * @param threads Number of threads, 0 for one per hardware thread.
+ * @return The parsed document.
+ */
+static JoSon::Doc parse_in_parallel(std::string_view input, size_t threads) {
+    constexpr size_t min_slice = 1024 * 1024; // Smaller inputs are not worth a thread
+    constexpr std::string_view blanks(" \t\n\r\0", 5);
+    size_t start = input.find_first_not_of(blanks);
+    size_t end = input.find_last_not_of(blanks);
+    if (threads == 0) {
+        threads = std::thread::hardware_concurrency();
+    }
+    threads = std::min(threads, input.size() / min_slice);
+    if (threads < 2 || start == std::string_view::npos ||
+        !((input[start] == '[' && input[end] == ']') ||
+          (input[start] == '{' && input[end] == '}'))) {
+        return parse_to_doc(input, false, nullptr, false);
+    }
+    const bool dict = input[start] == '{';
+    JoSon::Pool pool(threads);
+    const size_t slices = pool.size() * 4; // Several per thread to balance the work
+    const size_t chunk = (end - start) / slices + 1;
+
+    // Summarize the chunks, then locate the in-string state and depth of each one
+    std::vector<ChunkSummary> summaries(slices);
+    std::atomic<size_t> next(0);
+    pool.run([&]() {
+        for (size_t i; (i = next.fetch_add(1, std::memory_order_relaxed)) < slices;) {
+            size_t begin = start + i * chunk;
+            summaries[i] = summarize_chunk(input, std::min(begin, end),
+                                           std::min(begin + chunk, end));
+        }
+    });
+    std::vector<bool> inside(slices);
+    std::vector<long> depth(slices);
+    bool in_string = false;
+    long level = 0;
+    for (size_t i = 0; i < slices; ++i) {
+        inside[i] = in_string;
+        depth[i] = level;
+        level += in_string ? summaries[i].depth_in : summaries[i].depth_out;
+        in_string = in_string != summaries[i].odd_quotes;
+    }
+    if (in_string || level != 1) {
+        // The closing bracket is outside the chunks, so a balanced input ends at 1
+        return parse_to_doc(input, false, nullptr, false);
+    }
 
-            if (count == totalCharacters) {
-                break;
-            }
-            if (input_str[count] == '{') {
-                ++count;
-                Doc new_doc(Type::Dict);
-                doc.upsert(key, new_doc);
-                ge_stk.emplace(new_doc);
-            } else if (input_str[count] == '[') {
-                ++count;
-                Doc new_doc(Type::Array);
-                doc.upsert(key, new_doc);
-                ge_stk.emplace(new_doc);
-            } else if (input_str[count] == '}' || input_str[count] == ']' ||
-                       input_str[count] == ',') {
-                count = totalCharacters;
-                doc.upsert(key, Doc(Type::Nullptr));
-            } else {
-                // Primitive types
-                auto new_doc = string_to_prim_doc(input_str, &count, '}');
-                doc.upsert(key, new_doc);
+    // Find a comma after each chunk start, then parse the slices between them
+    std::vector<size_t> splits(slices);
+    splits[0] = start;
+    next = 1;
+    pool.run([&]() {
+        for (size_t i; (i = next.fetch_add(1, std::memory_order_relaxed)) < slices;) {
+            size_t begin = std::min(start + i * chunk, end);
+            splits[i] = find_split(input, begin, end, inside[i], depth[i]);
+        }
+    });
+    splits.push_back(end);
+    splits.erase(std::unique(splits.begin(), splits.end()), splits.end());
+    std::vector<JoSon::Doc> pieces(splits.size() - 1);
+    std::atomic<bool> failed(false);
+    next = 0;
+    pool.run([&]() {
+        for (size_t i; (i = next.fetch_add(1, std::memory_order_relaxed)) < pieces.size();) {
+            std::string_view slice = input.substr(splits[i] + 1, splits[i + 1] - splits[i] - 1);
+            if (!parse_slice(slice, dict, pieces[i])) {
+                failed.store(true, std::memory_order_relaxed);
             }
-        } else if (doc.get_type() == Type::Array) {
-            if (input_str[count] == '{') {
-                ++count;
-                Doc new_doc(Type::Dict);
-                doc.emplace_back(new_doc);
-                ge_stk.emplace(new_doc);
-            } else if (input_str[count] == '[') {
-                ++count;
-                Doc new_doc(Type::Array);
-                doc.emplace_back(new_doc);
-                ge_stk.emplace(new_doc);
-            } else if (input_str[count] == '}') {
-                count = totalCharacters;
-                doc.emplace_back(Doc(Type::Nullptr));
-            } else {
-                // Primitive types
-                auto new_doc = string_to_prim_doc(input_str, &count, ']');
-                doc.emplace_back(new_doc);
+        }
+    });
+    if (failed.load(std::memory_order_relaxed)) {
+        return parse_to_doc(input, false, nullptr, false);
+    }
+
+    // Stitch the pieces into the first one
+    JoSon::Doc result = std::move(pieces[0]);
+    if (dict) {
+        JoSon::DictObj& members = result.get_dict_obj();
+        for (size_t i = 1; i < pieces.size(); ++i) {
+            for (auto& member : pieces[i].get_dict_obj()) {
+                members[member.first] = std::move(member.second); // Later duplicates win
             }
         }
-        if (show_bar) {
-            progressBar.update();
+    } else {
+        JoSon::DocArr& elements = result.get_arr();
+        size_t total = 0;
+        for (auto& piece : pieces) {
+            total += piece.size();
+        }
+        elements.resize(total);
+        for (size_t i = 1; i < pieces.size(); ++i) {
+            elements.append(std::move(pieces[i].get_arr()));
         }
     }
-    if (show_bar) {
-        progressBar.update();
-        std::cout << "\nProgress Finished.\n";
+    return result;
+}
+
+[[nodiscard]] JoSon::Doc JoSon::Utils::string_to_doc(const std::string& input,
+                                                     bool show_bar) {
+    return parse_to_doc(input, show_bar, nullptr, false);
+}
+
+[[nodiscard]] JoSon::Doc JoSon::Utils::string_to_doc(const std::string& input,
+                                                     Arena& arena,
+                                                     bool show_bar) {
+    return parse_to_doc(input, show_bar, &arena, false);
+}
+
+[[nodiscard]] JoSon::Doc JoSon::Utils::string_to_doc(const std::string& input,
+                                                     KeyPool& keys,
+                                                     bool show_bar) {
+    return parse_to_doc(input, show_bar, nullptr, false, &keys);
+}
+
+[[nodiscard]] [[maybe_unused]] JoSon::Doc
+JoSon::Utils::string_to_doc(const std::string& input, Observer& observer) {
+    return parse_to_doc(input, &observer, nullptr, false);
+}
+
+[[nodiscard]] JoSon::Doc JoSon::Utils::string_view_to_doc(std::string_view input,
+                                                          bool show_bar) {
+    return parse_to_doc(input, show_bar, nullptr, true);
+}
+
+[[nodiscard]] JoSon::Doc JoSon::Utils::string_view_to_doc(std::string_view input,
+                                                          Arena& arena,
+                                                          bool show_bar) {
+    return parse_to_doc(input, show_bar, &arena, true);
+}
+
+[[nodiscard]] [[maybe_unused]] JoSon::Doc
+JoSon::Utils::read_json_file(const std::string& file_path, bool show_bar) {
+    MappedFile file(file_path);
+    if (!file.is_open()) {
+        std::cerr << "Error: Unable to open JSON file." << std::endl;
+        return Doc(Type::Nullptr);
     }
+    // Parse the mapping in place; progress is reported by byte offset
+    return parse_to_doc(file.view(), show_bar, nullptr, false);
+}
 
-    while (!ge_stk.empty()) {
-        auto doc = ge_stk.top();
-        ge_stk.pop();
-        if (ge_stk.empty()) {
-            return doc;
-        }
+[[nodiscard]] [[maybe_unused]] JoSon::Doc
+JoSon::Utils::read_json_file(const std::string& file_path, Arena& arena,
+                             bool show_bar) {
+    MappedFile file(file_path);
+    if (!file.is_open()) {
+        std::cerr << "Error: Unable to open JSON file." << std::endl;
+        return Doc(Type::Nullptr);
     }
-    Doc* res = new Doc(Type::Nullptr);
-    return *res;
+    // Parse the mapping in place; progress is reported by byte offset
+    return parse_to_doc(file.view(), show_bar, &arena, false);
 }
 
 [[nodiscard]] [[maybe_unused]] JoSon::Doc
-JoSon::Utils::read_json_file(const std::string& file_path, bool show_bar) {
-    std::ifstream jsonFile(file_path);
-    if (!jsonFile.is_open()) {
+JoSon::Utils::read_json_file(const std::string& file_path, KeyPool& keys,
+                             bool show_bar) {
+    MappedFile file(file_path);
+    if (!file.is_open()) {
         std::cerr << "Error: Unable to open JSON file." << std::endl;
         return Doc(Type::Nullptr);
     }
+    // Parse the mapping in place; progress is reported by byte offset
+    return parse_to_doc(file.view(), show_bar, nullptr, false, &keys);
+}
 
-    std::string jsonStr;
-    std::string line;
+[[nodiscard]] [[maybe_unused]] JoSon::Doc
+JoSon::Utils::read_json_file(const std::string& file_path, Observer& observer) {
+    MappedFile file(file_path);
+    if (!file.is_open()) {
+        std::cerr << "Error: Unable to open JSON file." << std::endl;
+        return Doc(Type::Nullptr);
+    }
+    return parse_to_doc(file.view(), &observer, nullptr, false);
+}
 
-    // Display progress bar if show_bar is true
-    if (show_bar) {
-        size_t totalLines = 0;
+[[nodiscard]] [[maybe_unused]] JoSon::Doc
+JoSon::Utils::parse_json_parallel(std::string_view input, size_t threads) {
+    return parse_in_parallel(input, threads);
+}
 
-        // Calculate total number of lines
-        while (std::getline(jsonFile, line)) {
-            ++totalLines;
-        }
+[[nodiscard]] [[maybe_unused]] JoSon::Doc
+JoSon::Utils::read_json_file_parallel(const std::string& file_path, size_t threads) {
+    MappedFile file(file_path);
+    if (!file.is_open()) {
+        std::cerr << "Error: Unable to open JSON file." << std::endl;
+        return Doc(Type::Nullptr);
+    }
+    return parse_in_parallel(file.view(), threads);
+}
 
-        // Reset file pointer to the beginning
-        jsonFile.clear();
-        jsonFile.seekg(0);
-        std::cout << "\nReading JSON file...\n";
-        // Reset line count
-        size_t lineCount = 0;
+[[maybe_unused]] bool JoSon::Utils::parse_sax(std::string_view input,
+                                              Handler& handler, bool show_bar) {
+    return parse_to_events(input, handler, show_bar);
+}
 
-        Viso::ProgressBar progressBar(reinterpret_cast<std::atomic<size_t> *const>(&lineCount),
-                                      reinterpret_cast<const std::atomic<size_t> *>(&totalLines));
+[[maybe_unused]] bool JoSon::Utils::parse_sax(std::string_view input, Handler& handler,
+                                              Observer& observer) {
+    return parse_to_events(input, handler, &observer);
+}
 
-        while (std::getline(jsonFile, line)) {
-            jsonStr += line;
-            ++lineCount;
+[[maybe_unused]] bool JoSon::Utils::stream_json_file(const std::string& file_path,
+                                                     Handler& handler,
+                                                     size_t chunk_size) {
+    std::FILE* file = std::fopen(file_path.c_str(), "rb");
+    if (!file) {
+        std::cerr << "Error: Unable to open JSON file." << std::endl;
+        return false;
+    }
+    std::unique_ptr<char[]> buffer(new char[chunk_size > 0 ? chunk_size : 1]);
+    StreamParser parser(handler);
+    bool ok = true;
+    size_t got;
+    while (ok && (got = std::fread(buffer.get(), 1, chunk_size, file)) > 0) {
+        ok = parser.feed({buffer.get(), got});
+    }
+    std::fclose(file);
+    return parser.finish() && ok;
+}
 
-            progressBar.update();
-        }
-        jsonFile.close();
-    } else {
-        while (std::getline(jsonFile, line)) {
-            jsonStr += line;
-        }
-        jsonFile.close();
+[[nodiscard]] [[maybe_unused]] std::vector<JoSon::Doc>
+JoSon::Utils::parse_json_lines(std::string_view input, size_t threads) {
+    return parse_all_lines(input, threads);
+}
+
+[[maybe_unused]] size_t
+JoSon::Utils::parse_json_lines(std::string_view input,
+                               const std::function<void(size_t, Doc&)>& callback,
+                               size_t threads) {
+    return parse_lines_in_batches(input, callback, threads);
+}
+
+[[nodiscard]] [[maybe_unused]] std::vector<JoSon::Doc>
+JoSon::Utils::read_json_lines(const std::string& file_path, size_t threads) {
+    MappedFile file(file_path);
+    if (!file.is_open()) {
+        std::cerr << "Error: Unable to open JSON file." << std::endl;
+        return {};
     }
+    return parse_all_lines(file.view(), threads);
+}
+
+[[maybe_unused]] size_t
+JoSon::Utils::read_json_lines(const std::string& file_path,
+                              const std::function<void(size_t, Doc&)>& callback,
+                              size_t threads) {
+    MappedFile file(file_path);
+    if (!file.is_open()) {
+        std::cerr << "Error: Unable to open JSON file." << std::endl;
+        return 0;
+    }
+    return parse_lines_in_batches(file.view(), callback, threads);
+}
+
+[[maybe_unused]] std::string JoSon::Utils::unescape_json_string(std::string_view raw) {
+    std::string text;
+    Text::unescape(raw, text);
+    return text;
+}
+
+[[maybe_unused]] std::string JoSon::Utils::escape_json_string(std::string_view text) {
+    std::string escaped;
+    Text::escape(text, escaped);
+    return escaped;
+}
 
-    // Convert JSON string to Doc
-    return string_to_doc(jsonStr, show_bar);
+/**
+ * @brief Storage a Parser keeps from one document to the next.
+ */
+struct JoSon::Parser::State {
+    Scan::Indexer indexer; ///< Structural index, keeping its window storage.
+    TreeBuilder builder;   ///< Builder, keeping its stack of open containers.
+    Syntax syntax;         ///< Syntax calling builder, keeping its nesting stack.
+    std::string buffer;    ///< Contents of the last file read.
+    Arena* arena;          ///< Arena of the documents, or nullptr.
+    KeyPool* keys;         ///< Pool of the keys, or nullptr.
+
+    State(Arena* arena, KeyPool* keys)
+            : indexer({}), builder(arena, false, keys), syntax(builder), arena(arena),
+              keys(keys) {}
+
+    /**
+     * @brief Parses a document with the retained storage.
+     *
+     * @param input The JSON-formatted string.
+     * @param borrow Whether keys and strings are views of input.
+     * @return The parsed document.
+     */
+    Doc parse(std::string_view input, bool borrow) {
+        (void)builder.reset(arena, borrow, keys);
+        syntax.reset();
+        NoReport report;
+        parse_events(input, syntax, report, indexer);
+        return builder.reset(arena, borrow, keys);
+    }
+};
+
+JoSon::Parser::Parser(Arena* arena, KeyPool* keys)
+        : state(std::make_unique<State>(arena, keys)) {}
+
+JoSon::Parser::Parser(Parser&& other) noexcept = default;
+
+JoSon::Parser& JoSon::Parser::operator=(Parser&& other) noexcept = default;
+
+JoSon::Parser::~Parser() = default;
+
+[[maybe_unused]] void JoSon::Parser::set_arena(Arena* arena) { state->arena = arena; }
+
+[[maybe_unused]] void JoSon::Parser::set_keys(KeyPool* keys) { state->keys = keys; }
+
+JoSon::Doc JoSon::Parser::parse(std::string_view input) { return state->parse(input, false); }
+
+[[maybe_unused]] JoSon::Doc JoSon::Parser::parse_view(std::string_view input) {
+    return state->parse(input, true);
+}
+
+[[maybe_unused]] JoSon::Doc JoSon::Parser::parse_file(const std::string& file_path) {
+    std::FILE* file = std::fopen(file_path.c_str(), "rb");
+    if (!file) {
+        std::cerr << "Error: Unable to open JSON file." << std::endl;
+        return Doc(Type::Nullptr);
+    }
+    std::string& buffer = state->buffer;
+    buffer.clear();
+    const long size = std::fseek(file, 0, SEEK_END) == 0 ? std::ftell(file) : -1;
+    std::rewind(file);
+    size_t want = size > 0 ? static_cast<size_t>(size) : 4096;
+    size_t got;
+    do {
+        // Grows within the capacity kept from the previous files
+        const size_t used = buffer.size();
+        buffer.resize(used + want);
+        got = std::fread(&buffer[used], 1, want, file);
+        buffer.resize(used + got);
+        want = 4096; // Until the end of a file that is growing or not seekable
+    } while (got > 0);
+    std::fclose(file);
+    return state->parse(buffer, false);
 }
+// Files are read rather than mapped: for small files, a read is cheaper than
+// setting up and tearing down a mapping.
@@ -0,0 +1,31 @@
+// KeyPool.cpp
+#include "../include/JoSon/KeyPool.h"
+#include <functional>
+
+std::string_view JoSon::KeyPool::intern(std::string_view key) {
+    size_t hash = std::hash<std::string_view>()(key);
+    Shard& shard = shards[(hash >> 7) & (shard_count - 1)];
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto it = shard.keys.find(key);
+    if (it != shard.keys.end()) {
+        return *it;
+    }
+    std::string_view copy = shard.chars.copy_str(key);
+    shard.keys.insert(copy);
+    return copy;
+}
+// Looks the key up in its shard, copying it into the shard on first use.
+
+[[maybe_unused]] size_t JoSon::KeyPool::size() {
+    size_t total = 0;
+    for (auto& shard : shards) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        total += shard.keys.size();
+    }
+    return total;
+}
+
+JoSon::KeyPool& JoSon::KeyPool::global() {
+    static auto* pool = new KeyPool(); // Leaked: keys must outlive static documents
+    return *pool;
+}
@@ -0,0 +1,307 @@
+// LazyDoc.cpp
+#include "../include/JoSon/LazyDoc.h"
+#include "../include/JoSon/Sax.h"
+#include "Scan.h"
+#include <algorithm>
+#include <stdexcept>
+
+JoSon::LazyDoc::LazyDoc(std::string_view text) : at(0) {
+    if (text.size() > UINT32_MAX) {
+        throw std::runtime_error("Error: LazyDoc input must be smaller than 4 GiB.");
+    }
+    auto built = std::make_shared<Index>();
+    built->text = text;
+    Scan::BlockState state;
+    Scan::index_structurals(text, built->pos, state);
+
+    // Pair the brackets; unclosed ones run to the end of the text
+    const auto end = static_cast<uint32_t>(built->pos.size());
+    built->closing.assign(built->pos.size(), end);
+    std::vector<uint32_t> open;
+    for (uint32_t i = 0; i < end; ++i) {
+        const char c = text[built->pos[i]];
+        if (c == '"') {
+            ++i; // The closing quote is always the next structural
+        } else if (c == '{' || c == '[') {
+            open.push_back(i);
+        } else if ((c == '}' || c == ']') && !open.empty()) {
+            built->closing[open.back()] = i;
+            open.pop_back();
+        }
+    }
+    index = std::move(built);
+}
+// Constructor indexes the structurals and matches the brackets once.
+
+JoSon::LazyDoc::LazyDoc(std::shared_ptr<const Index> index, size_t at)
+        : index(std::move(index)), at(at) {}
+// Constructor of a view shares the index.
+
+char JoSon::LazyDoc::char_at(size_t entry) const {
+    return entry < index->pos.size() ? index->text[index->pos[entry]] : ']';
+}
+// Past the end reads as a closing bracket, ending any walk.
+
+size_t JoSon::LazyDoc::skip(size_t entry) const {
+    const char c = char_at(entry);
+    if (c == '{' || c == '[') {
+        return std::min<size_t>(index->closing[entry] + 1, index->pos.size());
+    } else if (c == '"') {
+        return std::min(entry + 2, index->pos.size());
+    } else if (c == ',' || c == '}' || c == ']') {
+        return entry; // Missing value
+    }
+    return entry + 1;
+}
+// Containers are jumped over through their matching bracket.
+
+size_t JoSon::LazyDoc::member(std::string_view key) const {
+    if (char_at(at) != '{') {
+        throw std::runtime_error("Error: Key-Value pair only available for Dict "
+                                 "(DictObj).");
+    }
+    const std::string_view text = index->text;
+    const size_t end = index->pos.size();
+    size_t entry = at + 1;
+    while (entry < end) {
+        const char c = char_at(entry);
+        if (c == '}' || c == ']') {
+            break;
+        } else if (c == ',') {
+            ++entry;
+            continue;
+        }
+        std::string_view name;
+        if (c == '"') {
+            name = text.substr(index->pos[entry] + 1,
+                               char_at(entry + 1) == '"' ? index->pos[entry + 1] - index->pos[entry] - 1
+                                                         : std::string_view::npos);
+            entry += 2;
+        } else {
+            // Unquoted key, read up to the colon
+            size_t begin = index->pos[entry];
+            size_t right = entry + 1 < end ? index->pos[entry + 1] : text.size();
+            while (right > begin && (text[right - 1] == ' ' || text[right - 1] == '\n' ||
+                                     text[right - 1] == '\t' || text[right - 1] == '\r')) {
+                --right;
+            }
+            name = text.substr(begin, right - begin);
+            entry += 1;
+        }
+        if (char_at(entry) == ':') {
+            ++entry;
+        }
+        if (name == key) {
+            return entry;
+        }
+        entry = skip(entry);
+    }
+    return end;
+}
+// Walks the members, skipping the values of the other keys.
+
+JoSon::Type JoSon::LazyDoc::get_type() const {
+    switch (char_at(at)) {
+        case '{':
+            return Type::Dict;
+        case '[':
+            return Type::Array;
+        case '"':
+            return Type::Str;
+        case ',':
+        case ':':
+        case '}':
+        case ']':
+            return Type::Nullptr;
+        default:
+            return to_doc().get_type(); // Read the bare token
+    }
+}
+
+size_t JoSon::LazyDoc::size() const {
+    const char c = char_at(at);
+    if (c != '{' && c != '[') {
+        return 1;
+    }
+    size_t count = 0;
+    size_t entry = at + 1;
+    const size_t end = std::min<size_t>(index->closing[at], index->pos.size());
+    while (entry < end) {
+        if (char_at(entry) == ',') {
+            ++entry;
+            continue;
+        }
+        ++count;
+        if (c == '{') {
+            // Key, colon and value
+            entry = skip(entry);
+            if (char_at(entry) == ':') {
+                ++entry;
+            }
+        }
+        entry = skip(entry);
+        if (char_at(entry) != ',') {
+            break;
+        }
+    }
+    return count;
+}
+// Counts the members by walking them.
+
+size_t JoSon::LazyDoc::count(std::string_view key) const {
+    return member(key) != index->pos.size() ? 1 : 0;
+}
+
+JoSon::LazyDoc JoSon::LazyDoc::operator[](std::string_view key) const {
+    size_t entry = member(key);
+    if (entry == index->pos.size()) {
+        throw std::out_of_range("Error: Key not found.");
+    }
+    return {index, entry};
+}
+
+size_t JoSon::LazyDoc::element(size_t i) const {
+    size_t entry = at + 1;
+    while (true) {
+        const char c = char_at(entry);
+        if (c == ']' || c == '}') {
+            return index->pos.size();
+        } else if (c == ',') {
+            ++entry;
+            continue;
+        }
+        if (i-- == 0) {
+            return entry;
+        }
+        entry = skip(entry);
+    }
+}
+// Walks the elements, skipping the ones before index.
+
+JoSon::LazyDoc JoSon::LazyDoc::operator()(size_t i) const {
+    if (char_at(at) != '[') {
+        throw std::runtime_error("Error: Operator () only available for "
+                                 "Type::Array.");
+    }
+    size_t entry = element(i);
+    if (entry == index->pos.size()) {
+        throw std::out_of_range("Error: Index out of bounds.");
+    }
+    return {index, entry};
+}
+
+bool JoSon::LazyDoc::find(std::string_view key, LazyDoc& value) const {
+    if (char_at(at) != '{') {
+        return false;
+    }
+    size_t entry = member(key);
+    if (entry == index->pos.size()) {
+        return false;
+    }
+    value = LazyDoc(index, entry);
+    return true;
+}
+
+bool JoSon::LazyDoc::find(size_t i, LazyDoc& value) const {
+    if (char_at(at) != '[') {
+        return false;
+    }
+    size_t entry = element(i);
+    if (entry == index->pos.size()) {
+        return false;
+    }
+    value = LazyDoc(index, entry);
+    return true;
+}
+
+std::vector<JoSon::LazyDoc> JoSon::LazyDoc::children() const {
+    std::vector<LazyDoc> values;
+    const char c = char_at(at);
+    if (c != '{' && c != '[') {
+        return values;
+    }
+    size_t entry = at + 1;
+    while (true) {
+        const char next = char_at(entry);
+        if (next == '}' || next == ']') {
+            break;
+        } else if (next == ',') {
+            ++entry;
+            continue;
+        }
+        if (c == '{') {
+            // Skip the key and the colon
+            entry = skip(entry);
+            if (char_at(entry) == ':') {
+                ++entry;
+            }
+        }
+        values.push_back(LazyDoc(index, entry));
+        entry = skip(entry);
+    }
+    return values;
+}
+// Walks the container once, keeping a view of every value.
+
+JoSon::Doc JoSon::LazyDoc::to_doc() const {
+    const std::string_view text = index->text;
+    const char first = char_at(at);
+    if (first == ',' || first == ':' || first == '}' || first == ']') {
+        return Doc(Type::Nullptr);
+    }
+    TreeBuilder builder;
+    Syntax syntax(builder);
+    if (first != '{' && first != '[' && first != '"') {
+        syntax.bare(raw()); // Cut at the end of the token, whatever encloses it
+        return builder.result();
+    }
+    const size_t end = skip(at);
+    for (size_t entry = at; entry < end; ++entry) {
+        const size_t pos = index->pos[entry];
+        const char c = text[pos];
+        if (c == '{' || c == '[') {
+            syntax.open(c == '{');
+        } else if (c == '}' || c == ']') {
+            syntax.close();
+        } else if (c == ':') {
+            syntax.colon();
+        } else if (c == ',') {
+            syntax.comma();
+        } else if (c == '"') {
+            if (++entry == index->pos.size()) {
+                break; // Unterminated string
+            }
+            syntax.string(text.substr(pos + 1, index->pos[entry] - pos - 1));
+        } else {
+            // Primitive types and unquoted keys
+            syntax.bare(text.substr(pos));
+        }
+    }
+    return builder.result();
+}
+// Replays the indexed structurals of the value into a tree builder.
+
+[[maybe_unused]] std::string_view JoSon::LazyDoc::get_str_view() const {
+    if (char_at(at) != '"') {
+        throw std::runtime_error("Error: LazyDoc read as a string is not a string.");
+    }
+    const size_t begin = index->pos[at] + 1;
+    const size_t close = at + 1 < index->pos.size() ? index->pos[at + 1] : index->text.size();
+    return index->text.substr(begin, close - begin);
+}
+
+[[maybe_unused]] std::string_view JoSon::LazyDoc::raw() const {
+    const std::string_view text = index->text;
+    const char c = char_at(at);
+    if (c == ',' || c == ':' || c == '}' || c == ']') {
+        return {};
+    }
+    const size_t begin = index->pos[at];
+    if (c == '{' || c == '[' || c == '"') {
+        size_t last = skip(at) - 1;
+        return text.substr(begin, last > at || c != '"' ? index->pos[last] + 1 - begin
+                                                         : std::string_view::npos);
+    }
+    size_t right = text.find_first_of(" \t\n\r,}]", begin);
+    return text.substr(begin, right == std::string_view::npos ? right : right - begin);
+}
@@ -0,0 +1,169 @@
+// MappedFile.cpp
+#include "../include/JoSon/MappedFile.h"
+#include <algorithm>
+#include <cstdio>
+#include <utility>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+JoSon::MappedFile::MappedFile()
+        : ptr(nullptr), len(0), mapped(false), opened(false)
+#ifdef _WIN32
+        , map_handle(nullptr)
+#endif
+{}
+// Default constructor leaves the instance with no file open.
+
+JoSon::MappedFile::MappedFile(const std::string& path) : MappedFile() {
+    open(path);
+}
+// Constructor opens the file at path.
+
+JoSon::MappedFile::MappedFile(MappedFile&& other) noexcept : MappedFile() {
+    *this = std::move(other);
+}
+// Move constructor takes the file of other.
+
+JoSon::MappedFile& JoSon::MappedFile::operator=(MappedFile&& other) noexcept {
+    if (this != &other) {
+        close();
+        ptr = std::exchange(other.ptr, nullptr);
+        len = std::exchange(other.len, 0);
+        mapped = std::exchange(other.mapped, false);
+        opened = std::exchange(other.opened, false);
+        buffer = std::move(other.buffer);
+#ifdef _WIN32
+        map_handle = std::exchange(other.map_handle, nullptr);
+#endif
+    }
+    return *this;
+}
+// Move assignment closes the current file and takes the file of other.
+
+JoSon::MappedFile::~MappedFile() { close(); }
+// Destructor unmaps or frees the content.
+
+bool JoSon::MappedFile::read_fallback(const std::string& path) {
+    std::FILE* file = std::fopen(path.c_str(), "rb");
+    if (file == nullptr) {
+        return false;
+    }
+    size_t cap = 0;
+    if (std::fseek(file, 0, SEEK_END) == 0) {
+        long end = std::ftell(file);
+        cap = end > 0 ? static_cast<size_t>(end) : 0;
+        std::fseek(file, 0, SEEK_SET);
+    }
+    if (cap == 0) {
+        cap = 64 * 1024; // Size unknown, grow as needed
+    }
+    buffer.reset(new char[cap]);
+    len = 0;
+    size_t got;
+    while ((got = std::fread(buffer.get() + len, 1, cap - len, file)) > 0) {
+        len += got;
+        if (len == cap) {
+            std::unique_ptr<char[]> bigger(new char[cap * 2]);
+            std::copy(buffer.get(), buffer.get() + len, bigger.get());
+            buffer = std::move(bigger);
+            cap *= 2;
+        }
+    }
+    bool ok = std::ferror(file) == 0;
+    std::fclose(file);
+    ptr = buffer.get();
+    return ok;
+}
+// Reads the file with one sized read, growing only if its size was unknown.
+
+bool JoSon::MappedFile::open(const std::string& path) {
+    close();
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                              OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file != INVALID_HANDLE_VALUE) {
+        LARGE_INTEGER file_size;
+        if (GetFileSizeEx(file, &file_size) && file_size.QuadPart > 0) {
+            HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            if (mapping != nullptr) {
+                void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+                if (view != nullptr) {
+                    CloseHandle(file);
+                    map_handle = mapping;
+                    ptr = static_cast<const char*>(view);
+                    len = static_cast<size_t>(file_size.QuadPart);
+                    mapped = opened = true;
+                    return true;
+                }
+                CloseHandle(mapping);
+            }
+        }
+        CloseHandle(file);
+    }
+#else
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat info {};
+    if (fstat(fd, &info) == 0 && S_ISREG(info.st_mode) && info.st_size > 0) {
+        void* view = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ,
+                          MAP_PRIVATE, fd, 0);
+        if (view != MAP_FAILED) {
+            ::close(fd); // The mapping stays valid without the descriptor
+#ifdef MADV_SEQUENTIAL
+            madvise(view, static_cast<size_t>(info.st_size), MADV_SEQUENTIAL);
+#endif
+            ptr = static_cast<const char*>(view);
+            len = static_cast<size_t>(info.st_size);
+            mapped = opened = true;
+            return true;
+        }
+    }
+    ::close(fd);
+#endif
+    // Empty, special or unmappable file: read it instead
+    opened = read_fallback(path);
+    if (!opened) {
+        close();
+    }
+    return opened;
+}
+// Maps the file, falling back to a sized read.
+
+void JoSon::MappedFile::close() {
+    if (mapped) {
+#ifdef _WIN32
+        UnmapViewOfFile(ptr);
+        CloseHandle(map_handle);
+        map_handle = nullptr;
+#else
+        munmap(const_cast<char*>(ptr), len);
+#endif
+    }
+    buffer.reset();
+    ptr = nullptr;
+    len = 0;
+    mapped = opened = false;
+}
+// Unmaps the file or frees the fallback buffer.
+
+bool JoSon::MappedFile::is_open() const { return opened; }
+
+[[maybe_unused]] bool JoSon::MappedFile::is_mapped() const { return mapped; }
+
+const char* JoSon::MappedFile::data() const { return ptr; }
+
+size_t JoSon::MappedFile::size() const { return len; }
+
+std::string_view JoSon::MappedFile::view() const { return {ptr, len}; }
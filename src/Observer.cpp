@@ -0,0 +1,40 @@
+// Observer.cpp
+#include "../include/JoSon/Observer.h"
+#include <iostream>
+
+void JoSon::StatsObserver::on_end(Phase phase, const Stats& stats) {
+    (phase == Phase::Parse ? parse : serialize) = stats;
+}
+// Keeps the counters of the phase that ended.
+
+JoSon::ProgressObserver::ProgressObserver()
+        : Observer(SIZE_MAX), done(0), total(0), bar(&done, &total) {}
+// Constructor starts with an empty bar, resized by on_begin().
+
+void JoSon::ProgressObserver::on_begin(Phase phase, size_t total_bytes) {
+    if (phase != Phase::Parse) {
+        return;
+    }
+    std::cout << "\nParsing..." << '\n';
+    done = 0;
+    total = total_bytes > 0 ? total_bytes : 1;
+    interval = total_bytes / 100 > 0 ? total_bytes / 100 : 1; // One redraw per percent
+}
+
+void JoSon::ProgressObserver::on_progress(Phase phase, size_t done_bytes,
+                                          [[maybe_unused]] size_t total_bytes) {
+    if (phase == Phase::Parse) {
+        done = done_bytes;
+        bar.update();
+    }
+}
+
+void JoSon::ProgressObserver::on_end(Phase phase, [[maybe_unused]] const Stats& stats) {
+    if (phase != Phase::Parse) {
+        return;
+    }
+    done = total.load();
+    bar.update();
+    std::cout << "\nProgress Finished.\n";
+}
+// Completes the bar, as the parse may stop before the last interval.
@@ -0,0 +1,490 @@
+// Patch.cpp
+#include "../include/JoSon/Joson.h"
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+    bool is_integer(JoSon::Type type) {
+        return type == JoSon::Type::Char || type == JoSon::Type::Int || type == JoSon::Type::LLong;
+    }
+
+    bool is_number(JoSon::Type type) {
+        return is_integer(type) || type == JoSon::Type::Float || type == JoSon::Type::Double ||
+               type == JoSon::Type::LDouble;
+    }
+
+    long long integer_of(const JoSon::Doc& doc) {
+        switch (doc.get_type()) {
+            case JoSon::Type::Char:
+                return doc.get_char();
+            case JoSon::Type::Int:
+                return doc.get_int();
+            default:
+                return doc.get_l_long();
+        }
+    }
+
+    long double number_of(const JoSon::Doc& doc) {
+        switch (doc.get_type()) {
+            case JoSon::Type::Float:
+                return doc.get_float();
+            case JoSon::Type::Double:
+                return doc.get_double();
+            case JoSon::Type::LDouble:
+                return doc.get_long_double();
+            default:
+                return static_cast<long double>(integer_of(doc));
+        }
+    }
+
+    /**
+     * @brief Compares two numbers by value, whatever their Type (RFC 6902,
+     * section 4.6).
+     */
+    bool same_number(const JoSon::Doc& a, const JoSon::Doc& b) {
+        if (is_integer(a.get_type()) && is_integer(b.get_type())) {
+            return integer_of(a) == integer_of(b);
+        }
+        const long double x = number_of(a);
+        const long double y = number_of(b);
+        return x == y || (x != x && y != y);
+    }
+    // Integers compare exactly; long double holds every long long exactly where it is wider.
+
+    /**
+     * @brief Compares two numbers, or two documents of the same primitive type.
+     */
+    bool same_value(const JoSon::Doc& a, const JoSon::Doc& b) {
+        if (is_number(a.get_type())) {
+            return same_number(a, b);
+        }
+        switch (a.get_type()) {
+            case JoSon::Type::Bool:
+                return a.get_bool() == b.get_bool();
+            case JoSon::Type::Str:
+                return a.get_str_view() == b.get_str_view();
+            default:
+                return true; // Nullptr
+        }
+    }
+    // NaN equals NaN, so that diffing a document with itself finds nothing.
+
+    /**
+     * @brief Appends a JSON Pointer token to a path, escaping '~' and '/'.
+     */
+    void append_token(std::string& path, std::string_view token) {
+        path.push_back('/');
+        for (char c : token) {
+            if (c == '~') {
+                path.append("~0");
+            } else if (c == '/') {
+                path.append("~1");
+            } else {
+                path.push_back(c);
+            }
+        }
+    }
+
+    void append_index(std::string& path, size_t index) {
+        path.push_back('/');
+        path.append(std::to_string(index));
+    }
+
+    /**
+     * @brief A pair of containers of the same type still to diff.
+     */
+    struct Pending {
+        const JoSon::Doc* from; ///< The container in the old document.
+        const JoSon::Doc* to;   ///< The container in the new document.
+        std::string path;       ///< JSON Pointer to both.
+    };
+
+    /**
+     * @brief Builds the operations of a diff.
+     */
+    struct Differ {
+        JoSon::Doc ops{JoSon::Type::Array}; ///< The patch.
+        std::vector<Pending> pending;       ///< Containers still to diff.
+        std::vector<Pending> children;      ///< Containers found in the current one, in order.
+
+        void emit(std::string_view op, const std::string& path, const JoSon::Doc* value) {
+            JoSon::Doc entry(JoSon::Type::Dict);
+            entry.upsert("op", JoSon::Doc(op));
+            entry.upsert("path", JoSon::Doc(path));
+            if (value) {
+                entry.upsert("value", *value); // Shares the containers of the new document
+            }
+            ops.emplace_back(std::move(entry));
+        }
+
+        /**
+         * @brief Diffs two values at a path, deferring containers of the same
+         * type to the pending list.
+         */
+        void compare(const JoSon::Doc& from, const JoSon::Doc& to, std::string&& path) {
+            const JoSon::Type type = from.get_type();
+            if (type == to.get_type() && (type == JoSon::Type::Dict || type == JoSon::Type::Array)) {
+                const bool shared = type == JoSon::Type::Dict ? &from.get_dict_obj() == &to.get_dict_obj()
+                                                              : &from.get_arr() == &to.get_arr();
+                if (!shared) {
+                    children.push_back({&from, &to, std::move(path)});
+                }
+            } else if (!JoSon::Utils::docs_equal(from, to)) {
+                emit("replace", path, &to);
+            }
+        }
+
+        void diff_dicts(const Pending& item) {
+            const auto& from = static_cast<const JoSon::DictObj&>(item.from->get_dict_obj());
+            const auto& to = static_cast<const JoSon::DictObj&>(item.to->get_dict_obj());
+            for (const auto& [key, value] : from) {
+                std::string path = item.path;
+                append_token(path, key);
+                auto it = to.find(key);
+                if (it == to.cend()) {
+                    emit("remove", path, nullptr);
+                } else {
+                    compare(value, it->second, std::move(path));
+                }
+            }
+            for (const auto& [key, value] : to) {
+                if (from.count(key) == 0) {
+                    std::string path = item.path;
+                    append_token(path, key);
+                    emit("add", path, &value);
+                }
+            }
+        }
+
+        void diff_arrays(const Pending& item) {
+            const JoSon::DocArr& from = item.from->get_arr();
+            const JoSon::DocArr& to = item.to->get_arr();
+            const size_t n = from.size();
+            const size_t m = to.size();
+            const size_t common = n < m ? n : m;
+            size_t suffix = 0;
+            if (n != m) {
+                // Elements inserted or removed in the middle leave the tail shifted, not changed
+                while (suffix < common && JoSon::Utils::docs_equal(from[n - 1 - suffix], to[m - 1 - suffix])) {
+                    ++suffix;
+                }
+            }
+            const size_t paired = common - suffix;
+            for (size_t i = 0; i < paired; ++i) {
+                std::string path = item.path;
+                append_index(path, i);
+                compare(from[i], to[i], std::move(path));
+            }
+            std::string path = item.path;
+            append_index(path, paired);
+            for (size_t i = m; i < n; ++i) {
+                emit("remove", path, nullptr); // Each removal brings the next element to the same index
+            }
+            for (size_t i = paired; i < paired + (m - common); ++i) {
+                path = item.path;
+                append_index(path, i);
+                emit("add", path, &to[i]);
+            }
+        }
+        // Operations on the array itself only shift indices past the paired elements.
+
+        JoSon::Doc run(const JoSon::Doc& from, const JoSon::Doc& to) {
+            compare(from, to, std::string());
+            while (!children.empty() || !pending.empty()) {
+                // Children are diffed in document order, depth first
+                pending.insert(pending.end(), std::make_move_iterator(children.rbegin()),
+                               std::make_move_iterator(children.rend()));
+                children.clear();
+                Pending item = std::move(pending.back());
+                pending.pop_back();
+                if (item.from->get_type() == JoSon::Type::Dict) {
+                    diff_dicts(item);
+                } else {
+                    diff_arrays(item);
+                }
+            }
+            return std::move(ops);
+        }
+    }; // struct Differ
+
+    /**
+     * @brief A JSON Pointer that does not resolve, or an operation that does
+     * not apply; apply_patch() adds the index of the operation.
+     */
+    struct Invalid : std::runtime_error {
+        using std::runtime_error::runtime_error;
+    };
+
+    [[noreturn]] void fail(size_t index, const std::string& message) {
+        throw std::runtime_error("Error: JSON Patch operation " + std::to_string(index) + ": " + message + ".");
+    }
+
+    /**
+     * @brief Walks the tokens of a JSON Pointer.
+     */
+    struct Pointer {
+        std::string_view rest; ///< The tokens not read yet, each with its leading '/'.
+        std::string scratch;   ///< Decoded token, when it had escapes.
+
+        explicit Pointer(std::string_view pointer) : rest(pointer) {}
+
+        /**
+         * @brief Reads the next token.
+         *
+         * @param token Receives the decoded token.
+         * @return False if there is no token left.
+         * @throw Invalid if the pointer is malformed.
+         */
+        bool next(std::string_view& token) {
+            if (rest.empty()) {
+                return false;
+            }
+            if (rest[0] != '/') {
+                throw Invalid("a JSON Pointer must start with '/'");
+            }
+            size_t end = rest.find('/', 1);
+            end = end == std::string_view::npos ? rest.size() : end;
+            token = rest.substr(1, end - 1);
+            rest.remove_prefix(end);
+            if (token.find('~') == std::string_view::npos) {
+                return true;
+            }
+            if (!JoSon::Path::decode_token(token, scratch)) {
+                throw Invalid("'~' must be followed by '0' or '1' in a JSON Pointer");
+            }
+            token = scratch;
+            return true;
+        }
+    };
+
+    /**
+     * @brief Gets the child of a container.
+     *
+     * @param writable Whether the child may be modified; tuples are read-only.
+     * @throw Invalid if there is no such child.
+     */
+    JoSon::Doc* child(JoSon::Doc& parent, std::string_view token, bool writable) {
+        switch (parent.get_type()) {
+            case JoSon::Type::Dict: {
+                JoSon::DictObj& dict = parent.get_dict_obj();
+                auto it = dict.find(token);
+                if (it == dict.end()) {
+                    throw Invalid("no member '" + std::string(token) + "'");
+                }
+                return &it->second;
+            }
+            case JoSon::Type::Array: {
+                size_t index;
+                if (!JoSon::Path::read_index(token, index) || index >= parent.size()) {
+                    throw Invalid("no element '" + std::string(token) + "'");
+                }
+                return &parent.get_arr().at(index);
+            }
+            case JoSon::Type::Tuple: {
+                size_t index;
+                if (writable) {
+                    throw Invalid("tuples cannot be modified");
+                } else if (!JoSon::Path::read_index(token, index) || index >= parent.size()) {
+                    throw Invalid("no element '" + std::string(token) + "'");
+                }
+                return const_cast<JoSon::Doc*>(&parent(index)); // Only read
+            }
+            default:
+                throw Invalid("no container at '" + std::string(token) + "'");
+        }
+    }
+
+    /**
+     * @brief Gets the value a JSON Pointer refers to.
+     */
+    JoSon::Doc* locate(JoSon::Doc& root, std::string_view pointer, bool writable) {
+        Pointer walk(pointer);
+        JoSon::Doc* doc = &root;
+        std::string_view token;
+        while (walk.next(token)) {
+            doc = child(*doc, token, writable);
+        }
+        return doc;
+    }
+
+    /**
+     * @brief Gets the container holding the value a JSON Pointer refers to.
+     *
+     * @param last Receives the last token of the pointer, which must not be
+     * the whole document; it may view scratch.
+     */
+    JoSon::Doc* locate_parent(JoSon::Doc& root, std::string_view pointer, std::string& scratch,
+                              std::string_view& last) {
+        const size_t slash = pointer.rfind('/');
+        if (slash == std::string_view::npos) {
+            throw Invalid("a JSON Pointer must start with '/'");
+        }
+        JoSon::Doc* parent = locate(root, pointer.substr(0, slash), true);
+        Pointer walk(pointer.substr(slash));
+        walk.next(last);
+        if (last.data() == walk.scratch.data()) {
+            scratch = std::move(walk.scratch);
+            last = scratch;
+        }
+        return parent;
+    }
+
+    void add(JoSon::Doc& root, std::string_view path, JoSon::Doc&& value) {
+        if (path.empty()) {
+            root = std::move(value);
+            return;
+        }
+        std::string scratch;
+        std::string_view last;
+        JoSon::Doc* parent = locate_parent(root, path, scratch, last);
+        if (parent->get_type() == JoSon::Type::Dict) {
+            parent->get_dict_obj()[last] = std::move(value); // A new key is copied out of the patch
+        } else if (parent->get_type() == JoSon::Type::Array) {
+            size_t index;
+            if (last == "-") {
+                parent->get_arr().emplace_back(std::move(value));
+            } else if (!JoSon::Path::read_index(last, index) || !parent->get_arr().insert(index, std::move(value))) {
+                throw Invalid("no position '" + std::string(last) + "' to add at");
+            }
+        } else {
+            throw Invalid("cannot add to '" + std::string(path.substr(0, path.rfind('/'))) + "'");
+        }
+    }
+
+    JoSon::Doc remove(JoSon::Doc& root, std::string_view path) {
+        if (path.empty()) {
+            return std::move(root); // Leaves a null document
+        }
+        std::string scratch;
+        std::string_view last;
+        JoSon::Doc* parent = locate_parent(root, path, scratch, last);
+        JoSon::Doc value = std::move(*child(*parent, last, true));
+        size_t index;
+        if (parent->get_type() == JoSon::Type::Dict) {
+            parent->get_dict_obj().erase(last);
+        } else if (JoSon::Path::read_index(last, index)) { // Checked by child()
+            parent->get_arr().erase(index);
+        }
+        return value;
+    }
+
+    /**
+     * @brief Gets a member of an operation.
+     */
+    const JoSon::Doc& member(const JoSon::Doc& op, std::string_view key, size_t index) {
+        const JoSon::Doc* value = op.find(key);
+        if (!value) {
+            fail(index, "missing '" + std::string(key) + "'");
+        }
+        return *value;
+    }
+
+    std::string_view string_member(const JoSon::Doc& op, std::string_view key, size_t index) {
+        const JoSon::Doc& value = member(op, key, index);
+        if (value.get_type() != JoSon::Type::Str) {
+            fail(index, "'" + std::string(key) + "' must be a string");
+        }
+        return value.get_str_view();
+    }
+} // namespace
+
+bool JoSon::Utils::docs_equal(const Doc& a, const Doc& b) {
+    std::vector<std::pair<const Doc*, const Doc*>> pending{{&a, &b}};
+    while (!pending.empty()) {
+        auto [x, y] = pending.back();
+        pending.pop_back();
+        if (x->get_type() != y->get_type() && !(is_number(x->get_type()) && is_number(y->get_type()))) {
+            return false;
+        }
+        switch (x->get_type()) {
+            case Type::Dict: {
+                const auto& dx = static_cast<const DictObj&>(x->get_dict_obj());
+                const auto& dy = static_cast<const DictObj&>(y->get_dict_obj());
+                if (&dx == &dy) {
+                    break;
+                } else if (dx.size() != dy.size()) {
+                    return false;
+                }
+                for (const auto& [key, value] : dx) {
+                    auto it = dy.find(key);
+                    if (it == dy.cend()) {
+                        return false;
+                    }
+                    pending.emplace_back(&value, &it->second);
+                }
+                break;
+            }
+            case Type::Array:
+            case Type::Tuple:
+                if (x->get_type() == Type::Array && &x->get_arr() == &y->get_arr()) {
+                    break;
+                } else if (x->size() != y->size()) {
+                    return false;
+                }
+                for (size_t i = 0; i < x->size(); ++i) {
+                    pending.emplace_back(&(*x)(i), &(*y)(i));
+                }
+                break;
+            default:
+                if (!same_value(*x, *y)) {
+                    return false;
+                }
+        }
+    }
+    return true;
+}
+// Shared containers are equal without being read, and members are matched by key, whatever their order.
+
+JoSon::Doc JoSon::Utils::diff(const Doc& from, const Doc& to) {
+    return Differ().run(from, to);
+}
+
+void JoSon::Utils::apply_patch(Doc& doc, const Doc& patch) {
+    if (patch.get_type() != Type::Array) {
+        throw std::runtime_error("Error: A JSON Patch must be an arraylist of operations.");
+    }
+    const DocArr& ops = patch.get_arr();
+    for (size_t i = 0; i < ops.size(); ++i) {
+        const Doc& op = ops[i];
+        if (op.get_type() != Type::Dict) {
+            fail(i, "must be a dictionary object");
+        }
+        const std::string_view name = string_member(op, "op", i);
+        const std::string_view path = string_member(op, "path", i);
+        try {
+            if (name == "add") {
+                add(doc, path, member(op, "value", i).clone());
+            } else if (name == "remove") {
+                if (path.empty()) {
+                    fail(i, "cannot remove the whole document");
+                }
+                remove(doc, path);
+            } else if (name == "replace") {
+                *locate(doc, path, true) = member(op, "value", i).clone();
+            } else if (name == "move") {
+                const std::string_view from = string_member(op, "from", i);
+                if (from == path) {
+                    continue;
+                } else if (path.size() > from.size() && path.compare(0, from.size(), from) == 0 &&
+                           path[from.size()] == '/') {
+                    fail(i, "cannot move a value into itself");
+                }
+                add(doc, path, remove(doc, from));
+            } else if (name == "copy") {
+                add(doc, path, locate(doc, string_member(op, "from", i), false)->clone());
+            } else if (name == "test") {
+                if (!docs_equal(*locate(doc, path, false), member(op, "value", i))) {
+                    fail(i, "test failed at '" + std::string(path) + "'");
+                }
+            } else {
+                fail(i, "unknown op '" + std::string(name) + "'");
+            }
+        } catch (const Invalid& e) {
+            fail(i, e.what());
+        }
+    }
+}
+// Operations modify the containers of doc in place, and values are cloned from the patch.
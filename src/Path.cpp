@@ -0,0 +1,394 @@
+// Path.cpp
+#include "../include/JoSon/Path.h"
+#include <stdexcept>
+#include <utility>
+
+bool JoSon::Path::decode_token(std::string_view token, std::string& key) {
+    key.clear();
+    key.reserve(token.size());
+    for (size_t i = 0; i < token.size(); ++i) {
+        if (token[i] != '~') {
+            key += token[i];
+        } else if (i + 1 < token.size() && (token[i + 1] == '0' || token[i + 1] == '1')) {
+            key += token[++i] == '0' ? '~' : '/';
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool JoSon::Path::read_index(std::string_view text, size_t& index) {
+    if (text.empty() || text.size() > 18 || (text.size() > 1 && text[0] == '0')) {
+        return false;
+    }
+    index = 0;
+    for (char c : text) {
+        if (c < '0' || c > '9') {
+            return false;
+        }
+        index = index * 10 + static_cast<size_t>(c - '0');
+    }
+    return true;
+}
+// At most 18 digits, so that the index cannot overflow.
+
+JoSon::Path JoSon::Path::from_pointer(std::string_view pointer) {
+    Path path;
+    if (pointer.empty()) {
+        return path;
+    } else if (pointer[0] != '/') {
+        throw std::runtime_error("Error: JSON Pointer must start with '/'.");
+    }
+    size_t begin = 1;
+    while (true) {
+        size_t end = pointer.find('/', begin);
+        std::string_view token = pointer.substr(begin, end == std::string_view::npos ? end : end - begin);
+        Step step{std::string(), 0, Step::Kind::Key};
+        if (!decode_token(token, step.key)) {
+            throw std::runtime_error("Error: JSON Pointer has an invalid '~' escape.");
+        }
+        if (read_index(step.key, step.index)) {
+            step.kind = Step::Kind::KeyOrIndex;
+        }
+        path.steps.push_back(std::move(step));
+        if (end == std::string_view::npos) {
+            return path;
+        }
+        begin = end + 1;
+    }
+}
+// Splits the pointer on '/' and unescapes each token.
+
+JoSon::Path JoSon::Path::from_json_path(std::string_view expression) {
+    auto invalid = [expression]() {
+        return std::runtime_error("Error: Invalid JSONPath expression '" +
+                                  std::string(expression) + "'.");
+    };
+    if (expression.empty() || expression[0] != '$') {
+        throw invalid();
+    }
+    Path path;
+    size_t i = 1;
+    while (i < expression.size()) {
+        Step step{std::string(), 0, Step::Kind::Key};
+        if (expression[i] == '.') {
+            ++i;
+            if (i < expression.size() && expression[i] == '*') {
+                step.kind = Step::Kind::Any;
+                ++i;
+            } else {
+                size_t end = expression.find_first_of(".[", i);
+                end = end == std::string_view::npos ? expression.size() : end;
+                if (end == i) {
+                    throw invalid();
+                }
+                step.key = expression.substr(i, end - i);
+                i = end;
+            }
+        } else if (expression[i] == '[') {
+            ++i;
+            size_t close;
+            if (i < expression.size() && expression[i] == '*') {
+                step.kind = Step::Kind::Any;
+                close = i + 1;
+            } else if (i < expression.size() && (expression[i] == '\'' || expression[i] == '"')) {
+                const char quote = expression[i++];
+                while (i < expression.size() && expression[i] != quote) {
+                    if (expression[i] == '\\' && i + 1 < expression.size()) {
+                        ++i; // An escaped character never ends the key
+                    }
+                    step.key += expression[i++];
+                }
+                close = i + 1;
+            } else {
+                close = expression.find(']', i);
+                if (close == std::string_view::npos ||
+                    !read_index(expression.substr(i, close - i), step.index)) {
+                    throw invalid();
+                }
+                step.kind = Step::Kind::Index;
+            }
+            if (close >= expression.size() || expression[close] != ']') {
+                throw invalid();
+            }
+            i = close + 1;
+        } else {
+            throw invalid();
+        }
+        path.steps.push_back(std::move(step));
+    }
+    return path;
+}
+// Reads the steps one after the other, left to right.
+
+/**
+ * @brief Collects the children of a document matching a step.
+ *
+ * @tparam Step The step type of Path.
+ * @param doc The document.
+ * @param step The step to match.
+ * @param out Receives the matching children, in document order.
+ */
+template <typename Step>
+static void match_step(const JoSon::Doc& doc, const Step& step,
+                       std::vector<const JoSon::Doc*>& out) {
+    using Kind = typename Step::Kind;
+    switch (doc.get_type()) {
+        case JoSon::Type::Dict: {
+            const JoSon::DictObj& dict = doc.get_dict_obj();
+            if (step.kind == Kind::Any) {
+                for (const auto& member : dict) {
+                    out.push_back(&member.second);
+                }
+            } else if (step.kind != Kind::Index) {
+                auto it = dict.find(step.key);
+                if (it != dict.end()) {
+                    out.push_back(&it->second);
+                }
+            }
+            break;
+        }
+        case JoSon::Type::Array: {
+            const JoSon::DocArr& arr = doc.get_arr();
+            if (step.kind == Kind::Any) {
+                for (size_t i = 0; i < arr.size(); ++i) {
+                    out.push_back(&arr[i]);
+                }
+            } else if (step.kind != Kind::Key && step.index < arr.size()) {
+                out.push_back(&arr[step.index]);
+            }
+            break;
+        }
+        case JoSon::Type::Tuple: {
+            const JoSon::DocTuple& tuple = doc.get_tuple();
+            if (step.kind == Kind::Any) {
+                for (size_t i = 0; i < tuple.size(); ++i) {
+                    out.push_back(&tuple[i]);
+                }
+            } else if (step.kind != Kind::Key && step.index < tuple.size()) {
+                out.push_back(&tuple[step.index]);
+            }
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+const JoSon::Doc* JoSon::Path::find(const Doc& doc) const {
+    std::vector<const Doc*> found = select(doc);
+    return found.empty() ? nullptr : found.front();
+}
+
+std::vector<const JoSon::Doc*> JoSon::Path::select(const Doc& doc) const {
+    std::vector<const Doc*> current{&doc};
+    std::vector<const Doc*> next;
+    for (const Step& step : steps) {
+        next.clear();
+        for (const Doc* value : current) {
+            match_step(*value, step, next);
+        }
+        current.swap(next);
+        if (current.empty()) {
+            break;
+        }
+    }
+    return current;
+}
+// Advances the set of matches one step at a time.
+
+bool JoSon::Path::find(const LazyDoc& doc, LazyDoc& value) const {
+    std::vector<LazyDoc> found = select(doc);
+    if (found.empty()) {
+        return false;
+    }
+    value = found.front();
+    return true;
+}
+
+std::vector<JoSon::LazyDoc> JoSon::Path::select(const LazyDoc& doc) const {
+    std::vector<LazyDoc> current{doc};
+    std::vector<LazyDoc> next;
+    for (const Step& step : steps) {
+        next.clear();
+        for (const LazyDoc& value : current) {
+            if (step.kind == Step::Kind::Any) {
+                std::vector<LazyDoc> children = value.children();
+                next.insert(next.end(), children.begin(), children.end());
+                continue;
+            }
+            LazyDoc child = value;
+            if ((step.kind != Step::Kind::Index && value.find(step.key, child)) ||
+                (step.kind != Step::Kind::Key && value.find(step.index, child))) {
+                next.push_back(child);
+            }
+        }
+        current.swap(next);
+        if (current.empty()) {
+            break;
+        }
+    }
+    return current;
+}
+// Same walk as on a Doc, skipping the sub-trees off the path unparsed.
+
+bool JoSon::Path::find(const ImageDoc& doc, ImageDoc& value) const {
+    std::vector<ImageDoc> found = select(doc);
+    if (found.empty()) {
+        return false;
+    }
+    value = found.front();
+    return true;
+}
+
+std::vector<JoSon::ImageDoc> JoSon::Path::select(const ImageDoc& doc) const {
+    std::vector<ImageDoc> current{doc};
+    std::vector<ImageDoc> next;
+    for (const Step& step : steps) {
+        next.clear();
+        for (const ImageDoc& value : current) {
+            if (step.kind == Step::Kind::Any) {
+                std::vector<ImageDoc> children = value.children();
+                next.insert(next.end(), children.begin(), children.end());
+                continue;
+            }
+            ImageDoc child = value;
+            if ((step.kind != Step::Kind::Index && value.find(step.key, child)) ||
+                (step.kind != Step::Kind::Key && value.find(step.index, child))) {
+                next.push_back(child);
+            }
+        }
+        current.swap(next);
+        if (current.empty()) {
+            break;
+        }
+    }
+    return current;
+}
+// Same walk again, with a binary search per key step.
+
+JoSon::PathFilter::PathFilter(Path path, Callback callback)
+        : path(std::move(path)), callback(std::move(callback)), capture(0),
+          key_matches(false) {}
+// Constructor starts outside any container.
+
+bool JoSon::PathFilter::locate(bool& on_path) {
+    const auto& steps = path.get_steps();
+    if (frames.empty()) {
+        on_path = true;
+        return steps.empty();
+    }
+    Frame& parent = frames.back();
+    const size_t depth = frames.size(); // Steps from the root to this value
+    bool component = key_matches;
+    if (!parent.dict) {
+        component = depth <= steps.size() && steps[depth - 1].matches(parent.next);
+        ++parent.next;
+    }
+    on_path = parent.on_path && component && depth <= steps.size();
+    return on_path && depth == steps.size();
+}
+
+bool JoSon::PathFilter::deliver() {
+    Doc match = builder.result();
+    builder = TreeBuilder();
+    return callback(match);
+}
+
+bool JoSon::PathFilter::on_begin_object() {
+    bool on_path;
+    if (capture > 0) {
+        ++capture;
+        return builder.on_begin_object();
+    } else if (locate(on_path)) {
+        capture = 1;
+        return builder.on_begin_object();
+    }
+    frames.push_back({0, true, on_path});
+    return true;
+}
+
+bool JoSon::PathFilter::on_end_object() {
+    if (capture > 0) {
+        builder.on_end_object();
+        return --capture > 0 || deliver();
+    } else if (!frames.empty()) {
+        frames.pop_back();
+    }
+    return true;
+}
+
+bool JoSon::PathFilter::on_begin_array() {
+    bool on_path;
+    if (capture > 0) {
+        ++capture;
+        return builder.on_begin_array();
+    } else if (locate(on_path)) {
+        capture = 1;
+        return builder.on_begin_array();
+    }
+    frames.push_back({0, false, on_path});
+    return true;
+}
+
+bool JoSon::PathFilter::on_end_array() { return on_end_object(); }
+
+bool JoSon::PathFilter::on_key(std::string_view key) {
+    if (capture > 0) {
+        return builder.on_key(key);
+    }
+    const size_t depth = frames.size();
+    const auto& steps = path.get_steps();
+    key_matches = !frames.empty() && frames.back().on_path && depth <= steps.size() &&
+                  steps[depth - 1].matches(key);
+    return true;
+}
+
+bool JoSon::PathFilter::on_string(std::string_view value) {
+    bool on_path;
+    if (capture > 0) {
+        return builder.on_string(value);
+    }
+    if (!locate(on_path)) {
+        return true; // Off the path, nothing is built
+    }
+    builder.on_string(value);
+    return deliver();
+}
+
+bool JoSon::PathFilter::on_number(const Doc& value) {
+    bool on_path;
+    if (capture > 0) {
+        return builder.on_number(value);
+    }
+    if (!locate(on_path)) {
+        return true; // Off the path, nothing is built
+    }
+    builder.on_number(value);
+    return deliver();
+}
+
+bool JoSon::PathFilter::on_bool(bool value) {
+    bool on_path;
+    if (capture > 0) {
+        return builder.on_bool(value);
+    }
+    if (!locate(on_path)) {
+        return true; // Off the path, nothing is built
+    }
+    builder.on_bool(value);
+    return deliver();
+}
+
+bool JoSon::PathFilter::on_null() {
+    bool on_path;
+    if (capture > 0) {
+        return builder.on_null();
+    }
+    if (!locate(on_path)) {
+        return true; // Off the path, nothing is built
+    }
+    builder.on_null();
+    return deliver();
+}
@@ -0,0 +1,80 @@
+// Pool.cpp
+#include "Pool.h"
+
+JoSon::Pool::Pool(size_t threads)
+        : task(nullptr), generation(0), running(0), quit(false) {
+    if (threads == 0) {
+        threads = std::thread::hardware_concurrency();
+    }
+    for (size_t i = 1; i < threads; ++i) {
+        workers.emplace_back(&Pool::loop, this);
+    }
+}
+// Constructor starts threads - 1 workers; the caller is the last thread.
+
+JoSon::Pool::~Pool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        quit = true;
+    }
+    start.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+void JoSon::Pool::loop() {
+    size_t seen = 0;
+    while (true) {
+        const std::function<void()>* fn;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            start.wait(lock, [this, seen] { return quit || generation != seen; });
+            if (quit) {
+                return;
+            }
+            seen = generation;
+            fn = task;
+        }
+        std::exception_ptr failure;
+        try {
+            (*fn)();
+        } catch (...) {
+            failure = std::current_exception();
+        }
+        std::lock_guard<std::mutex> lock(mutex);
+        if (failure && !error) {
+            error = failure;
+        }
+        if (--running == 0) {
+            done.notify_one();
+        }
+    }
+}
+// Each worker runs every task once, then waits for the next round.
+
+void JoSon::Pool::run(const std::function<void()>& fn) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        task = &fn;
+        running = workers.size();
+        error = nullptr;
+        ++generation;
+    }
+    start.notify_all();
+    std::exception_ptr failure;
+    try {
+        fn();
+    } catch (...) {
+        failure = std::current_exception();
+    }
+    std::unique_lock<std::mutex> lock(mutex);
+    done.wait(lock, [this] { return running == 0; });
+    if (!failure) {
+        failure = error;
+    }
+    if (failure) {
+        std::rethrow_exception(failure);
+    }
+}
+// The caller takes part in the round and waits for the workers.
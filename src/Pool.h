@@ -0,0 +1,71 @@
+// Pool.h
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace JoSon {
+    /**
+     * @brief Fixed set of worker threads running one task at a time.
+     *
+     * run() hands the same task to every worker and to the calling thread and
+     * returns once all of them have finished it. Tasks share their work
+     * through an atomic counter, so the pool is only a way to keep threads
+     * alive between rounds (for instance the batches of read_json_lines).
+     */
+    struct Pool {
+    private:
+        std::vector<std::thread> workers;     ///< The threads besides the caller.
+        std::mutex mutex;                     ///< Protects the fields below.
+        std::condition_variable start;        ///< Signals a new task, or shutdown.
+        std::condition_variable done;         ///< Signals the end of a task.
+        const std::function<void()>* task;    ///< Task of the current round.
+        size_t generation;                    ///< Number of rounds started.
+        size_t running;                       ///< Workers still in the current round.
+        bool quit;                            ///< Whether the workers must exit.
+        std::exception_ptr error;             ///< First exception of the round.
+
+        /**
+         * @brief Main loop of a worker thread.
+         */
+        void loop();
+
+    public:
+        /**
+         * @brief Constructor.
+         *
+         * @param threads Number of threads running each task, the caller
+         * included; 0 uses std::thread::hardware_concurrency().
+         */
+        explicit Pool(size_t threads = 0);
+
+        Pool(const Pool&) = delete;
+
+        Pool& operator=(const Pool&) = delete;
+
+        /**
+         * @brief Destructor, joining the workers.
+         */
+        ~Pool();
+
+        /**
+         * @brief Runs a task on every thread of the pool.
+         *
+         * @param fn The task; it is called once per thread, concurrently.
+         * @throw The first exception thrown by fn, once every thread is done.
+         */
+        void run(const std::function<void()>& fn);
+
+        /**
+         * @brief Get the number of threads running each task.
+         *
+         * @return The number of workers plus the calling thread.
+         */
+        [[nodiscard]] size_t size() const { return workers.size() + 1; }
+    }; // struct Pool
+} // namespace JoSon
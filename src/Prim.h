@@ -0,0 +1,333 @@
+// Prim.h
+#pragma once
+
+#include <cfloat>
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+
+#include "../include/JoSon/Arena.h"
+#include "../include/JoSon/Doc.h"
+#include "../include/JoSon/KeyPool.h"
+#include "Text.h"
+
+/**
+ * @brief Construction of primitive Docs and containers from JSON text, shared
+ * by the parsers.
+ */
+namespace JoSon::Prim {
+
+    /**
+     * @brief Constructs an empty arraylist or dictionary object Doc.
+     *
+     * @param type Type::Array or Type::Dict.
+     * @param arena The arena to allocate the container from, or nullptr.
+     * @return An empty container Doc.
+     */
+    inline JoSon::Doc new_container(JoSon::Type type, JoSon::Arena* arena) {
+        return arena ? JoSon::Doc(type, *arena) : JoSon::Doc(type);
+    }
+
+    /**
+     * @brief Decodes the escapes of a JSON string if it has any.
+     *
+     * @param view The characters between the quotes.
+     * @param scratch Buffer receiving the decoded characters, if needed.
+     * @return view itself if it decodes to itself, a view of scratch
+     * otherwise.
+     */
+    inline std::string_view decode_str(std::string_view view, std::string& scratch) {
+        if (JoSon::Text::plain_length(view) == view.size()) {
+            return view; // No escape and no UTF-8 to validate
+        }
+        scratch.clear();
+        JoSon::Text::unescape(view, scratch);
+        if (scratch.size() == view.size() &&
+            std::memcmp(scratch.data(), view.data(), view.size()) == 0) {
+            return view; // Valid UTF-8 and nothing to decode
+        }
+        return scratch;
+    }
+
+    /**
+     * @brief Constructs a string Doc from the contents of a JSON string.
+     *
+     * @param view The characters between the quotes.
+     * @param arena The arena to copy the string into, or nullptr to use new.
+     * @param borrow Whether the Doc is a view of the input instead of a copy.
+     * A string with escapes is copied anyway.
+     * @param scratch Buffer to decode the escapes in.
+     * @return A string Doc.
+     */
+    inline JoSon::Doc new_str(std::string_view view, JoSon::Arena* arena,
+                              bool borrow, std::string& scratch) {
+        std::string_view text = decode_str(view, scratch);
+        if (borrow && text.data() == view.data()) {
+            return JoSon::Doc(text);
+        } else if (arena) {
+            return JoSon::Doc(text, *arena);
+        }
+        return JoSon::Doc(text.data(), text.size()); // Owned copy
+    }
+
+    /**
+     * @brief Decodes a dictionary key, and interns it if there is a pool.
+     *
+     * @param view The characters of the key.
+     * @param keys The pool to intern the key in, or nullptr.
+     * @param borrow Whether the key is a view of the input instead of a copy.
+     * A key with escapes is copied anyway.
+     * @param scratch Buffer to decode the escapes in.
+     * @return A view of the key that outlives the parse, or a view of scratch
+     * that the dictionary object must copy.
+     */
+    inline std::string_view new_key(std::string_view view, JoSon::KeyPool* keys,
+                                    bool borrow, std::string& scratch) {
+        std::string_view text = decode_str(view, scratch);
+        if (borrow && text.data() == view.data()) {
+            return text;
+        } else if (keys) {
+            return keys->intern(text);
+        } else if (text.data() != scratch.data()) {
+            scratch.assign(text); // The input may change before the value is read
+        }
+        return scratch;
+    }
+
+    /**
+     * @brief Checks whether eight bytes are all ASCII digits.
+     *
+     * @param chunk Eight bytes loaded in little-endian order.
+     * @return True if every byte is between '0' and '9'.
+     */
+    inline bool is_eight_digits(uint64_t chunk) {
+        return ((chunk & 0xF0F0F0F0F0F0F0F0ULL) |
+                (((chunk + 0x0606060606060606ULL) & 0xF0F0F0F0F0F0F0F0ULL) >> 4)) ==
+               0x3333333333333333ULL;
+    }
+
+    /**
+     * @brief Converts eight ASCII digits to their value with SWAR arithmetic.
+     *
+     * @param chunk Eight digits loaded in little-endian order.
+     * @return The value of the digits, first digit most significant.
+     */
+    inline uint64_t parse_eight_digits(uint64_t chunk) {
+        const uint64_t mask = 0x000000FF000000FFULL;
+        const uint64_t mul1 = 0x000F424000000064ULL; // 100 + (1000000 << 32)
+        const uint64_t mul2 = 0x0000271000000001ULL; // 1 + (10000 << 32)
+        chunk -= 0x3030303030303030ULL;
+        chunk = (chunk * 10) + (chunk >> 8); // Pairs of digits
+        return (((chunk & mask) * mul1) + (((chunk >> 16) & mask) * mul2)) >> 32;
+    }
+
+    /**
+     * @brief Reads a run of decimal digits into a mantissa.
+     *
+     * Eight digits are consumed at a time while they are available.  The
+     * mantissa wraps once more than 19 digits have been read; callers check the
+     * returned count before trusting it.
+     *
+     * @param input The input string.
+     * @param pos A pointer to the position of the first digit, advanced past the
+     * last one.
+     * @param mantissa The value the digits are appended to.
+     * @return The number of digits read.
+     */
+    inline size_t read_digits(std::string_view input, size_t* pos,
+                              uint64_t& mantissa) {
+        const size_t begin = *pos;
+    #if defined(_WIN32) || (defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+        while (*pos + 8 <= input.size()) {
+            uint64_t chunk;
+            std::memcpy(&chunk, input.data() + *pos, sizeof(chunk));
+            if (!is_eight_digits(chunk)) {
+                break;
+            }
+            mantissa = mantissa * 100000000 + parse_eight_digits(chunk);
+            *pos += 8;
+        }
+    #endif
+        while (*pos < input.size() && input[*pos] >= '0' && input[*pos] <= '9') {
+            mantissa = mantissa * 10 + (input[*pos] - '0');
+            ++(*pos);
+        }
+        return *pos - begin;
+    }
+
+    /**
+     * @brief Converts mantissa * 10^exp10 to double when it can be done exactly.
+     *
+     * When the mantissa fits in the 53 bits of a double and the power of ten is
+     * itself exact (at most 10^22), a single multiplication or division gives
+     * the correctly rounded result (Clinger's fast path).
+     *
+     * @param mantissa The decimal digits of the number.
+     * @param digits The number of digits in mantissa.
+     * @param exp10 The power of ten to apply.
+     * @param result Receives the value on success.
+     * @return False if the slow path is needed.
+     */
+    inline bool exact_double(uint64_t mantissa, size_t digits, long long exp10,
+                             double& result) {
+    #if FLT_EVAL_METHOD == 0
+        static constexpr double powers[] = {1e0,  1e1,  1e2,  1e3,  1e4,  1e5,
+                                            1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+                                            1e12, 1e13, 1e14, 1e15, 1e16, 1e17,
+                                            1e18, 1e19, 1e20, 1e21, 1e22};
+        if (digits > 19 || mantissa > (uint64_t(1) << 53) || exp10 < -22 ||
+            exp10 > 22) {
+            return false;
+        }
+        result = static_cast<double>(mantissa);
+        result = exp10 < 0 ? result / powers[-exp10] : result * powers[exp10];
+        return true;
+    #else
+        // Extended intermediate precision would round twice
+        (void)mantissa, (void)digits, (void)exp10, (void)result;
+        return false;
+    #endif
+    }
+
+    /**
+     * @brief Constructs a primitive Doc object from a substring of the input
+     * string.
+     *
+     * The input does not need a null terminator: characters past its end read
+     * as '\0'.
+     *
+     * @param input The input string.
+     * @param pos A pointer to the position in the input string.
+     * @param fin The final character to stop parsing at.
+     * @param arena The arena to copy strings into, or nullptr to use new.
+     * @param borrow Whether strings are views into input instead of copies.
+     * @return A primitive Doc object.
+     */
+    inline JoSon::Doc string_to_prim_doc(std::string_view input, size_t* pos,
+                                         char fin = ' ',
+                                         JoSon::Arena* arena = nullptr,
+                                         bool borrow = false) {
+        auto at = [input](size_t i) { return i < input.size() ? input[i] : '\0'; };
+        auto starts_with = [input](size_t i, std::string_view word) {
+            return i <= input.size() && input.compare(i, word.size(), word) == 0;
+        };
+
+        // String
+        if (at(*pos) == '\"') {
+            size_t parse = ++(*pos);
+            while (parse < input.size() && input[parse] != '\"') {
+                if (input[parse] == '\\') {
+                    ++parse; // An escaped character never ends the string
+                }
+                ++parse;
+            }
+            parse = parse < input.size() ? parse : input.size();
+            std::string_view view = input.substr(*pos, parse - (*pos));
+            *pos = parse + 1;
+            std::string scratch; // Only allocates for a string with escapes
+            return new_str(view, arena, borrow, scratch);
+        }
+            // Bool
+        else if (starts_with(*pos, "true")) {
+            *pos += 4;
+            return JoSon::Doc(true);
+        }
+            // Check for "false"
+        else if (starts_with(*pos, "false")) {
+            *pos += 5;
+            return JoSon::Doc(false);
+        }
+            // Check for "null"
+        else if (starts_with(*pos, "null")) {
+            *pos += 4;
+            return JoSon::Doc(JoSon::Type::Nullptr);
+
+        } else if (at(*pos) == '+' || at(*pos) == '-' || at(*pos) == '.' ||
+                   (at(*pos) >= '0' && at(*pos) <= '9')) {
+            bool sign = true;                 // Default sign is positive
+            JoSon::Type t = JoSon::Type::Int; // Default type is integer
+            size_t len = 0;        // Length of the number
+            uint64_t mantissa = 0; // Digits read, valid while len <= 19
+            long long exp10 = 0;   // Power of ten applied to the mantissa
+
+            // Check sign
+            if (at(*pos) == '-') {
+                sign = false;
+                ++(*pos);
+            } else if (at(*pos) == '+') {
+                ++(*pos);
+            }
+            const size_t first = *pos; // Start of the unsigned number
+
+            // Read digits
+            len = read_digits(input, pos, mantissa);
+            if (at(*pos) == '.') {
+                t = JoSon::Type::Double;
+                ++(*pos);
+                size_t floating = read_digits(input, pos, mantissa);
+                exp10 -= static_cast<long long>(floating);
+                len += floating;
+                if (at(*pos) == '.') {
+                    return JoSon::Doc(JoSon::Type::Nullptr);
+                }
+            }
+
+            bool e_sign = true;
+            if (at(*pos) == 'e' || at(*pos) == 'E') {
+                t = JoSon::Type::Double;
+                ++(*pos);
+                if (at(*pos) == '+' || at(*pos) == '-') {
+                    e_sign = (at(*pos) != '-');
+                    ++(*pos);
+                }
+                long long exp = 0;
+                while (at(*pos) >= '0' && at(*pos) <= '9') {
+                    if (exp < 100000) { // Far beyond the range of double
+                        exp = exp * 10 + (at(*pos) - '0');
+                    }
+                    ++(*pos);
+                }
+                exp10 += e_sign ? exp : -exp;
+            }
+
+            if (at(*pos) == '\0' || at(*pos) == ' ' || at(*pos) == ',' ||
+                at(*pos) == '\t' || at(*pos) == '\n' || at(*pos) == '\r' ||
+                at(*pos) == fin) {
+                // All characters parsed successfully
+                if (t == JoSon::Type::Int && len <= 9) {
+                    int int_val = static_cast<int>(mantissa);
+                    return JoSon::Doc(sign ? int_val : -int_val);
+                } else if (t == JoSon::Type::Int && len <= 16) {
+                    auto long_val = static_cast<long long>(mantissa);
+                    return JoSon::Doc(sign ? long_val : -long_val);
+                }
+                double decimal;
+                if (!exact_double(mantissa, len, exp10, decimal)) {
+                    // Correctly rounded conversion of the whole number
+                    const char* begin = input.data() + first;
+                    const char* stop = input.data() + *pos;
+                    auto [ptr, ec] = std::from_chars(begin, stop, decimal);
+                    if (ec == std::errc::result_out_of_range) {
+                        // The magnitude is that of the first significant digit
+                        long long zeros = 0;
+                        for (const char* c = begin; c != stop && (*c == '0' || *c == '.'); ++c) {
+                            zeros += *c == '0';
+                        }
+                        decimal = static_cast<long long>(len) + exp10 - zeros > 0 ? HUGE_VAL : 0.0;
+                    } else if (ec != std::errc()) {
+                        decimal = 0.0;
+                    }
+                }
+                return JoSon::Doc(sign ? decimal : -decimal);
+            }
+        }
+        // the format is not respected, read to the end
+        while (at(*pos) != '\0' && at(*pos) != ',' && at(*pos) != fin) {
+            ++(*pos);
+        }
+        return JoSon::Doc(JoSon::Type::Nullptr); // Default case, treated as null
+    }
+} // namespace JoSon::Prim
@@ -0,0 +1,338 @@
+// Sax.cpp
+#include "../include/JoSon/Sax.h"
+#include "Prim.h"
+#include <utility>
+
+JoSon::TreeBuilder::TreeBuilder(Arena* arena, bool borrow, KeyPool* keys)
+        : root(Type::Nullptr), arena(arena), keys(keys), borrow(borrow) {
+    ge_stk.reserve(64);
+}
+// Constructor starts from an empty document.
+
+void JoSon::TreeBuilder::attach(Doc&& value) {
+    if (ge_stk.empty()) {
+        root = std::move(value);
+        return;
+    }
+    Doc& doc = ge_stk.back();
+    if (doc.get_type() == Type::Dict) {
+        DictObj& dict = doc.get_dict_obj();
+        if (key.data() == key_scratch.data()) {
+            dict[key] = std::move(value); // Copies the key into the dictionary object
+        } else {
+            dict.emplace_view(key) = std::move(value);
+        }
+    } else {
+        doc.emplace_back(std::move(value));
+    }
+}
+
+void JoSon::TreeBuilder::open(Type type) {
+    Doc new_doc = Prim::new_container(type, arena);
+    if (type == Type::Dict && keys != nullptr) {
+        new_doc.get_dict_obj().set_key_pool(keys);
+    }
+    attach(Doc(new_doc)); // Shares the container with the stack
+    ge_stk.push_back(std::move(new_doc));
+}
+
+bool JoSon::TreeBuilder::on_begin_object() {
+    open(Type::Dict);
+    return true;
+}
+
+bool JoSon::TreeBuilder::on_end_object() {
+    if (!ge_stk.empty()) {
+        ge_stk.pop_back();
+    }
+    return true;
+}
+
+bool JoSon::TreeBuilder::on_begin_array() {
+    open(Type::Array);
+    return true;
+}
+
+bool JoSon::TreeBuilder::on_end_array() { return on_end_object(); }
+
+bool JoSon::TreeBuilder::on_key(std::string_view view) {
+    key = Prim::new_key(view, keys, borrow, key_scratch);
+    return true;
+}
+
+bool JoSon::TreeBuilder::on_string(std::string_view value) {
+    attach(Prim::new_str(value, arena, borrow, scratch));
+    return true;
+}
+
+bool JoSon::TreeBuilder::on_number(const Doc& value) {
+    attach(Doc(value));
+    return true;
+}
+
+bool JoSon::TreeBuilder::on_bool(bool value) {
+    attach(Doc(value));
+    return true;
+}
+
+bool JoSon::TreeBuilder::on_null() {
+    attach(Doc(Type::Nullptr));
+    return true;
+}
+
+JoSon::Doc JoSon::TreeBuilder::result() const { return root; }
+
+JoSon::Doc JoSon::TreeBuilder::reset(Arena* next_arena, bool next_borrow, KeyPool* next_keys) {
+    Doc built = std::move(root);
+    root = Doc(Type::Nullptr);
+    ge_stk.clear();
+    key = {};
+    arena = next_arena;
+    borrow = next_borrow;
+    keys = next_keys;
+    return built;
+}
+// Moving the root out leaves nothing of the document held by the builder.
+
+JoSon::Syntax::Syntax(Handler& handler)
+        : handler(handler), expect(Expect::Value), has_key(false) {}
+// Constructor expects the root value.
+
+void JoSon::Syntax::reset() {
+    dicts.clear();
+    expect = Expect::Value;
+    has_key = false;
+}
+
+bool JoSon::Syntax::begin_value() {
+    bool ok = true;
+    if (in_dict() && !has_key) {
+        ok = handler.on_key({});
+    }
+    has_key = false;
+    expect = Expect::Comma;
+    return ok;
+}
+// Every member of an object gets a key event before its value.
+
+bool JoSon::Syntax::open(bool dict) {
+    bool ok = dicts.empty() || begin_value();
+    ok = (dict ? handler.on_begin_object() : handler.on_begin_array()) && ok;
+    dicts.push_back(dict);
+    expect = dict ? Expect::Key : Expect::Value;
+    return ok;
+}
+
+bool JoSon::Syntax::close() {
+    if (dicts.empty()) {
+        return true; // Stray bracket
+    }
+    bool ok = true;
+    if (has_key && in_dict()) {
+        ok = handler.on_null(); // "key": }
+        has_key = false;
+    }
+    bool dict = dicts.back();
+    dicts.pop_back();
+    expect = Expect::Comma;
+    return (dict ? handler.on_end_object() : handler.on_end_array()) && ok;
+}
+
+void JoSon::Syntax::colon() {
+    if (expect == Expect::Colon) {
+        expect = Expect::Value;
+    }
+}
+
+bool JoSon::Syntax::comma() {
+    bool ok = true;
+    if (has_key && in_dict()) {
+        ok = handler.on_null(); // "key": ,
+        has_key = false;
+    }
+    expect = in_dict() ? Expect::Key : Expect::Value;
+    return ok;
+}
+
+bool JoSon::Syntax::string(std::string_view text) {
+    if (wants_key()) {
+        has_key = true;
+        expect = Expect::Colon;
+        return handler.on_key(text);
+    } else if (expect == Expect::Colon) {
+        return true; // Stray token between a key and its colon
+    }
+    bool ok = begin_value();
+    return handler.on_string(text) && ok;
+}
+
+bool JoSon::Syntax::bare(std::string_view text) {
+    if (wants_key()) {
+        // Unquoted key, read up to the colon
+        size_t right = text.find(':');
+        right = right == std::string_view::npos ? text.size() : right;
+        while (right > 0 && (text[right - 1] == ' ' || text[right - 1] == '\n' ||
+                             text[right - 1] == '\t' || text[right - 1] == '\r')) {
+            --right;
+        }
+        has_key = true;
+        expect = Expect::Colon;
+        return handler.on_key(text.substr(0, right));
+    } else if (expect == Expect::Colon) {
+        return true;
+    }
+    bool ok = begin_value();
+    size_t pos = 0;
+    Doc value = Prim::string_to_prim_doc(text, &pos, in_dict() ? '}' : ']');
+    switch (value.get_type()) {
+        case Type::Bool:
+            return handler.on_bool(value.get_bool()) && ok;
+        case Type::Nullptr:
+            return handler.on_null() && ok;
+        default:
+            return handler.on_number(value) && ok;
+    }
+}
+
+JoSon::StreamParser::StreamParser(Handler& handler)
+        : syntax(handler), lex(Lex::Space), escape(false), key_token(false),
+          started(false), complete(false), stopped(false) {}
+// Constructor waits for the first chunk.
+
+bool JoSon::StreamParser::after_event(bool ok) {
+    started = true;
+    if (!ok) {
+        stopped = true;
+        return false;
+    }
+    if (syntax.depth() == 0) {
+        complete = true;
+    }
+    return !complete;
+}
+// Parsing goes on until the root value is complete.
+
+bool JoSon::StreamParser::feed(std::string_view chunk) {
+    if (stopped || complete) {
+        return !stopped;
+    }
+    auto is_space = [](char c) {
+        return c == ' ' || c == '\n' || c == '\t' || c == '\r';
+    };
+    auto is_op = [](char c) {
+        return c == '{' || c == '}' || c == '[' || c == ']' || c == ':' ||
+               c == ',' || c == '"';
+    };
+
+    const size_t n = chunk.size();
+    size_t i = 0;
+    while (i < n) {
+        if (lex == Lex::String) {
+            size_t j = i;
+            while (j < n) {
+                char c = chunk[j];
+                if (escape) {
+                    escape = false;
+                } else if (c == '\\') {
+                    escape = true;
+                } else if (c == '"') {
+                    break;
+                }
+                ++j;
+            }
+            if (j == n) {
+                token.append(chunk.substr(i)); // Continued in the next chunk
+                return true;
+            }
+            bool ok;
+            if (token.empty()) {
+                ok = syntax.string(chunk.substr(i, j - i));
+            } else {
+                token.append(chunk.substr(i, j - i));
+                ok = syntax.string(token);
+                token.clear();
+            }
+            lex = Lex::Space;
+            i = j + 1;
+            if (!after_event(ok)) {
+                return !stopped;
+            }
+        } else if (lex == Lex::Bare) {
+            size_t j = i;
+            while (j < n && !is_op(chunk[j]) && (key_token || !is_space(chunk[j]))) {
+                ++j;
+            }
+            if (j == n) {
+                token.append(chunk.substr(i));
+                return true;
+            }
+            bool ok;
+            if (token.empty()) {
+                ok = syntax.bare(chunk.substr(i, j - i));
+            } else {
+                token.append(chunk.substr(i, j - i));
+                ok = syntax.bare(token);
+                token.clear();
+            }
+            lex = Lex::Space;
+            i = j; // The terminator is a token of its own
+            if (!after_event(ok)) {
+                return !stopped;
+            }
+        } else {
+            const char c = chunk[i];
+            if (is_space(c)) {
+                ++i;
+                continue;
+            }
+            bool ok = true;
+            switch (c) {
+                case '{':
+                case '[':
+                    ok = syntax.open(c == '{');
+                    break;
+                case '}':
+                case ']':
+                    ok = syntax.close();
+                    break;
+                case ':':
+                    syntax.colon();
+                    ++i;
+                    continue;
+                case ',':
+                    ok = syntax.comma();
+                    ++i;
+                    if (!ok) {
+                        stopped = true;
+                        return false;
+                    }
+                    continue;
+                case '"':
+                    lex = Lex::String;
+                    ++i;
+                    continue;
+                default:
+                    lex = Lex::Bare;
+                    key_token = syntax.wants_key();
+                    continue;
+            }
+            ++i;
+            if (!after_event(ok)) {
+                return !stopped;
+            }
+        }
+    }
+    return true;
+}
+// Tokenizes the chunk, buffering only a token cut by its end.
+
+bool JoSon::StreamParser::finish() {
+    if (!stopped && !complete && lex == Lex::Bare) {
+        // A bare root value, or a truncated document
+        bool ok = syntax.bare(token);
+        token.clear();
+        lex = Lex::Space;
+        after_event(ok);
+    }
+    return complete && !stopped;
+}
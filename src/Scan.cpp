@@ -0,0 +1,313 @@
+// Scan.cpp
+#include "Scan.h"
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64) || (defined(__i386__) && defined(__SSE2__))
+#define JOSON_SCAN_X86 1
+#include <immintrin.h>
+#elif defined(__aarch64__)
+#define JOSON_SCAN_NEON 1
+#include <arm_neon.h>
+#endif
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+
+namespace {
+    /**
+     * @brief Character classes of a 64-byte block, one bit per byte.
+     */
+    struct Masks {
+        uint64_t quote;     ///< '"'
+        uint64_t backslash; ///< '\\'
+        uint64_t space;     ///< ' ', '\t', '\n', '\r'
+        uint64_t op;        ///< '{', '}', '[', ']', ':', ','
+    };
+
+    using Kernel = void (*)(const unsigned char*, Masks&);
+
+    inline int trailing_zeros(uint64_t bits) {
+#if defined(_MSC_VER) && !defined(__clang__)
+        unsigned long index;
+        _BitScanForward64(&index, bits);
+        return static_cast<int>(index);
+#else
+        return __builtin_ctzll(bits);
+#endif
+    }
+
+    inline int pop_count(uint64_t bits) {
+#if defined(_MSC_VER) && !defined(__clang__)
+        bits -= (bits >> 1) & 0x5555555555555555ULL;
+        bits = (bits & 0x3333333333333333ULL) + ((bits >> 2) & 0x3333333333333333ULL);
+        bits = (bits + (bits >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+        return static_cast<int>((bits * 0x0101010101010101ULL) >> 56);
+#else
+        return __builtin_popcountll(bits);
+#endif
+    }
+
+#if !defined(JOSON_SCAN_X86) && !defined(JOSON_SCAN_NEON)
+    void classify_scalar(const unsigned char* p, Masks& m) {
+        m = {0, 0, 0, 0};
+        for (int i = 0; i < 64; ++i) {
+            uint64_t bit = uint64_t(1) << i;
+            switch (p[i]) {
+                case '"':
+                    m.quote |= bit;
+                    break;
+                case '\\':
+                    m.backslash |= bit;
+                    break;
+                case ' ':
+                case '\t':
+                case '\n':
+                case '\r':
+                    m.space |= bit;
+                    break;
+                case '{':
+                case '}':
+                case '[':
+                case ']':
+                case ':':
+                case ',':
+                    m.op |= bit;
+                    break;
+                default:
+                    break;
+            }
+        }
+    }
+    // Reference classification, one byte at a time.
+#endif
+
+#ifdef JOSON_SCAN_X86
+    void classify_sse2(const unsigned char* p, Masks& m) {
+        // '[' and ']' become '{' and '}' once bit 0x20 is set; nothing else does
+        const __m128i lower = _mm_set1_epi8(0x20);
+        m = {0, 0, 0, 0};
+        for (int k = 0; k < 4; ++k) {
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 16 * k));
+            __m128i folded = _mm_or_si128(v, lower);
+            auto bits = [](__m128i eq) {
+                return static_cast<uint64_t>(static_cast<uint32_t>(_mm_movemask_epi8(eq)));
+            };
+            int shift = 16 * k;
+            m.quote |= bits(_mm_cmpeq_epi8(v, _mm_set1_epi8('"'))) << shift;
+            m.backslash |= bits(_mm_cmpeq_epi8(v, _mm_set1_epi8('\\'))) << shift;
+            m.space |= bits(_mm_or_si128(
+                    _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(' ')),
+                                 _mm_cmpeq_epi8(v, _mm_set1_epi8('\t'))),
+                    _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('\n')),
+                                 _mm_cmpeq_epi8(v, _mm_set1_epi8('\r'))))) << shift;
+            m.op |= bits(_mm_or_si128(
+                    _mm_or_si128(_mm_cmpeq_epi8(folded, _mm_set1_epi8('{')),
+                                 _mm_cmpeq_epi8(folded, _mm_set1_epi8('}'))),
+                    _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(':')),
+                                 _mm_cmpeq_epi8(v, _mm_set1_epi8(','))))) << shift;
+        }
+    }
+    // Four 16-byte comparisons per class.
+
+#if defined(__GNUC__) || defined(__clang__)
+    __attribute__((target("avx2"))) void classify_avx2(const unsigned char* p, Masks& m) {
+        const __m256i lower = _mm256_set1_epi8(0x20);
+        m = {0, 0, 0, 0};
+        for (int k = 0; k < 2; ++k) {
+            __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + 32 * k));
+            __m256i folded = _mm256_or_si256(v, lower);
+            auto bits = [](__m256i eq) __attribute__((target("avx2"))) {
+                return static_cast<uint64_t>(static_cast<uint32_t>(_mm256_movemask_epi8(eq)));
+            };
+            int shift = 32 * k;
+            m.quote |= bits(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('"'))) << shift;
+            m.backslash |= bits(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('\\'))) << shift;
+            m.space |= bits(_mm256_or_si256(
+                    _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8(' ')),
+                                    _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\t'))),
+                    _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('\n')),
+                                    _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\r'))))) << shift;
+            m.op |= bits(_mm256_or_si256(
+                    _mm256_or_si256(_mm256_cmpeq_epi8(folded, _mm256_set1_epi8('{')),
+                                    _mm256_cmpeq_epi8(folded, _mm256_set1_epi8('}'))),
+                    _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8(':')),
+                                    _mm256_cmpeq_epi8(v, _mm256_set1_epi8(','))))) << shift;
+        }
+    }
+    // Two 32-byte comparisons per class, selected at run time.
+#endif
+#endif
+
+#ifdef JOSON_SCAN_NEON
+    inline uint64_t neon_bits(uint8x16_t r0, uint8x16_t r1, uint8x16_t r2, uint8x16_t r3) {
+        const uint8x16_t weight = {0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80,
+                                   0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80};
+        uint8x16_t sum0 = vpaddq_u8(vandq_u8(r0, weight), vandq_u8(r1, weight));
+        uint8x16_t sum1 = vpaddq_u8(vandq_u8(r2, weight), vandq_u8(r3, weight));
+        sum0 = vpaddq_u8(sum0, sum1);
+        sum0 = vpaddq_u8(sum0, sum0);
+        return vgetq_lane_u64(vreinterpretq_u64_u8(sum0), 0);
+    }
+    // Packs four comparison results into one bit per byte.
+
+    void classify_neon(const unsigned char* p, Masks& m) {
+        uint8x16_t v[4], folded[4];
+        for (int k = 0; k < 4; ++k) {
+            v[k] = vld1q_u8(p + 16 * k);
+            folded[k] = vorrq_u8(v[k], vdupq_n_u8(0x20));
+        }
+        auto eq = [&v](int k, unsigned char c) { return vceqq_u8(v[k], vdupq_n_u8(c)); };
+        auto feq = [&folded](int k, unsigned char c) {
+            return vceqq_u8(folded[k], vdupq_n_u8(c));
+        };
+        uint8x16_t space[4], op[4];
+        for (int k = 0; k < 4; ++k) {
+            space[k] = vorrq_u8(vorrq_u8(eq(k, ' '), eq(k, '\t')), vorrq_u8(eq(k, '\n'), eq(k, '\r')));
+            op[k] = vorrq_u8(vorrq_u8(feq(k, '{'), feq(k, '}')), vorrq_u8(eq(k, ':'), eq(k, ',')));
+        }
+        m.quote = neon_bits(eq(0, '"'), eq(1, '"'), eq(2, '"'), eq(3, '"'));
+        m.backslash = neon_bits(eq(0, '\\'), eq(1, '\\'), eq(2, '\\'), eq(3, '\\'));
+        m.space = neon_bits(space[0], space[1], space[2], space[3]);
+        m.op = neon_bits(op[0], op[1], op[2], op[3]);
+    }
+    // Four 16-byte comparisons per class.
+#endif
+
+    Kernel select_kernel(const char** name) {
+#ifdef JOSON_SCAN_X86
+#if defined(__GNUC__) || defined(__clang__)
+        if (__builtin_cpu_supports("avx2")) {
+            *name = "avx2";
+            return classify_avx2;
+        }
+#endif
+        *name = "sse2";
+        return classify_sse2;
+#elif defined(JOSON_SCAN_NEON)
+        *name = "neon";
+        return classify_neon;
+#else
+        *name = "scalar";
+        return classify_scalar;
+#endif
+    }
+    // Picks the widest kernel supported by the running CPU.
+
+    struct KernelChoice {
+        const char* name = nullptr;
+        Kernel kernel = select_kernel(&name);
+    };
+
+    const KernelChoice& kernel_choice() {
+        static const KernelChoice choice;
+        return choice;
+    }
+
+    inline uint64_t prefix_xor(uint64_t bits) {
+        bits ^= bits << 1;
+        bits ^= bits << 2;
+        bits ^= bits << 4;
+        bits ^= bits << 8;
+        bits ^= bits << 16;
+        bits ^= bits << 32;
+        return bits;
+    }
+    // Bit i of the result is the parity of bits 0..i: set strictly inside quotes.
+
+    inline uint64_t find_escaped(uint64_t backslash, uint64_t& prev_escaped) {
+        if (backslash == 0) {
+            uint64_t escaped = prev_escaped;
+            prev_escaped = 0;
+            return escaped;
+        }
+        const uint64_t even_bits = 0x5555555555555555ULL;
+        backslash &= ~prev_escaped; // An escaped backslash escapes nothing
+        uint64_t follows_escape = backslash << 1 | prev_escaped;
+        uint64_t odd_sequence_starts = backslash & ~even_bits & ~follows_escape;
+        uint64_t sequences_starting_on_even_bits = odd_sequence_starts + backslash;
+        prev_escaped = sequences_starting_on_even_bits < backslash ? 1 : 0; // Carry out
+        uint64_t invert_mask = sequences_starting_on_even_bits << 1;
+        return (even_bits ^ invert_mask) & follows_escape;
+    }
+    // Bytes preceded by an odd-length run of backslashes.
+
+    inline uint64_t block_structurals(const Masks& m, uint64_t valid,
+                                      JoSon::Scan::BlockState& state) {
+        uint64_t escaped = find_escaped(m.backslash, state.escaped);
+        uint64_t quote = m.quote & ~escaped & valid;
+        uint64_t in_string = prefix_xor(quote) ^ state.in_string;
+        state.in_string = static_cast<uint64_t>(static_cast<int64_t>(in_string) >> 63);
+        uint64_t bare = ~(m.op | m.space | m.quote) & ~in_string & valid;
+        uint64_t bare_start = bare & ~(bare << 1 | state.bare);
+        state.bare = bare >> 63;
+        return (m.op & ~in_string & valid) | quote | bare_start;
+    }
+    // Positions stage 2 needs from one block.
+
+    inline void flatten(uint64_t bits, uint32_t offset, std::vector<uint32_t>& out) {
+        size_t at = out.size();
+        out.resize(at + static_cast<size_t>(pop_count(bits)));
+        uint32_t* dst = out.data() + at;
+        while (bits != 0) {
+            *dst++ = offset + static_cast<uint32_t>(trailing_zeros(bits));
+            bits &= bits - 1;
+        }
+    }
+    // Appends the offset of every set bit.
+} // namespace
+
+void JoSon::Scan::index_structurals(std::string_view input,
+                                    std::vector<uint32_t>& out,
+                                    BlockState& state) {
+    Kernel kernel = kernel_choice().kernel;
+    const auto* p = reinterpret_cast<const unsigned char*>(input.data());
+    size_t n = input.size();
+    size_t i = 0;
+    Masks m{};
+    for (; i + 64 <= n; i += 64) {
+        kernel(p + i, m);
+        flatten(block_structurals(m, ~uint64_t(0), state), static_cast<uint32_t>(i), out);
+    }
+    if (i < n) {
+        // Pad the last block with spaces, which are never structural
+        unsigned char tail[64];
+        std::memset(tail, ' ', sizeof(tail));
+        std::memcpy(tail, p + i, n - i);
+        kernel(tail, m);
+        uint64_t valid = (uint64_t(1) << (n - i)) - 1;
+        flatten(block_structurals(m, valid, state), static_cast<uint32_t>(i), out);
+    }
+}
+// Classifies every block and collects its structural positions.
+
+JoSon::Scan::Indexer::Indexer(std::string_view text)
+        : input(text), base(0), scanned(0), cursor(0) {
+    positions.reserve(window / 4);
+}
+// Constructor prepares an empty index; nothing is scanned yet.
+
+void JoSon::Scan::Indexer::reset(std::string_view text) {
+    input = text;
+    base = scanned = cursor = 0;
+    positions.clear();
+    state = BlockState();
+}
+
+bool JoSon::Scan::Indexer::refill() {
+    positions.clear();
+    cursor = 0;
+    if (scanned >= input.size()) {
+        return false;
+    }
+    base = scanned;
+    std::string_view chunk = input.substr(base, window);
+    index_structurals(chunk, positions, state);
+    scanned = base + chunk.size();
+    return true;
+}
+// Indexes the window following the current one.
+
+size_t JoSon::Scan::Indexer::indexed() const { return scanned; }
+
+const char* JoSon::Scan::kernel_name() { return kernel_choice().name; }
@@ -0,0 +1,119 @@
+// Scan.h
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+/**
+ * @brief Structural indexing of JSON text (stage 1 of the parser).
+ *
+ * The input is classified 64 bytes at a time with SIMD comparisons (AVX2 or
+ * SSE2 on x86, NEON on ARM, a scalar loop elsewhere). Bit masks of quotes,
+ * backslashes, whitespace and operators are combined to find which bytes are
+ * inside strings, and the positions of the bytes that matter to the tree
+ * builder are extracted:
+ *
+ * - the operators { } [ ] : , outside strings,
+ * - every unescaped quote (both the opening and the closing one),
+ * - the first byte of every bare token (numbers, true, false, null, ...).
+ *
+ * Stage 2 then walks these positions instead of testing every byte.
+ */
+namespace JoSon::Scan {
+
+    /**
+     * @brief Carry state between consecutive 64-byte blocks.
+     */
+    struct BlockState {
+        uint64_t in_string = 0; ///< All ones if the previous block ended inside a string.
+        uint64_t escaped = 0;   ///< 1 if the first byte of the next block is escaped.
+        uint64_t bare = 0;      ///< 1 if the previous block ended inside a bare token.
+    };
+
+    /**
+     * @brief Indexes the structural positions of a whole buffer.
+     *
+     * Positions are appended to out as offsets from the start of input, so the
+     * input must be smaller than 4 GiB.
+     *
+     * @param input The JSON text.
+     * @param out Receives the structural positions in increasing order.
+     * @param state Carry state; on return it tells whether input ended inside a string.
+     */
+    void index_structurals(std::string_view input, std::vector<uint32_t>& out,
+                           BlockState& state);
+
+    /**
+     * @brief Incremental structural indexer.
+     *
+     * Indexes the input one window at a time, so that the index stays small
+     * and hot in cache whatever the size of the input, and positions are
+     * returned in order as the tree builder asks for them.
+     */
+    struct Indexer {
+    private:
+        std::string_view input;         ///< The JSON text.
+        size_t base;                    ///< Offset of the current window in input.
+        size_t scanned;                 ///< Offset of the end of the current window.
+        size_t cursor;                  ///< Next entry of positions to return.
+        std::vector<uint32_t> positions; ///< Positions of the window, relative to base.
+        BlockState state;               ///< Carry state between windows.
+
+        /**
+         * @brief Indexes the next window.
+         *
+         * @return False if the whole input has been indexed.
+         */
+        bool refill();
+
+    public:
+        static constexpr size_t window = 64 * 1024; ///< Bytes indexed per refill.
+
+        /**
+         * @brief Constructor over a buffer.
+         *
+         * @param text The JSON text. It must outlive the indexer.
+         */
+        explicit Indexer(std::string_view text);
+
+        /**
+         * @brief Restarts the indexer over another buffer, keeping the storage
+         * of the index.
+         *
+         * @param text The JSON text. It must outlive the indexer.
+         */
+        void reset(std::string_view text);
+
+        /**
+         * @brief Get the next structural position.
+         *
+         * @param pos Receives the offset of the position in the input.
+         * @return False once every position has been returned.
+         */
+        bool next(size_t& pos) {
+            while (cursor == positions.size()) {
+                if (!refill()) {
+                    return false;
+                }
+            }
+            pos = base + positions[cursor++];
+            return true;
+        }
+
+        /**
+         * @brief Get the number of bytes indexed so far.
+         *
+         * @return Offset of the end of the current window.
+         */
+        [[nodiscard]] size_t indexed() const;
+    }; // struct Indexer
+
+    /**
+     * @brief Get the name of the classification kernel selected for this CPU.
+     *
+     * @return "avx2", "sse2", "neon" or "scalar".
+     */
+    [[nodiscard]] const char* kernel_name();
+} // namespace JoSon::Scan
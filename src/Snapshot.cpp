@@ -0,0 +1,30 @@
+// Snapshot.cpp
+#include "../include/JoSon/Snapshot.h"
+#include <utility>
+
+JoSon::Snapshot::Snapshot() : Snapshot(Doc()) {}
+
+JoSon::Snapshot::Snapshot(Doc doc) { publish(std::move(doc)); }
+
+void JoSon::Snapshot::publish(Doc doc) {
+    std::atomic_store_explicit(&current, std::shared_ptr<const Doc>(std::make_shared<Doc>(std::move(doc))),
+                               std::memory_order_release);
+    versions.fetch_add(1, std::memory_order_acq_rel);
+}
+// The version is bumped after the store, so a reader seeing it also sees the document.
+
+std::shared_ptr<const JoSon::Doc> JoSon::Snapshot::load() const {
+    return std::atomic_load_explicit(&current, std::memory_order_acquire);
+}
+
+const JoSon::Doc& JoSon::Snapshot::Reader::get() {
+    const uint64_t latest = source->version();
+    if (latest != seen) {
+        // Stamped with the version read first, a document published meanwhile is
+        // loaded again by the next call, which is harmless.
+        held = source->load();
+        seen = latest;
+    }
+    return *held;
+}
+// In steady state a single atomic load of the version counter.
@@ -0,0 +1,357 @@
+// Text.cpp
+#include "Text.h"
+#include <cstdint>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64) || (defined(__i386__) && defined(__SSE2__))
+#define JOSON_TEXT_SSE2 1
+#include <emmintrin.h>
+#elif defined(__aarch64__)
+#define JOSON_TEXT_NEON 1
+#include <arm_neon.h>
+#endif
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+
+namespace {
+    constexpr uint64_t ones = 0x0101010101010101ULL;  ///< 0x01 in every byte.
+    constexpr uint64_t highs = 0x8080808080808080ULL; ///< 0x80 in every byte.
+
+    /**
+     * @brief Checks whether some byte of a word is below a value.
+     *
+     * @param word Eight bytes.
+     * @param n The bound, at most 128.
+     */
+    inline bool has_less(uint64_t word, uint64_t n) {
+        return ((word - ones * n) & ~word & highs) != 0;
+    }
+
+    /**
+     * @brief Checks whether some byte of a word is equal to a value.
+     */
+    inline bool has_byte(uint64_t word, unsigned char c) {
+        return has_less(word ^ (ones * c), 1);
+    }
+
+    inline size_t trailing_zeros(int mask) {
+#if defined(_MSC_VER) && !defined(__clang__)
+        unsigned long index;
+        _BitScanForward(&index, static_cast<unsigned long>(mask));
+        return index;
+#else
+        return static_cast<size_t>(__builtin_ctz(static_cast<unsigned>(mask)));
+#endif
+    }
+
+    inline bool is_plain(unsigned char c) { return c != '\\' && c < 0x80; }
+
+    inline bool is_safe(unsigned char c) { return c != '"' && c != '\\' && c >= 0x20; }
+
+    /**
+     * @brief Appends a code point as UTF-8.
+     */
+    void append_utf8(uint32_t cp, std::string& out) {
+        if (cp < 0x80) {
+            out.push_back(static_cast<char>(cp));
+        } else if (cp < 0x800) {
+            out.push_back(static_cast<char>(0xC0 | (cp >> 6)));
+            out.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+        } else if (cp < 0x10000) {
+            out.push_back(static_cast<char>(0xE0 | (cp >> 12)));
+            out.push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
+            out.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+        } else {
+            out.push_back(static_cast<char>(0xF0 | (cp >> 18)));
+            out.push_back(static_cast<char>(0x80 | ((cp >> 12) & 0x3F)));
+            out.push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
+            out.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+        }
+    }
+
+    /**
+     * @brief Reads four hexadecimal digits.
+     *
+     * @param raw The string.
+     * @param pos Offset of the first digit.
+     * @param value Receives the value of the digits.
+     * @return False if there are not four digits at pos.
+     */
+    bool read_hex4(std::string_view raw, size_t pos, uint32_t& value) {
+        if (pos + 4 > raw.size()) {
+            return false;
+        }
+        value = 0;
+        for (size_t i = pos; i < pos + 4; ++i) {
+            const char c = raw[i];
+            uint32_t digit;
+            if (c >= '0' && c <= '9') {
+                digit = static_cast<uint32_t>(c - '0');
+            } else if (c >= 'a' && c <= 'f') {
+                digit = static_cast<uint32_t>(c - 'a' + 10);
+            } else if (c >= 'A' && c <= 'F') {
+                digit = static_cast<uint32_t>(c - 'A' + 10);
+            } else {
+                return false;
+            }
+            value = value << 4 | digit;
+        }
+        return true;
+    }
+
+    /**
+     * @brief Decodes the escape sequence at a backslash.
+     *
+     * @return The offset after the sequence.
+     */
+    size_t decode_escape(std::string_view raw, size_t pos, std::string& out) {
+        if (pos + 1 == raw.size()) {
+            out.push_back('\\');
+            return pos + 1;
+        }
+        switch (raw[pos + 1]) {
+            case '"':
+                out.push_back('"');
+                return pos + 2;
+            case '\\':
+                out.push_back('\\');
+                return pos + 2;
+            case '/':
+                out.push_back('/');
+                return pos + 2;
+            case 'b':
+                out.push_back('\b');
+                return pos + 2;
+            case 'f':
+                out.push_back('\f');
+                return pos + 2;
+            case 'n':
+                out.push_back('\n');
+                return pos + 2;
+            case 'r':
+                out.push_back('\r');
+                return pos + 2;
+            case 't':
+                out.push_back('\t');
+                return pos + 2;
+            case 'u':
+                break;
+            default:
+                out.push_back('\\'); // Unknown escape, the next byte is read on its own
+                return pos + 1;
+        }
+        uint32_t cp;
+        if (!read_hex4(raw, pos + 2, cp)) {
+            out.append("\\u");
+            return pos + 2;
+        }
+        pos += 6;
+        if (cp >= 0xD800 && cp <= 0xDBFF) {
+            uint32_t low;
+            if (pos + 1 < raw.size() && raw[pos] == '\\' && raw[pos + 1] == 'u' &&
+                read_hex4(raw, pos + 2, low) && low >= 0xDC00 && low <= 0xDFFF) {
+                cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+                pos += 6;
+            } else {
+                cp = 0xFFFD; // High surrogate without its pair
+            }
+        } else if (cp >= 0xDC00 && cp <= 0xDFFF) {
+            cp = 0xFFFD; // Low surrogate on its own
+        }
+        append_utf8(cp, out);
+        return pos;
+    }
+
+    /**
+     * @brief Validates the UTF-8 sequence at a non-ASCII byte.
+     *
+     * A valid sequence is copied. An invalid one is replaced by U+FFFD, and
+     * its longest valid prefix is skipped, as Unicode recommends.
+     *
+     * @return The offset after the sequence.
+     */
+    size_t validate_utf8(std::string_view raw, size_t pos, std::string& out) {
+        const auto* p = reinterpret_cast<const unsigned char*>(raw.data());
+        const unsigned char lead = p[pos];
+        size_t need;
+        unsigned char low = 0x80;
+        unsigned char high = 0xBF;
+        if (lead >= 0xC2 && lead <= 0xDF) {
+            need = 1;
+        } else if (lead == 0xE0) {
+            need = 2;
+            low = 0xA0; // Overlong below
+        } else if (lead == 0xED) {
+            need = 2;
+            high = 0x9F; // Surrogates above
+        } else if (lead >= 0xE1 && lead <= 0xEF) {
+            need = 2;
+        } else if (lead == 0xF0) {
+            need = 3;
+            low = 0x90; // Overlong below
+        } else if (lead >= 0xF1 && lead <= 0xF3) {
+            need = 3;
+        } else if (lead == 0xF4) {
+            need = 3;
+            high = 0x8F; // Beyond U+10FFFF above
+        } else {
+            out.append("\xEF\xBF\xBD");
+            return pos + 1;
+        }
+        size_t end = pos + 1;
+        for (; need > 0 && end < raw.size(); --need, ++end) {
+            if (p[end] < low || p[end] > high) {
+                break;
+            }
+            low = 0x80;
+            high = 0xBF;
+        }
+        if (need > 0) {
+            out.append("\xEF\xBF\xBD");
+        } else {
+            out.append(raw.data() + pos, end - pos);
+        }
+        return end;
+    }
+} // namespace
+
+size_t JoSon::Text::plain_length(std::string_view raw) {
+    const auto* p = reinterpret_cast<const unsigned char*>(raw.data());
+    const size_t n = raw.size();
+    size_t i = 0;
+#if defined(JOSON_TEXT_SSE2)
+    const __m128i backslash = _mm_set1_epi8('\\');
+    for (; i + 16 <= n; i += 16) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+        // The sign bit is set by the comparison and by the non-ASCII bytes
+        int mask = _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(v, backslash), v));
+        if (mask != 0) {
+            return i + trailing_zeros(mask);
+        }
+    }
+#elif defined(JOSON_TEXT_NEON)
+    for (; i + 16 <= n; i += 16) {
+        uint8x16_t v = vld1q_u8(p + i);
+        uint8x16_t special = vorrq_u8(vceqq_u8(v, vdupq_n_u8('\\')), vcgeq_u8(v, vdupq_n_u8(0x80)));
+        if (vmaxvq_u8(special) != 0) {
+            break; // Located by the loop below
+        }
+    }
+#else
+    for (; i + 8 <= n; i += 8) {
+        uint64_t word;
+        std::memcpy(&word, p + i, sizeof(word));
+        if ((word & highs) != 0 || has_byte(word, '\\')) {
+            break;
+        }
+    }
+#endif
+    while (i < n && is_plain(p[i])) {
+        ++i;
+    }
+    return i;
+}
+// Sixteen bytes per comparison, the tail and the block found one at a time.
+
+size_t JoSon::Text::safe_length(std::string_view text) {
+    const auto* p = reinterpret_cast<const unsigned char*>(text.data());
+    const size_t n = text.size();
+    size_t i = 0;
+#if defined(JOSON_TEXT_SSE2)
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i backslash = _mm_set1_epi8('\\');
+    const __m128i control = _mm_set1_epi8(0x1F);
+    for (; i + 16 <= n; i += 16) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+        // Unsigned v <= 0x1F exactly when max(v, 0x1F) == 0x1F
+        __m128i special = _mm_or_si128(
+                _mm_or_si128(_mm_cmpeq_epi8(v, quote), _mm_cmpeq_epi8(v, backslash)),
+                _mm_cmpeq_epi8(_mm_max_epu8(v, control), control));
+        int mask = _mm_movemask_epi8(special);
+        if (mask != 0) {
+            return i + trailing_zeros(mask);
+        }
+    }
+#elif defined(JOSON_TEXT_NEON)
+    for (; i + 16 <= n; i += 16) {
+        uint8x16_t v = vld1q_u8(p + i);
+        uint8x16_t special = vorrq_u8(vorrq_u8(vceqq_u8(v, vdupq_n_u8('"')), vceqq_u8(v, vdupq_n_u8('\\'))),
+                                      vcltq_u8(v, vdupq_n_u8(0x20)));
+        if (vmaxvq_u8(special) != 0) {
+            break;
+        }
+    }
+#else
+    for (; i + 8 <= n; i += 8) {
+        uint64_t word;
+        std::memcpy(&word, p + i, sizeof(word));
+        if (has_less(word, 0x20) || has_byte(word, '"') || has_byte(word, '\\')) {
+            break;
+        }
+    }
+#endif
+    while (i < n && is_safe(p[i])) {
+        ++i;
+    }
+    return i;
+}
+
+void JoSon::Text::unescape(std::string_view raw, std::string& out) {
+    out.reserve(out.size() + raw.size()); // Decoding only shrinks, but for U+FFFD
+    size_t pos = 0;
+    while (true) {
+        const size_t run = plain_length(raw.substr(pos));
+        out.append(raw.data() + pos, run);
+        pos += run;
+        if (pos == raw.size()) {
+            return;
+        }
+        pos = raw[pos] == '\\' ? decode_escape(raw, pos, out) : validate_utf8(raw, pos, out);
+    }
+}
+// Copies the runs that decode to themselves, stopping at backslashes and non-ASCII bytes
+
+void JoSon::Text::escape(std::string_view text, std::string& out) {
+    static constexpr char digits[] = "0123456789abcdef";
+    size_t pos = 0;
+    while (true) {
+        const size_t run = safe_length(text.substr(pos));
+        out.append(text.data() + pos, run);
+        pos += run;
+        if (pos == text.size()) {
+            return;
+        }
+        const auto c = static_cast<unsigned char>(text[pos++]);
+        switch (c) {
+            case '"':
+                out.append("\\\"");
+                break;
+            case '\\':
+                out.append("\\\\");
+                break;
+            case '\b':
+                out.append("\\b");
+                break;
+            case '\f':
+                out.append("\\f");
+                break;
+            case '\n':
+                out.append("\\n");
+                break;
+            case '\r':
+                out.append("\\r");
+                break;
+            case '\t':
+                out.append("\\t");
+                break;
+            default:
+                out.append("\\u00");
+                out.push_back(digits[c >> 4]);
+                out.push_back(digits[c & 0xF]);
+                break;
+        }
+    }
+}
+// Copies the runs that need no escape, stopping at quotes, backslashes and controls
@@ -0,0 +1,80 @@
+// Text.h
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+/**
+ * @brief Escape sequences and UTF-8 of JSON strings.
+ *
+ * Both directions first measure, 16 bytes at a time with SIMD comparisons
+ * (SSE2 on x86, NEON on ARM, eight bytes at a time with SWAR arithmetic
+ * elsewhere), the run of bytes that can be copied as they are, so that
+ * strings without escapes cost a single copy.
+ */
+namespace JoSon::Text {
+
+    /**
+     * @brief Get the length of the leading run of a raw string that decodes
+     * to itself.
+     *
+     * @param raw The characters between the quotes.
+     * @return The offset of the first backslash or non-ASCII byte, or the size
+     * of raw if there is none.
+     */
+    [[nodiscard]] size_t plain_length(std::string_view raw);
+
+    /**
+     * @brief Get the length of the leading run of a string that is written
+     * without escapes.
+     *
+     * @param text The string.
+     * @return The offset of the first quote, backslash or control character,
+     * or the size of text if there is none.
+     */
+    [[nodiscard]] size_t safe_length(std::string_view text);
+
+    /**
+     * @brief Decodes the escape sequences of a raw JSON string and validates
+     * its UTF-8.
+     *
+     * \\" \\\\ \\/ \\b \\f \\n \\r \\t and \\uXXXX are decoded, surrogate pairs
+     * included. The parser is lenient, so nothing throws: an unknown escape or
+     * a \\u without four hexadecimal digits is kept as written, and a lone
+     * surrogate, a byte that does not start a valid UTF-8 sequence, an
+     * overlong or truncated sequence become U+FFFD.
+     *
+     * @param raw The characters between the quotes.
+     * @param out Receives the decoded string, appended.
+     */
+    void unescape(std::string_view raw, std::string& out);
+
+    /**
+     * @brief Escapes a string for a JSON text, without the enclosing quotes.
+     *
+     * Quotes and backslashes are escaped, as are control characters: \\b \\f
+     * \\n \\r \\t by name and the others as \\u00XX. Other bytes, UTF-8
+     * included, are copied.
+     *
+     * @param text The string.
+     * @param out Receives the escaped string, appended.
+     */
+    void escape(std::string_view text, std::string& out);
+
+    /**
+     * @brief Escapes a string for a JSON text within quotes.
+     *
+     * @param text The string.
+     * @param out Receives the quoted string, appended.
+     */
+    inline void quote(std::string_view text, std::string& out) {
+        out.push_back('"');
+        if (safe_length(text) == text.size()) {
+            out.append(text);
+        } else {
+            escape(text, out);
+        }
+        out.push_back('"');
+    }
+} // namespace JoSon::Text
@@ -1,5 +1,7 @@
 #include "../include/JoSon/Viso.h"
+#include "Text.h"
 #include <iostream>
+#include <string_view>
 #include <vector>
 
 namespace JoSon::Viso {
@@ -13,114 +15,307 @@ namespace JoSon::Viso {
 
     unsigned int progress_step = 1; // One percent by default
 
-    [[maybe_unused]] void json_print(const std::string& json_str, int indents) {
-        bool sync_state = std::ostream::sync_with_stdio(false);
-        // Save the current sync state
-        std::vector<std::string> indent_strings(16);
-        for (size_t i = 0; i < 16; ++i) {
-            indent_strings[i] = std::string(indents * i, ' ');
-        }
+    namespace {
+        const char* const reset_color = "\033[0m"; ///< Resets the color to normal.
 
-        auto get_indents = [&indent_strings](size_t i) {
-            return (i < 16) ? indent_strings[i] : indent_strings[15];
-        };
+        /**
+         * @brief Buffered output of json_print(), written to std::cout in
+         * large blocks.
+         */
+        struct Output {
+            static constexpr size_t capacity = 64 * 1024; ///< Bytes buffered before a write.
 
-        int level = 0;            // Initialize the indentation level
-        bool begin_point = false; // Flag to indicate if a new line has started
+            std::string buffer;  ///< Text not yet written.
+            std::string indents; ///< Spaces of the deepest indentation used so far.
+            size_t step;         ///< Spaces per level.
 
-        for (size_t i = 0; i < json_str.size(); ++i) {
-            char c = json_str[i]; // Current character being processed
+            explicit Output(int indents) : step(indents > 0 ? static_cast<size_t>(indents) : 0) {
+                buffer.reserve(capacity);
+            }
 
-            // Handle opening curly braces
-            if (c == '{') {
-                level++;
-                std::cout << c;
+            Output(const Output&) = delete;
+
+            Output& operator=(const Output&) = delete;
+
+            ~Output() { flush(); }
+
+            void flush() {
+                std::cout.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+                buffer.clear();
             }
-                // Handle closing curly braces
-            else if (c == '}') {
-                level--; // Decrement the indentation level
-                std::cout << get_indents(level) << c;
+
+            void append(std::string_view text) {
+                buffer.append(text);
+                if (buffer.size() >= capacity) {
+                    flush();
+                }
             }
-                // Handle newline characters
-            else if (c == '\n') {
-                std::cout << c;     // Output the newline character
-                begin_point = true; // Set the flag to indicate a new line
-                continue;
+
+            void put(char c) { buffer.push_back(c); }
+
+            /**
+             * @brief Writes the indentation of a level.
+             */
+            void indent(size_t level) {
+                const size_t width = step * level;
+                if (indents.size() < width) {
+                    indents.resize(width, ' ');
+                }
+                append(std::string_view(indents).substr(0, width));
             }
-                // Handle other characters
-            else {
-                if (begin_point) {
-                    std::cout << get_indents(level);
+
+            /**
+             * @brief Writes a token in a color, with a single escape sequence
+             * before it and after it.
+             */
+            void span(const std::string& color, std::string_view text) {
+                if (colorful) {
+                    buffer.append(color);
                 }
-                if (c == '\"') { // Handle string characters
-                    if (colorful)
-                        std::cout << str_color; // Set string color
-                    std::cout << c;
-                    while (true) {
-                        char next = json_str[++i];
-                        if (next == '\"') {
-                            std::cout << next;
-                            break;
-                        } else {
-                            std::cout << next;
-                        }
-                    }
-                    if (colorful)
-                        std::cout << "\033[0m"; // Reset color to normal
+                buffer.append(text);
+                if (colorful) {
+                    buffer.append(reset_color);
                 }
-                    // Handle digits
-                else if (std::isdigit(c) || c == '.') {
-                    if (colorful)
-                        std::cout << digit_color; // Set digits color
-                    std::cout << c;
-                    if (colorful)
-                        std::cout << "\033[0m"; // Reset color to normal
+                if (buffer.size() >= capacity) {
+                    flush();
                 }
-                    // Handle keywords (True, False, NullPtr)
-                else if (std::toupper(static_cast<unsigned char>(c)) == 'T' ||
-                         std::toupper(static_cast<unsigned char>(c)) == 'F' ||
-                         std::toupper(static_cast<unsigned char>(c)) == 'N') {
-                    std::string match;
-                    if (c == 'T')
-                        match = "True";
-                    else if (c == 't')
-                        match = "true";
-                    else if (c == 'F')
-                        match = "False";
-                    else if (c == 'f')
-                        match = "false";
-                    else if (c == 'N')
-                        match = "NullPtr";
-                    else if (c == 'n')
-                        match = "null";
-                    std::string candidate = json_str.substr(i, match.size());
-                    bool isMatch = true;
-                    for (size_t j = 0; j < match.size(); ++j) {
-                        if (candidate[j] != match[j]) {
-                            isMatch = false;
-                            break;
-                        }
-                    }
-                    if (isMatch) {
-                        if (colorful)
-                            std::cout << key_color; // Set keywords color
-                        std::cout << candidate;
-                        i += match.size() - 1;
-                        // Move the index past the matched keyword
-                        if (colorful)
-                            std::cout << "\033[0m"; // Reset color to normal
+            }
+        }; // struct Output
+
+        inline bool is_digit(char c) { return c >= '0' && c <= '9'; }
+
+        /**
+         * @brief Checks whether a character may continue a number, digit
+         * separators and exponents of Doc::str(true) included.
+         */
+        inline bool is_number_char(char c) {
+            return is_digit(c) || c == '.' || c == '_' || c == 'e' || c == 'E' || c == '+' || c == '-';
+        }
+
+        /**
+         * @brief Checks whether a character may start a token json_print()
+         * handles, so that the characters in between are copied in one run.
+         */
+        inline bool is_token_start(char c) {
+            switch (c) {
+                case '{':
+                case '}':
+                case '\n':
+                case '"':
+                case '.':
+                case '-':
+                case 't':
+                case 'T':
+                case 'f':
+                case 'F':
+                case 'n':
+                case 'N':
+                    return true;
+                default:
+                    return is_digit(c);
+            }
+        }
+
+        /**
+         * @brief Get the length of the keyword at the start of a text.
+         *
+         * @return The length of True, true, False, false, NullPtr or null, or
+         * 0 if the text does not start with one of them.
+         */
+        size_t keyword_length(std::string_view text) {
+            static constexpr std::string_view keywords[] = {"True", "true", "False", "false",
+                                                            "NullPtr", "null"};
+            for (std::string_view keyword : keywords) {
+                if (text.compare(0, keyword.size(), keyword) == 0) {
+                    return keyword.size();
+                }
+            }
+            return 0;
+        }
+
+        /**
+         * @brief Writes a string value as Doc::str(true) shows it, its quotes
+         * turned into single quotes.
+         */
+        void print_str(Output& out, std::string_view chars) {
+            if (colorful) {
+                out.buffer.append(str_color);
+            }
+            out.put('"');
+            for (size_t quote; (quote = chars.find('"')) != std::string_view::npos;) {
+                out.append(chars.substr(0, quote));
+                out.put('\'');
+                chars.remove_prefix(quote + 1);
+            }
+            out.append(chars);
+            out.put('"');
+            if (colorful) {
+                out.buffer.append(reset_color);
+            }
+        }
+
+        /**
+         * @brief Writes a primitive Doc or an empty container.
+         */
+        void print_prim(Output& out, const Doc& doc) {
+            switch (doc.get_type()) {
+                case Type::Str: {
+                    std::string_view chars = doc.get_str_view();
+                    if (chars.data()) {
+                        print_str(out, chars);
                     } else {
-                        std::cout << c;
+                        out.span(key_color, "null");
                     }
+                } break;
+                case Type::Bool:
+                    out.span(key_color, doc.get_bool() ? "True" : "False");
+                    break;
+                case Type::Nullptr:
+                    out.span(key_color, "NullPtr");
+                    break;
+                case Type::Char:
+                    out.span(str_color, doc.str(true));
+                    break;
+                case Type::Tuple:
+                    out.append("(Null)");
+                    break;
+                case Type::Array:
+                    out.append("[Null]");
+                    break;
+                case Type::Dict:
+                    out.append("{Null}");
+                    break;
+                default:
+                    out.span(digit_color, doc.str(true)); // Numbers, grouped as str(true) does
+                    break;
+            }
+        }
+    } // namespace
+
+    [[maybe_unused]] void json_print(const std::string& json_str, int indents) {
+        Output out(indents);
+        const std::string_view text(json_str);
+        const size_t n = text.size();
+        size_t level = 0;         // Initialize the indentation level
+        bool begin_point = false; // Flag to indicate if a new line has started
+        size_t i = 0;
+        while (i < n) {
+            const char c = text[i];
+            if (c == '{') {
+                ++level;
+                out.put(c);
+                ++i;
+            } else if (c == '}') {
+                level = level > 0 ? level - 1 : 0;
+                out.indent(level);
+                out.put(c);
+                ++i;
+            } else if (c == '\n') {
+                out.put(c);
+                ++i;
+                begin_point = true; // Set the flag to indicate a new line
+                continue;
+            } else {
+                if (begin_point) {
+                    out.indent(level);
+                }
+                size_t end = i + 1;
+                if (c == '"') {
+                    // A string, up to its closing quote
+                    while (end < n && text[end] != '"') {
+                        end += text[end] == '\\' ? 2 : 1;
+                    }
+                    end = end < n ? end + 1 : n;
+                    out.span(str_color, text.substr(i, end - i));
+                } else if (is_digit(c) || c == '.' ||
+                           (c == '-' && end < n && (is_digit(text[end]) || text[end] == '.'))) {
+                    // A number, colored as one token
+                    while (end < n && is_number_char(text[end])) {
+                        ++end;
+                    }
+                    out.span(digit_color, text.substr(i, end - i));
+                } else if (size_t length = keyword_length(text.substr(i))) {
+                    end = i + length;
+                    out.span(key_color, text.substr(i, end - i));
                 } else {
-                    std::cout << c;
+                    // Anything else, copied up to the next token
+                    while (end < n && !is_token_start(text[end])) {
+                        ++end;
+                    }
+                    out.append(text.substr(i, end - i));
                 }
+                i = end;
             }
             begin_point = false; // Reset the flag indicating the start of a line
         }
-        std::ostream::sync_with_stdio(sync_state);
-        // Restore the original sync state
     }
+    // Colors whole tokens and copies the runs between them in one append.
+
+    [[maybe_unused]] void json_print(const Doc& doc, int indents) {
+        /**
+         * @brief Position in a container being printed.
+         */
+        struct Frame {
+            const Doc* doc;             ///< The container.
+            size_t index;               ///< Next element, or number of entries printed.
+            DictObj::const_iterator it; ///< Next entry of a dictionary object.
+        };
+
+        Output out(indents);
+        std::vector<Frame> frames;
+        std::string key;
+        size_t level = 0; // Open dictionaries, one indentation level each
+
+        // Prints a value, or opens it if it is a non-empty container
+        auto value = [&](const Doc& d) {
+            const Type t = d.get_type();
+            if (t == Type::Dict && d.size() != 0) {
+                out.put('{');
+                ++level;
+                frames.push_back({&d, 0, d.get_dict_obj().cbegin()});
+            } else if ((t == Type::Array || t == Type::Tuple) && d.size() != 0) {
+                out.put(t == Type::Tuple ? '(' : '[');
+                frames.push_back({&d, 0, {}});
+            } else {
+                print_prim(out, d);
+            }
+        };
+
+        value(doc);
+        while (!frames.empty()) {
+            Frame& frame = frames.back();
+            const Doc& container = *frame.doc;
+            if (container.get_type() == Type::Dict) {
+                if (frame.it == container.get_dict_obj().cend()) {
+                    frames.pop_back();
+                    out.put('\n');
+                    out.indent(--level);
+                    out.put('}');
+                    continue;
+                }
+                out.append(frame.index++ != 0 ? ",\n" : "\n");
+                out.indent(level);
+                key.clear();
+                Text::quote(frame.it->first, key);
+                out.span(str_color, key);
+                out.append(": ");
+                const Doc& child = (frame.it++)->second;
+                value(child); // May grow frames, frame is not used afterwards
+            } else {
+                if (frame.index == container.size()) {
+                    frames.pop_back();
+                    out.put(container.get_type() == Type::Tuple ? ')' : ']');
+                    continue;
+                }
+                if (frame.index != 0) {
+                    out.append(", ");
+                }
+                const Doc& child = container(frame.index++);
+                value(child);
+            }
+        }
+    }
+    // Objects get one member per line, arrays and tuples stay on one line.
 
     void ProgressBar::update() {
         const int progressBarWidth = 50;
@@ -134,9 +329,6 @@ namespace JoSon::Viso {
         } else {
             percentage = new_percentage;
         }
-        bool sync_state = std::ostream::sync_with_stdio(false);
-        // Save the current sync state
-
         // Define colors based on rate
         std::string color;
         if (colorful) {
@@ -183,6 +375,5 @@ namespace JoSon::Viso {
             std::cout << " 100%";
         }
         std::cout.flush();
-        std::ostream::sync_with_stdio(sync_state);
     }
 } // namespace JoSon::Viso
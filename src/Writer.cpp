@@ -0,0 +1,282 @@
+// Writer.cpp
+#include "../include/JoSon/Writer.h"
+#include "Format.h"
+#include "Text.h"
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <stdexcept>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+JoSon::Writer::Writer(int indent)
+        : flush_at(0), indent(indent > 0 ? indent : 0) {}
+// Constructor writes into the internal buffer only.
+
+JoSon::Writer::Writer(Sink sink, int indent, size_t buffer_size)
+        : sink(std::move(sink)), flush_at(buffer_size),
+          indent(indent > 0 ? indent : 0) {
+    out.reserve(buffer_size);
+}
+// Constructor hands the text to sink every buffer_size bytes.
+
+void JoSon::Writer::newline(size_t depth) {
+    if (indent > 0) {
+        out.push_back('\n');
+        out.append(depth * static_cast<size_t>(indent), ' ');
+    }
+}
+
+void JoSon::Writer::write_prim(const Doc& doc) {
+    char buffer[64];
+    switch (doc.get_type()) {
+        case Type::Char:
+            out.append(buffer, Format::number_to_chars(
+                                       buffer, static_cast<int>(doc.get_char())));
+            break;
+        case Type::Int:
+            out.append(buffer, Format::number_to_chars(buffer, doc.get_int()));
+            break;
+        case Type::LLong:
+            out.append(buffer, Format::number_to_chars(buffer, doc.get_l_long()));
+            break;
+        case Type::Float:
+            out.append(buffer, Format::number_to_chars(buffer, doc.get_float()));
+            break;
+        case Type::Double:
+            out.append(buffer, Format::number_to_chars(buffer, doc.get_double()));
+            break;
+        case Type::LDouble:
+            out.append(buffer,
+                       Format::number_to_chars(buffer, doc.get_long_double()));
+            break;
+        case Type::Bool:
+            out.append(doc.get_bool() ? "true" : "false");
+            break;
+        case Type::Nullptr:
+            out.append("null");
+            break;
+        case Type::Str:
+            Text::quote(doc.get_str_view(), out);
+            break;
+        case Type::Dict:
+            out.append("{}"); // void map object
+            break;
+        case Type::Tuple:
+        case Type::Array:
+            out.append("[]"); // void list
+            break;
+    }
+}
+// Writes a primitive or an empty container.
+
+void JoSon::Writer::before_value() {
+    if (open.empty()) {
+        return;
+    }
+    Open& top = open.back();
+    if (top.dict) {
+        if (!top.has_key) {
+            throw std::runtime_error("Error: A value in a streamed object needs a key first.");
+        }
+        top.has_key = false;
+    } else {
+        if (top.count++ != 0) {
+            out.push_back(',');
+        }
+        newline(open.size());
+    }
+}
+// Separates the elements of a streamed array; a member's key was written by key().
+
+JoSon::Writer& JoSon::Writer::write(const Doc& doc) {
+    before_value();
+    frames.clear();
+    const size_t base = open.size(); // Depth of the streamed containers around doc
+    // Writes a value, or opens it if it is a non-empty container
+    auto value = [this](const Doc& d) {
+        Type t = d.get_type();
+        if (t == Type::Dict && d.size() != 0) {
+            out.push_back('{');
+            frames.push_back({&d, 0, d.get_dict_obj().cbegin()});
+        } else if ((t == Type::Array || t == Type::Tuple) && d.size() != 0) {
+            out.push_back('[');
+            frames.push_back({&d, 0, {}});
+        } else {
+            write_prim(d);
+        }
+    };
+
+    value(doc);
+    while (!frames.empty()) {
+        Frame& frame = frames.back();
+        const Doc& container = *frame.doc;
+        const size_t depth = base + frames.size();
+        if (container.get_type() == Type::Dict) {
+            if (frame.it == container.get_dict_obj().cend()) {
+                frames.pop_back();
+                newline(depth - 1);
+                out.push_back('}');
+                continue;
+            }
+            if (frame.index++ != 0) {
+                out.push_back(',');
+            }
+            newline(depth);
+            Text::quote(frame.it->first, out);
+            out.append(indent > 0 ? ": " : ":");
+            const Doc& child = (frame.it++)->second;
+            value(child); // May grow frames, frame is not used afterwards
+        } else {
+            if (frame.index == container.size()) {
+                frames.pop_back();
+                newline(depth - 1);
+                out.push_back(']');
+                continue;
+            }
+            if (frame.index != 0) {
+                out.push_back(',');
+            }
+            newline(depth);
+            const Doc& child = container(frame.index++);
+            value(child);
+        }
+        maybe_flush();
+    }
+    maybe_flush();
+    return *this;
+}
+// Walks the document depth first, one frame per open container.
+
+JoSon::Writer& JoSon::Writer::write_line(const Doc& doc) {
+    if (!open.empty()) {
+        throw std::runtime_error("Error: JSON Lines records cannot be written in a streamed container.");
+    }
+    // Restores the layout even if write() throws
+    struct Restore {
+        int& indent;
+        const int layout;
+
+        ~Restore() { indent = layout; }
+    } restore{indent, indent};
+    indent = 0; // A record must fit on its line
+    write(doc);
+    out.push_back('\n');
+    maybe_flush();
+    return *this;
+}
+
+JoSon::Writer& JoSon::Writer::begin_array() {
+    before_value();
+    out.push_back('[');
+    open.push_back({false, false, 0});
+    return *this;
+}
+
+JoSon::Writer& JoSon::Writer::begin_object() {
+    before_value();
+    out.push_back('{');
+    open.push_back({true, false, 0});
+    return *this;
+}
+
+JoSon::Writer& JoSon::Writer::key(std::string_view name) {
+    if (open.empty() || !open.back().dict || open.back().has_key) {
+        throw std::runtime_error("Error: A key can only start a member of a streamed object.");
+    }
+    Open& top = open.back();
+    if (top.count++ != 0) {
+        out.push_back(',');
+    }
+    newline(open.size());
+    Text::quote(name, out);
+    out.append(indent > 0 ? ": " : ":");
+    top.has_key = true;
+    return *this;
+}
+
+JoSon::Writer& JoSon::Writer::end_array() {
+    if (open.empty() || open.back().dict) {
+        throw std::runtime_error("Error: end_array() without a streamed array open.");
+    }
+    close(']');
+    return *this;
+}
+
+JoSon::Writer& JoSon::Writer::end_object() {
+    if (open.empty() || !open.back().dict) {
+        throw std::runtime_error("Error: end_object() without a streamed object open.");
+    } else if (open.back().has_key) {
+        throw std::runtime_error("Error: end_object() after a key without its value.");
+    }
+    close('}');
+    return *this;
+}
+
+void JoSon::Writer::close(char bracket) {
+    const bool empty = open.back().count == 0;
+    open.pop_back();
+    if (!empty) {
+        newline(open.size());
+    }
+    out.push_back(bracket);
+    maybe_flush();
+}
+
+JoSon::Writer::Sink JoSon::Writer::file_sink(std::FILE* file) {
+    return [file](std::string_view chunk) {
+        if (std::fwrite(chunk.data(), 1, chunk.size(), file) != chunk.size()) {
+            throw std::runtime_error("Error: Unable to write to file.");
+        }
+    };
+}
+
+JoSon::Writer::Sink JoSon::Writer::fd_sink(int fd) {
+    return [fd](std::string_view chunk) {
+        while (!chunk.empty()) {
+#ifdef _WIN32
+            const int written = _write(fd, chunk.data(), static_cast<unsigned int>(
+                    std::min<size_t>(chunk.size(), INT_MAX)));
+#else
+            const ssize_t written = ::write(fd, chunk.data(), chunk.size());
+            if (written < 0 && errno == EINTR) {
+                continue;
+            }
+#endif
+            if (written <= 0) {
+                throw std::runtime_error("Error: Unable to write to file descriptor.");
+            }
+            chunk.remove_prefix(static_cast<size_t>(written));
+        }
+    };
+}
+// Loops over partial writes, as pipes and sockets may accept part of a chunk.
+
+JoSon::Writer& JoSon::Writer::write_raw(std::string_view text) {
+    out.append(text);
+    maybe_flush();
+    return *this;
+}
+
+void JoSon::Writer::flush() {
+    if (sink && !out.empty()) {
+        sink(out);
+        out.clear();
+    }
+}
+
+std::string JoSon::Writer::take() {
+    std::string result = std::move(out);
+    out.clear();
+    return result;
+}
+
+std::string JoSon::Writer::to_string(const Doc& doc, int indent) {
+    Writer writer(indent);
+    writer.write(doc);
+    return writer.take();
+}